@@ -0,0 +1,95 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/* Searches a single route with A*. The lower bound gives for every vertex a
+ * weight no route from it to the target is lighter than, and must not drop
+ * along an edge by more than the edge weighs. Vertices nearer to the target
+ * by the bound are settled first, so the search goes towards the target.
+ * A bound of zero makes it Dijkstra's algorithm. Adds the number of settled
+ * vertices to settled_count if given */
+template <typename Weight, typename LowerBound>
+std::optional<typename Router<Weight>::RouteInfo> FindRoute(
+                                    const DirectedWeightedGraph<Weight>& graph,
+                                    VertexId from, VertexId to,
+                                    LowerBound lower_bound,
+                                    size_t* settled_count = nullptr) {
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    struct Label {
+        Weight weight;
+        std::optional<EdgeId> prev_edge;
+    };
+
+    // Search spaces are small, so labels are kept in a map, not in a whole array
+    std::unordered_map<VertexId, Label> labels{ { from, { Weight{}, std::nullopt } } };
+
+    // Items are ordered by the weight plus the bound, then by the weight
+    using QueueItem = std::tuple<Weight, Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    queue.push({ lower_bound(from), Weight{}, from });
+
+    size_t settled = 0;
+    bool is_found = false;
+    while (!queue.empty()) {
+        const auto [estimate, weight, vertex] = queue.top();
+        queue.pop();
+
+        if (labels.at(vertex).weight < weight) {
+            continue;
+        }
+        ++settled;
+
+        if (vertex == to) {
+            is_found = true;
+            break;
+        }
+
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const Edge<Weight>& edge = graph.GetEdge(edge_id);
+            if (edge.weight < Weight{}) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            const Weight candidate = weight + edge.weight;
+
+            const auto [label, is_new] = labels.try_emplace(edge.to,
+                                                    Label{ candidate, edge_id });
+            if (is_new || candidate < label->second.weight) {
+                label->second = { candidate, edge_id };
+                queue.push({ candidate + lower_bound(edge.to), candidate, edge.to });
+            }
+        }
+    }
+
+    if (settled_count) {
+        *settled_count += settled;
+    }
+
+    if (!is_found) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge = labels.at(to).prev_edge;
+         edge; edge = labels.at(graph.GetEdge(*edge).from).prev_edge) {
+        edges.push_back(*edge);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{ labels.at(to).weight, std::move(edges) };
+}
+
+}  // namespace graph
@@ -0,0 +1,463 @@
+#include "transport_catalogue.h"
+#include "transport_router.h"
+#include "serialization.h"
+#include "map_renderer.h"
+#include "json_builder.h"
+#include "json_reader.h"
+#include "generator.h"
+#include "domain.h"
+#include "json.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ToMilliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double ToMicroseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+// Swallows everything written to it, so that only producing output is timed
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        return count;
+    }
+};
+
+struct BenchSettings {
+    generator::CitySettings city;
+    generator::RequestMix mix;
+};
+
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue_bench "sv
+           << generator::GetOptionsUsage() << '\n';
+}
+
+BenchSettings ParseArguments(int argc, char* argv[]) {
+    BenchSettings settings;
+
+    for (int i = 1; i < argc; i += 2) {
+        const std::string_view option(argv[i]);
+        if (i + 1 == argc) {
+            throw std::invalid_argument("No value for "s + std::string(option));
+        }
+
+        if (!generator::ApplyOption(option, argv[i + 1],
+                                    settings.city, settings.mix)) {
+            throw std::invalid_argument("Unknown option "s + std::string(option));
+        }
+    }
+
+    return settings;
+}
+
+std::string_view GetTypeName(domain::QueryType type) {
+    switch (type) {
+    case domain::QueryType::STOP:
+        return "Stop"sv;
+    case domain::QueryType::BUS:
+        return "Bus"sv;
+    case domain::QueryType::ROUTE:
+        return "Route"sv;
+    case domain::QueryType::MAP:
+        return "Map"sv;
+    case domain::QueryType::ROUTE_MATRIX:
+        return "RouteMatrix"sv;
+    case domain::QueryType::ISOCHRONE:
+        return "Isochrone"sv;
+    }
+    return {};
+}
+
+/* Creates a directory of its own in the temporary one, so benches run at
+ * once never share a base file */
+std::filesystem::path MakeRunDirectory() {
+    std::random_device random;
+
+    for (;;) {
+        const std::filesystem::path directory = 
+            std::filesystem::temp_directory_path()
+            / ("transport_catalogue_bench_"s + std::to_string(random()));
+
+        // Fails to create a directory that exists, so a name is never shared
+        if (std::filesystem::create_directory(directory)) {
+            return directory;
+        }
+    }
+}
+
+/* Returns two different stops of the first bus, so a route between them
+ * goes through the router rather than failing on an unserved stop */
+std::optional<std::pair<std::string_view, std::string_view>> FindServedStops(
+                                                    const generator::City& city) {
+    if (city.buses.empty()) {
+        return std::nullopt;
+    }
+
+    const std::vector<size_t>& stops = city.buses.front().stops;
+    for (const size_t stop : stops) {
+        if (stop != stops.front()) {
+            return std::pair<std::string_view, std::string_view>{
+                city.stops[stops.front()].name, city.stops[stop].name };
+        }
+    }
+    return std::nullopt;
+}
+
+// Durations of separate queries of one type
+class LatencyStats {
+public:
+    void Add(Clock::duration duration) {
+        durations_.push_back(duration);
+    }
+
+    json::Node Build() {
+        std::sort(durations_.begin(), durations_.end());
+
+        Clock::duration total{};
+        for (const Clock::duration duration : durations_) {
+            total += duration;
+        }
+
+        return json::Builder{}.StartDict()
+            .Key("count"s).Value(static_cast<int>(durations_.size()))
+            .Key("total_ms"s).Value(ToMilliseconds(total))
+            .Key("p50_us"s).Value(GetPercentile(0.5))
+            .Key("p90_us"s).Value(GetPercentile(0.9))
+            .Key("p99_us"s).Value(GetPercentile(0.99))
+            .Key("max_us"s).Value(GetPercentile(1))
+        .EndDict().Build();
+    }
+
+private:
+    // Nearest-rank percentile of the sorted durations
+    double GetPercentile(double share) const {
+        if (durations_.empty()) {
+            return 0;
+        }
+        const size_t rank = static_cast<size_t>(std::ceil(share * durations_.size()));
+        return ToMicroseconds(durations_[std::max<size_t>(rank, 1) - 1]);
+    }
+
+    std::vector<Clock::duration> durations_;
+};
+
+// Times the whole func and keeps the duration under the stage name
+template <typename Func>
+auto TimeStage(json::Dict& stages, const std::string& stage, Func func) {
+    const Clock::time_point start = Clock::now();
+    if constexpr (std::is_void_v<decltype(func())>) {
+        func();
+        stages[stage] = ToMilliseconds(Clock::now() - start);
+    } else {
+        auto result = func();
+        stages[stage] = ToMilliseconds(Clock::now() - start);
+        return result;
+    }
+}
+
+class Bench {
+public:
+    explicit Bench(BenchSettings settings)
+        : settings_(std::move(settings))
+        , run_directory_(MakeRunDirectory())
+        , base_file_(run_directory_ / "transport_catalogue_bench.db") {}
+
+    ~Bench() {
+        std::error_code ignored;
+        std::filesystem::remove_all(run_directory_, ignored);
+    }
+
+    json::Node Run() {
+        const generator::City city = TimeStage(stages_, "generate_city"s, [this]() {
+            return generator::GenerateCity(settings_.city);
+        });
+        const std::vector<generator::StatRequest> requests =
+            generator::GenerateRequests(city, settings_.mix);
+
+        std::ostringstream make_base_text;
+        generator::PrintMakeBase(make_base_text, city, base_file_);
+        std::ostringstream requests_text;
+        generator::PrintStatRequests(requests_text, city, requests, base_file_);
+
+        RunStages(city, make_base_text.str());
+        RunQueries(city, requests);
+        json::Dict point_to_point = RunPointToPoint(city, requests);
+        RunEndToEnd(make_base_text.str(), requests_text.str());
+
+        json::Dict settings{
+            { "stops"s, static_cast<int>(settings_.city.stop_count) },
+            { "buses"s, static_cast<int>(settings_.city.bus_count) },
+            { "min_route_length"s, static_cast<int>(settings_.city.min_route_length) },
+            { "max_route_length"s, static_cast<int>(settings_.city.max_route_length) },
+            { "requests"s, static_cast<int>(settings_.mix.request_count) },
+            { "seed"s, static_cast<int>(settings_.city.seed) },
+            { "make_base_bytes"s, static_cast<int>(make_base_text.str().size()) },
+            { "base_bytes"s, static_cast<int>(base_bytes_) }
+        };
+
+        json::Dict queries;
+        for (auto& [type, stats] : latencies_) {
+            queries[std::string(GetTypeName(type))] = stats.Build();
+        }
+
+        return json::Builder{}.StartDict()
+            .Key("settings"s).Value(std::move(settings))
+            .Key("stages_ms"s).Value(stages_)
+            .Key("queries"s).Value(std::move(queries))
+            .Key("point_to_point"s).Value(std::move(point_to_point))
+        .EndDict().Build();
+    }
+
+private:
+    // Stages of make_base and of loading the base, one by one
+    void RunStages(const generator::City& city, const std::string& make_base_text) {
+        using namespace transport_catalogue;
+
+        TimeStage(stages_, "json_load"s, [&make_base_text]() {
+            std::istringstream in(make_base_text);
+            return json::Load(in);
+        });
+
+        // Same queries JSONReader makes of base_requests
+        std::deque<domain::StopInputQuery> stop_queries;
+        for (const generator::City::Stop& stop : city.stops) {
+            domain::StopInputQuery query;
+            query.name = stop.name;
+            query.coordinates = stop.coordinates;
+            for (const auto& [to, distance] : stop.distances) {
+                query.distances[city.stops[to].name] = distance;
+            }
+            stop_queries.push_back(std::move(query));
+        }
+
+        std::deque<domain::BusInputQuery> bus_queries;
+        for (const generator::City::Bus& bus : city.buses) {
+            domain::BusInputQuery query;
+            query.name = bus.name;
+            query.is_roundtrip = bus.is_roundtrip;
+            for (const size_t stop : bus.stops) {
+                query.stop_names.push_back(city.stops[stop].name);
+            }
+            if (!bus.is_roundtrip) {
+                for (auto iter = bus.stops.rbegin() + 1; iter != bus.stops.rend(); ++iter) {
+                    query.stop_names.push_back(city.stops[*iter].name);
+                }
+            }
+            bus_queries.push_back(std::move(query));
+        }
+
+        TimeStage(stages_, "execute_input_queries"s, [&]() {
+            catalogue_.AddStops(stop_queries);
+            catalogue_.AddDistances(stop_queries);
+            catalogue_.AddBuses(bus_queries);
+        });
+
+        router_ = TimeStage(stages_, "transport_router"s, [this]() {
+            return std::make_unique<transport_router::TransportRouter>(
+                                catalogue_, generator::MakeRoutingSettings());
+        });
+
+        const renderer::RenderSettings render_settings =
+                                                generator::MakeRenderSettings();
+
+        const std::string base = TimeStage(stages_, "serialize"s, [&]() {
+            std::ostringstream out;
+            serialization::database::DatabaseSerializer::Serialize(
+                                    catalogue_, render_settings, *router_, out);
+            return out.str();
+        });
+        base_bytes_ = base.size();
+
+        TimeStage(stages_, "deserialize"s, [&base]() {
+            std::istringstream in(base);
+            return serialization::database::DatabaseSerializer::Deserialize(in);
+        });
+
+        // The all-pairs table is built by the first route between served stops
+        TimeStage(stages_, "router_table"s, [this, &city]() {
+            if (const auto stops = FindServedStops(city)) {
+                if (!router_->BuildRoute(stops->first, stops->second)) {
+                    throw std::logic_error("No route along the first bus");
+                }
+            }
+        });
+
+        map_renderer_ = std::make_unique<renderer::MapRenderer>(render_settings);
+        map_layout_ = TimeStage(stages_, "map_layout"s, [this]() {
+            return map_renderer_->MakeMapLayout(catalogue_);
+        });
+    }
+
+    // Every request on its own against the structures built by the stages
+    void RunQueries(const generator::City& city,
+                    const std::vector<generator::StatRequest>& requests) {
+        NullBuffer null_buffer;
+        std::ostream null_out(&null_buffer);
+
+        for (const generator::StatRequest& request : requests) {
+            const Clock::time_point start = Clock::now();
+
+            switch (request.type) {
+            case domain::QueryType::STOP:
+                catalogue_.GetStopInfo(city.stops[request.from].name);
+                break;
+            case domain::QueryType::BUS:
+                catalogue_.GetBusInfo(city.buses[request.from].name);
+                break;
+            case domain::QueryType::ROUTE:
+                router_->BuildRoute(city.stops[request.from].name,
+                                    city.stops[request.to].name);
+                break;
+            case domain::QueryType::MAP:
+                map_renderer_->RenderMap(map_layout_,
+                        renderer::MapRenderer::SelectWholeMap(map_layout_),
+                        null_out);
+                break;
+            case domain::QueryType::ROUTE_MATRIX:
+                throw std::logic_error("RouteMatrix requests aren't benchmarked");
+            case domain::QueryType::ISOCHRONE:
+                throw std::logic_error("Isochrone requests aren't benchmarked");
+            }
+
+            latencies_[request.type].Add(Clock::now() - start);
+        }
+    }
+
+    /* Route requests searched from scratch, by Dijkstra's algorithm and by
+     * A* with the geographic lower bound, both checked against the table */
+    json::Dict RunPointToPoint(const generator::City& city,
+                               const std::vector<generator::StatRequest>& requests) {
+        // The lower bound is collected by the first search between served stops
+        TimeStage(stages_, "a_star_bound"s, [this, &city]() {
+            if (const auto stops = FindServedStops(city)) {
+                if (!router_->SearchRoute(stops->first, stops->second, true)) {
+                    throw std::logic_error("No route along the first bus");
+                }
+            }
+        });
+
+        json::Dict result;
+        for (const bool use_lower_bound : { false, true }) {
+            LatencyStats latencies;
+            size_t settled_count = 0;
+            size_t query_count = 0;
+
+            for (const generator::StatRequest& request : requests) {
+                if (request.type != domain::QueryType::ROUTE) {
+                    continue;
+                }
+                const std::string_view from = city.stops[request.from].name;
+                const std::string_view to = city.stops[request.to].name;
+
+                const Clock::time_point start = Clock::now();
+                const auto route = router_->SearchRoute(from, to, use_lower_bound,
+                                                        &settled_count);
+                latencies.Add(Clock::now() - start);
+                ++query_count;
+
+                const auto expected = router_->BuildRoute(from, to);
+                if (route.has_value() != expected.has_value()
+                 || (route && std::abs(route->total_time - expected->total_time) > 1e-6)) {
+                    throw std::logic_error("Search disagrees with the router table");
+                }
+            }
+
+            json::Dict stats = latencies.Build().AsMap();
+            stats["settled_per_query"s] = query_count > 0 
+                    ? static_cast<double>(settled_count) / query_count : 0.0;
+            result[use_lower_bound ? "a_star"s : "dijkstra"s] = std::move(stats);
+        }
+
+        return result;
+    }
+
+    // Both modes the way the executable runs them, JSON included
+    void RunEndToEnd(const std::string& make_base_text,
+                     const std::string& requests_text) {
+        TimeStage(stages_, "make_base"s, [&make_base_text]() {
+            json_reader::JSONReader reader;
+            reader.LoadMakeBaseJSON(make_base_text);
+        });
+
+        TimeStage(stages_, "process_requests"s, [&requests_text]() {
+            NullBuffer null_buffer;
+            std::ostream null_out(&null_buffer);
+
+            json_reader::JSONReader reader;
+            reader.LoadRequestsJSON(requests_text);
+            reader.ExecuteOutputQueries(null_out);
+        });
+    }
+
+    BenchSettings settings_;
+
+    std::filesystem::path run_directory_;
+
+    std::filesystem::path base_file_;
+
+    json::Dict stages_;
+
+    size_t base_bytes_ = 0;
+
+    std::map<domain::QueryType, LatencyStats> latencies_;
+
+    transport_catalogue::TransportCatalogue catalogue_;
+
+    std::unique_ptr<transport_router::TransportRouter> router_;
+
+    std::unique_ptr<renderer::MapRenderer> map_renderer_;
+
+    renderer::MapRenderer::MapLayout map_layout_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchSettings settings;
+    try {
+        settings = ParseArguments(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        PrintUsage();
+        return 1;
+    }
+
+    try {
+        json::Print(json::Document{ Bench(std::move(settings)).Run() }, std::cout);
+        std::cout << '\n';
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,638 @@
+#pragma once
+
+#include "graph.h"
+#include "memory.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/* Contraction Hierarchies over a graph. Vertices are contracted one by one,
+ * the least important first, and shortcuts between their neighbours keep
+ * the distances among the vertices left. A query then only goes up the
+ * hierarchy from both ends and meets in the middle, so it settles a small
+ * part of the graph and needs no table. The graph must outlive the hierarchy
+ * and must not change */
+template <typename Weight>
+class ContractionHierarchy {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    /* An edge standing for two consecutive edges. Edge ids past the edge
+     * count of the graph refer to other shortcuts */
+    struct Shortcut {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first;
+        EdgeId second;
+    };
+
+    // Everything the hierarchy is restored from besides the graph
+    struct Data {
+        // Position of every vertex in the order of contraction
+        std::vector<size_t> ranks;
+
+        std::vector<Shortcut> shortcuts;
+    };
+
+    // Contracts the whole graph
+    explicit ContractionHierarchy(const Graph& graph);
+
+    /* Restores a hierarchy contracted before over the same graph. Throws
+     * std::runtime_error if the data doesn't make a hierarchy of the graph */
+    ContractionHierarchy(const Graph& graph, const Data& data);
+
+    /* Returns the shortest route with shortcuts unpacked, so its edges are
+     * edges of the graph */
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    size_t GetRank(VertexId vertex) const;
+
+    size_t GetShortcutCount() const;
+
+    const Shortcut& GetShortcut(size_t index) const;
+
+private:
+    // An edge of the search graph as seen from the vertex it is listed at
+    struct SearchEdge {
+        VertexId vertex;
+        Weight weight;
+        EdgeId edge;
+    };
+
+    template <typename T>
+    using Vector = memory::Vector<T, memory::Category::CONTRACTION_HIERARCHY>;
+
+    // Searches for a witness give up after that many settled vertices
+    static constexpr size_t MAX_WITNESS_SETTLED = 100;
+
+    /* The vertices not contracted yet and the edges among them, shortcuts
+     * included. Only the lightest of parallel edges is listed */
+    struct RemainingGraph {
+        // Graph edges, then shortcuts, so edge ids are the same
+        std::vector<Edge<Weight>> edges;
+
+        std::vector<std::vector<EdgeId>> out_edges;
+
+        std::vector<std::vector<EdgeId>> in_edges;
+
+        void ListEdge(EdgeId edge_id);
+
+        void RemoveVertex(VertexId vertex);
+    };
+
+    // Dijkstra's algorithm that reuses its arrays between the runs
+    class WitnessSearch {
+    public:
+        explicit WitnessSearch(size_t vertex_count)
+            : distances_(vertex_count, std::numeric_limits<Weight>::max())
+            , is_target_(vertex_count, false) {}
+
+        /* Finds distances from the source avoiding the excluded vertex, up
+         * to the limit or until every target is settled. Other distances
+         * are left unknown or too long */
+        void Run(const RemainingGraph& graph, VertexId source, VertexId excluded,
+                 Weight limit, const std::vector<VertexId>& targets);
+
+        Weight GetDistance(VertexId vertex) const {
+            return distances_[vertex];
+        }
+
+    private:
+        std::vector<Weight> distances_;
+
+        std::vector<VertexId> touched_;
+
+        std::vector<bool> is_target_;
+    };
+
+    void Contract();
+
+    // Finds the shortcuts contracting the vertex would take
+    void FindShortcuts(VertexId vertex, const RemainingGraph& graph,
+                       WitnessSearch& search, std::vector<Shortcut>& shortcuts) const;
+
+    /* Checks that restored ranks are a permutation of the vertices and that
+     * every shortcut joins two edges listed before it, so search graphs can
+     * be laid out and shortcuts unpacked */
+    void CheckRestored() const;
+
+    // Lays out the upward and the downward search graphs by the ranks
+    void BuildSearchGraphs();
+
+    VertexId GetEdgeFrom(EdgeId edge) const;
+
+    VertexId GetEdgeTo(EdgeId edge) const;
+
+    // Appends the graph edges the edge stands for in the order of the route
+    void UnpackEdge(EdgeId edge, std::vector<EdgeId>& edges) const;
+
+    const Graph& graph_;
+
+    Vector<size_t> ranks_;
+
+    Vector<Shortcut> shortcuts_;
+
+    /* Edges going up from every vertex, and edges coming down into every
+     * vertex listed at their lower end, laid out by vertices one after
+     * another */
+    Vector<size_t> up_offsets_;
+
+    Vector<SearchEdge> up_edges_;
+
+    Vector<size_t> down_offsets_;
+
+    Vector<SearchEdge> down_edges_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : graph_(graph)
+    , ranks_(graph.GetVertexCount(), 0) {
+    Contract();
+    BuildSearchGraphs();
+}
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph,
+                                                   const Data& data)
+    : graph_(graph)
+    , ranks_(data.ranks.begin(), data.ranks.end())
+    , shortcuts_(data.shortcuts.begin(), data.shortcuts.end()) {
+    CheckRestored();
+    BuildSearchGraphs();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::CheckRestored() const {
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    if (ranks_.size() != vertex_count) {
+        throw std::runtime_error("Hierarchy ranks don't match the graph");
+    }
+    std::vector<bool> is_rank_taken(vertex_count, false);
+    for (const size_t rank : ranks_) {
+        if (rank >= vertex_count || is_rank_taken[rank]) {
+            throw std::runtime_error("Hierarchy ranks aren't a permutation");
+        }
+        is_rank_taken[rank] = true;
+    }
+
+    for (size_t i = 0; i < shortcuts_.size(); ++i) {
+        const Shortcut& shortcut = shortcuts_[i];
+        const EdgeId id = graph_.GetEdgeCount() + i;
+
+        if (shortcut.from >= vertex_count || shortcut.to >= vertex_count) {
+            throw std::runtime_error("Hierarchy shortcut refers to no vertex");
+        }
+        // Earlier shortcuts are checked already, so their ends can be trusted
+        if (shortcut.first >= id || shortcut.second >= id) {
+            throw std::runtime_error("Hierarchy shortcut refers to no earlier edge");
+        }
+        if (GetEdgeFrom(shortcut.first) != shortcut.from
+         || GetEdgeTo(shortcut.first) != GetEdgeFrom(shortcut.second)
+         || GetEdgeTo(shortcut.second) != shortcut.to) {
+            throw std::runtime_error("Hierarchy shortcut edges don't chain");
+        }
+
+        auto get_weight = [this](EdgeId edge) {
+            return edge < graph_.GetEdgeCount()
+                 ? graph_.GetEdge(edge).weight
+                 : shortcuts_[edge - graph_.GetEdgeCount()].weight;
+        };
+        if (!(get_weight(shortcut.first) + get_weight(shortcut.second) == shortcut.weight)) {
+            throw std::runtime_error("Hierarchy shortcut weight isn't the sum of its edges");
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::RemainingGraph::ListEdge(EdgeId edge_id) {
+    const Edge<Weight>& edge = edges[edge_id];
+
+    for (EdgeId& listed_id : out_edges[edge.from]) {
+        const Edge<Weight>& listed = edges[listed_id];
+        if (listed.to != edge.to) {
+            continue;
+        }
+        if (edge.weight < listed.weight) {
+            *std::find(in_edges[edge.to].begin(), in_edges[edge.to].end(),
+                       listed_id) = edge_id;
+            listed_id = edge_id;
+        }
+        return;
+    }
+
+    out_edges[edge.from].push_back(edge_id);
+    in_edges[edge.to].push_back(edge_id);
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::RemainingGraph::RemoveVertex(VertexId vertex) {
+    auto unlist = [](std::vector<EdgeId>& edge_ids, EdgeId edge_id) {
+        edge_ids.erase(std::find(edge_ids.begin(), edge_ids.end(), edge_id));
+    };
+
+    for (const EdgeId edge_id : in_edges[vertex]) {
+        unlist(out_edges[edges[edge_id].from], edge_id);
+    }
+    for (const EdgeId edge_id : out_edges[vertex]) {
+        unlist(in_edges[edges[edge_id].to], edge_id);
+    }
+
+    in_edges[vertex] = {};
+    out_edges[vertex] = {};
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::WitnessSearch::Run(
+                                    const RemainingGraph& graph, 
+                                    VertexId source, VertexId excluded,
+                                    Weight limit, 
+                                    const std::vector<VertexId>& targets) {
+    for (const VertexId vertex : touched_) {
+        distances_[vertex] = std::numeric_limits<Weight>::max();
+    }
+    touched_.clear();
+
+    size_t targets_left = 0;
+    for (const VertexId target : targets) {
+        if (!is_target_[target]) {
+            is_target_[target] = true;
+            ++targets_left;
+        }
+    }
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    distances_[source] = Weight{};
+    touched_.push_back(source);
+    queue.push({Weight{}, source});
+
+    size_t settled = 0;
+    while (!queue.empty() && settled < MAX_WITNESS_SETTLED && targets_left > 0) {
+        const auto [distance, vertex] = queue.top();
+        queue.pop();
+        if (distances_[vertex] < distance) {
+            continue;
+        }
+        if (limit < distance) {
+            break;
+        }
+        ++settled;
+
+        if (is_target_[vertex]) {
+            --targets_left;
+        }
+
+        for (const EdgeId edge_id : graph.out_edges[vertex]) {
+            const Edge<Weight>& edge = graph.edges[edge_id];
+            if (edge.to == excluded) {
+                continue;
+            }
+            const Weight candidate = distance + edge.weight;
+            if (candidate < distances_[edge.to]) {
+                if (distances_[edge.to] == std::numeric_limits<Weight>::max()) {
+                    touched_.push_back(edge.to);
+                }
+                distances_[edge.to] = candidate;
+                queue.push({candidate, edge.to});
+            }
+        }
+    }
+
+    for (const VertexId target : targets) {
+        is_target_[target] = false;
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::FindShortcuts(
+                                    VertexId vertex, const RemainingGraph& graph,
+                                    WitnessSearch& search, 
+                                    std::vector<Shortcut>& shortcuts) const {
+    shortcuts.clear();
+
+    std::vector<VertexId> targets;
+    Weight max_out_weight{};
+    for (const EdgeId out_edge_id : graph.out_edges[vertex]) {
+        targets.push_back(graph.edges[out_edge_id].to);
+        max_out_weight = std::max(max_out_weight, graph.edges[out_edge_id].weight);
+    }
+
+    for (const EdgeId in_edge_id : graph.in_edges[vertex]) {
+        const Edge<Weight>& in_edge = graph.edges[in_edge_id];
+
+        search.Run(graph, in_edge.from, vertex, 
+                   in_edge.weight + max_out_weight, targets);
+
+        for (const EdgeId out_edge_id : graph.out_edges[vertex]) {
+            const Edge<Weight>& out_edge = graph.edges[out_edge_id];
+            if (out_edge.to == in_edge.from) {
+                continue;
+            }
+
+            // A route around the vertex as short is a witness
+            const Weight weight = in_edge.weight + out_edge.weight;
+            if (weight < search.GetDistance(out_edge.to)) {
+                shortcuts.push_back({ in_edge.from, out_edge.to, weight,
+                                      in_edge_id, out_edge_id });
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Contract() {
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    RemainingGraph graph;
+    graph.edges.reserve(graph_.GetEdgeCount());
+    graph.out_edges.resize(vertex_count);
+    graph.in_edges.resize(vertex_count);
+
+    for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        const Edge<Weight>& edge = graph_.GetEdge(edge_id);
+        if (edge.weight < Weight{}) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        graph.edges.push_back(edge);
+
+        // A loop is never a part of a shortest route
+        if (edge.from != edge.to) {
+            graph.ListEdge(edge_id);
+        }
+    }
+
+    WitnessSearch search(vertex_count);
+    std::vector<size_t> contracted_neighbours(vertex_count, 0);
+    std::vector<Shortcut> shortcuts;
+
+    /* The fewer shortcuts a vertex adds per edge it removes, and the fewer
+     * of its neighbours are contracted, the sooner it is contracted */
+    auto get_priority = [&](VertexId vertex) {
+        FindShortcuts(vertex, graph, search, shortcuts);
+        return static_cast<int64_t>(shortcuts.size())
+             - static_cast<int64_t>(graph.in_edges[vertex].size() 
+                                    + graph.out_edges[vertex].size())
+             + static_cast<int64_t>(contracted_neighbours[vertex]);
+    };
+
+    using QueueItem = std::pair<int64_t, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.push({ get_priority(vertex), vertex });
+    }
+
+    size_t next_rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+
+        // Priorities go stale as the neighbours get contracted
+        const int64_t priority = get_priority(vertex);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.push({ priority, vertex });
+            continue;
+        }
+
+        // Shortcuts found for the priority are the ones to add
+        ranks_[vertex] = next_rank++;
+        for (const Shortcut& shortcut : shortcuts) {
+            const EdgeId edge_id = graph.edges.size();
+            shortcuts_.push_back(shortcut);
+            graph.edges.push_back({ shortcut.from, shortcut.to, shortcut.weight });
+            graph.ListEdge(edge_id);
+        }
+
+        for (const EdgeId edge_id : graph.in_edges[vertex]) {
+            ++contracted_neighbours[graph.edges[edge_id].from];
+        }
+        for (const EdgeId edge_id : graph.out_edges[vertex]) {
+            ++contracted_neighbours[graph.edges[edge_id].to];
+        }
+        graph.RemoveVertex(vertex);
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildSearchGraphs() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const EdgeId edge_count = graph_.GetEdgeCount() + shortcuts_.size();
+
+    up_offsets_.assign(vertex_count + 1, 0);
+    down_offsets_.assign(vertex_count + 1, 0);
+
+    auto for_each_edge = [this, edge_count](auto func) {
+        for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+            const VertexId from = GetEdgeFrom(edge_id);
+            const VertexId to = GetEdgeTo(edge_id);
+            if (from == to) {
+                continue;
+            }
+            const Weight weight = edge_id < graph_.GetEdgeCount()
+                                ? graph_.GetEdge(edge_id).weight
+                                : shortcuts_[edge_id - graph_.GetEdgeCount()].weight;
+            func(edge_id, from, to, weight);
+        }
+    };
+
+    for_each_edge([this](EdgeId, VertexId from, VertexId to, Weight) {
+        if (ranks_[from] < ranks_[to]) {
+            ++up_offsets_[from + 1];
+        } else {
+            ++down_offsets_[to + 1];
+        }
+    });
+
+    for (size_t i = 0; i < vertex_count; ++i) {
+        up_offsets_[i + 1] += up_offsets_[i];
+        down_offsets_[i + 1] += down_offsets_[i];
+    }
+
+    up_edges_.resize(up_offsets_.back());
+    down_edges_.resize(down_offsets_.back());
+
+    std::vector<size_t> next_up(up_offsets_.begin(), up_offsets_.end() - 1);
+    std::vector<size_t> next_down(down_offsets_.begin(), down_offsets_.end() - 1);
+
+    for_each_edge([&](EdgeId edge_id, VertexId from, VertexId to, Weight weight) {
+        if (ranks_[from] < ranks_[to]) {
+            up_edges_[next_up[from]++] = { to, weight, edge_id };
+        } else {
+            down_edges_[next_down[to]++] = { from, weight, edge_id };
+        }
+    });
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo>
+ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from == to) {
+        return RouteInfo{Weight{}, {}};
+    }
+
+    struct Label {
+        Weight weight;
+        std::optional<EdgeId> prev_edge;
+    };
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>,
+                                      std::greater<QueueItem>>;
+
+    // Search spaces are small, so labels are kept in maps, not in whole arrays
+    std::unordered_map<VertexId, Label> forward_labels{ { from, { Weight{}, std::nullopt } } };
+    std::unordered_map<VertexId, Label> backward_labels{ { to, { Weight{}, std::nullopt } } };
+    Queue forward_queue;
+    Queue backward_queue;
+    forward_queue.push({ Weight{}, from });
+    backward_queue.push({ Weight{}, to });
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+
+    // Searches one step in a direction. Returns false once it can't do better
+    auto step = [&](Queue& queue, std::unordered_map<VertexId, Label>& labels,
+                    const std::unordered_map<VertexId, Label>& other_labels,
+                    const Vector<size_t>& offsets, const Vector<SearchEdge>& search_edges) {
+        const auto [weight, vertex] = queue.top();
+        if (best_weight && !(weight < *best_weight)) {
+            return false;
+        }
+        queue.pop();
+        if (labels.at(vertex).weight < weight) {
+            return true;
+        }
+
+        if (const auto other = other_labels.find(vertex); other != other_labels.end()) {
+            const Weight candidate = weight + other->second.weight;
+            if (!best_weight || candidate < *best_weight) {
+                best_weight = candidate;
+                meeting_vertex = vertex;
+            }
+        }
+
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const SearchEdge& search_edge = search_edges[i];
+            const Weight candidate = weight + search_edge.weight;
+
+            const auto [label, is_new] = labels.try_emplace(search_edge.vertex,
+                                                  Label{ candidate, search_edge.edge });
+            if (is_new || candidate < label->second.weight) {
+                label->second = { candidate, search_edge.edge };
+                queue.push({ candidate, search_edge.vertex });
+            }
+        }
+        return true;
+    };
+
+    bool is_forward_done = false;
+    bool is_backward_done = false;
+    while (!is_forward_done || !is_backward_done) {
+        is_forward_done = is_forward_done || forward_queue.empty();
+        is_backward_done = is_backward_done || backward_queue.empty();
+
+        // The direction with the nearer vertex goes first
+        const bool go_forward = !is_forward_done
+            && (is_backward_done || forward_queue.top() <= backward_queue.top());
+
+        if (go_forward) {
+            is_forward_done = !step(forward_queue, forward_labels, backward_labels,
+                                    up_offsets_, up_edges_);
+        } else if (!is_backward_done) {
+            is_backward_done = !step(backward_queue, backward_labels, forward_labels,
+                                     down_offsets_, down_edges_);
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    // Up from the start to the meeting vertex, then down to the finish
+    std::vector<EdgeId> path;
+    for (std::optional<EdgeId> edge = forward_labels.at(meeting_vertex).prev_edge;
+         edge; edge = forward_labels.at(GetEdgeFrom(*edge)).prev_edge) {
+        path.push_back(*edge);
+    }
+    std::reverse(path.begin(), path.end());
+    for (std::optional<EdgeId> edge = backward_labels.at(meeting_vertex).prev_edge;
+         edge; edge = backward_labels.at(GetEdgeTo(*edge)).prev_edge) {
+        path.push_back(*edge);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const EdgeId edge : path) {
+        UnpackEdge(edge, edges);
+    }
+
+    return RouteInfo{ *best_weight, std::move(edges) };
+}
+
+template <typename Weight>
+size_t ContractionHierarchy<Weight>::GetRank(VertexId vertex) const {
+    return ranks_.at(vertex);
+}
+
+template <typename Weight>
+size_t ContractionHierarchy<Weight>::GetShortcutCount() const {
+    return shortcuts_.size();
+}
+
+template <typename Weight>
+const typename ContractionHierarchy<Weight>::Shortcut&
+ContractionHierarchy<Weight>::GetShortcut(size_t index) const {
+    return shortcuts_.at(index);
+}
+
+template <typename Weight>
+VertexId ContractionHierarchy<Weight>::GetEdgeFrom(EdgeId edge) const {
+    return edge < graph_.GetEdgeCount()
+         ? graph_.GetEdge(edge).from
+         : shortcuts_[edge - graph_.GetEdgeCount()].from;
+}
+
+template <typename Weight>
+VertexId ContractionHierarchy<Weight>::GetEdgeTo(EdgeId edge) const {
+    return edge < graph_.GetEdgeCount()
+         ? graph_.GetEdge(edge).to
+         : shortcuts_[edge - graph_.GetEdgeCount()].to;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(EdgeId edge,
+                                              std::vector<EdgeId>& edges) const {
+    // Shortcuts nest deep on big graphs, so they are unpacked without recursion
+    std::vector<EdgeId> stack{ edge };
+    while (!stack.empty()) {
+        const EdgeId current = stack.back();
+        stack.pop_back();
+
+        if (current < graph_.GetEdgeCount()) {
+            edges.push_back(current);
+            continue;
+        }
+
+        const Shortcut& shortcut = shortcuts_[current - graph_.GetEdgeCount()];
+        stack.push_back(shortcut.second);
+        stack.push_back(shortcut.first);
+    }
+}
+
+}  // namespace graph
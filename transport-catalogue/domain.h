@@ -2,10 +2,13 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "geo.h"
+#include "memory.h"
 
 namespace domain {
 
@@ -27,33 +30,41 @@ public:
 };
 
 enum QueryType {
-    STOP, BUS, MAP, ROUTE
+    STOP, BUS, MAP, ROUTE, ROUTE_MATRIX, ISOCHRONE
 };
 
+// Names, routes and bus sets are counted with the catalogue's memory
+using Name = memory::String<memory::Category::CATALOGUE_NAMES>;
+using Route = memory::Vector<Stop*, memory::Category::CATALOGUE_BUSES>;
+using BusSet = memory::Set<Bus*, memory::Category::CATALOGUE_STOPS, BusCompare>;
+
 struct Bus {
-    Bus(std::string name, 
-        std::vector<Stop*> route,
+    Bus(std::string_view name, 
+        Route route,
         bool is_round = false)
         : name(name)
-        , route(route)
+        , route(std::move(route))
         , is_roundtrip(is_round) {}
 
-    std::string name;
-    std::vector<Stop*> route;
+    Name name;
+    Route route;
     bool is_roundtrip;
 };
 
 struct Stop {
-    Stop(std::string name, 
+    Stop(std::string_view name, 
          geo::Coordinates coordinates, 
-         std::set<Bus*, BusCompare> buses)
+         BusSet buses)
          : name(name)
          , coordinates(coordinates)
-         , buses(buses) {}
+         , buses(std::move(buses)) {}
 
-    std::string name;
+    Name name;
     geo::Coordinates coordinates;
-    std::set<Bus*, BusCompare> buses;
+    BusSet buses;
+
+    // Position of the stop in the catalogue. Ids are dense: [0, stop count)
+    size_t id = 0;
 };
 
 struct Info {
@@ -91,9 +102,36 @@ struct StopInputQuery : public InputQuery {
     std::unordered_map<std::string_view, int> distances;
 };
 
+// A rectangle of the rendered map plane, in svg coordinates
+struct MapViewport {
+    double min_x;
+    double min_y;
+    double max_x;
+    double max_y;
+};
+
+// A tile of the rendered map split into 2^z by 2^z equal tiles
+struct MapTile {
+    int z;
+    int x;
+    int y;
+};
+
+// Formats a map can be given out in
+enum class MapFormat {
+    SVG,    // An svg-document
+    PROTO   // A MapGeometry message encoded in base64
+};
+
 struct MapOutputQuery : public OutputQuery {
     MapOutputQuery(int id)
         : OutputQuery{ id, QueryType::MAP } {}
+
+    // At most one of them is set. Without any the whole map is rendered
+    std::optional<MapViewport> viewport;
+    std::optional<MapTile> tile;
+
+    MapFormat format = MapFormat::SVG;
 };
 
 struct BusOutputQuery : public OutputQuery { 
@@ -108,6 +146,13 @@ struct StopOutputQuery : public OutputQuery {
     std::string_view stop_name;
 };
 
+// What a route is optimized for
+enum class RouteCriterion {
+    TIME,       // The fastest journey
+    TRANSFERS,  // The fastest of the journeys with the fewest buses
+    PARETO      // Every journey not worse than the others in both
+};
+
 struct RouteOutputQuery : public OutputQuery {
     RouteOutputQuery(int id, std::string_view from, 
                              std::string_view to)
@@ -117,6 +162,36 @@ struct RouteOutputQuery : public OutputQuery {
 
     std::string_view from;
     std::string_view to;
+
+    RouteCriterion criterion = RouteCriterion::TIME;
+};
+
+// Asks for total times of the fastest routes between every origin and destination
+struct RouteMatrixOutputQuery : public OutputQuery {
+    RouteMatrixOutputQuery(int id, std::vector<std::string_view> origins,
+                                   std::vector<std::string_view> destinations)
+        : OutputQuery{ id, QueryType::ROUTE_MATRIX }
+        , origins(std::move(origins))
+        , destinations(std::move(destinations)) {}
+
+    std::vector<std::string_view> origins;
+    std::vector<std::string_view> destinations;
+};
+
+// Asks for the stops reachable from a stop within a time limit
+struct IsochroneOutputQuery : public OutputQuery {
+    IsochroneOutputQuery(int id, std::string_view from, double max_time)
+        : OutputQuery{ id, QueryType::ISOCHRONE }
+        , from(from)
+        , max_time(max_time) {}
+
+    std::string_view from;
+
+    // In minutes, like the times of routes
+    double max_time;
+
+    // Whether to render an svg overlay of the reached stops
+    bool render_map = false;
 };
 
 } // namespace domain
\ No newline at end of file
@@ -0,0 +1,646 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+
+#include "generator.h"
+#include "json.h"
+
+namespace generator {
+
+using namespace std::literals;
+
+namespace {
+
+// Generated cities lie around this point
+constexpr geo::Coordinates CITY_CENTER{ 55.75, 37.62 };
+
+// Half of the side of the square a city lies in, in degrees. Grows with
+// the number of stops, so that bigger cities aren't just denser
+double GetCityRadius(size_t stop_count) {
+    return std::clamp(0.02 * std::sqrt(stop_count / 100.0), 0.05, 2.0);
+}
+
+// Share of stops spread over the whole city instead of its districts
+constexpr double SPRAWL_SHARE = 0.15;
+
+// Roads are longer than straight lines between stops by up to this factor
+constexpr double MAX_DETOUR = 1.4;
+
+constexpr double PI = 3.14159265358979323846;
+
+int MakeRoadDistance(geo::Coordinates from, geo::Coordinates to,
+                     std::mt19937& engine) {
+    std::uniform_real_distribution<double> detour(1.0, MAX_DETOUR);
+    return static_cast<int>(std::ceil(geo::ComputeDistance(from, to)
+                                      * detour(engine))) + 1;
+}
+
+// Stops of a city put into a uniform grid to find the ones near a point
+class StopGrid {
+public:
+    StopGrid(const std::vector<City::Stop>& stops, size_t stops_per_cell) {
+        if (stops.empty()) {
+            return;
+        }
+
+        double max_lat = stops.front().coordinates.lat;
+        double max_lng = stops.front().coordinates.lng;
+        min_lat_ = max_lat;
+        min_lng_ = max_lng;
+        for (const City::Stop& stop : stops) {
+            min_lat_ = std::min(min_lat_, stop.coordinates.lat);
+            max_lat = std::max(max_lat, stop.coordinates.lat);
+            min_lng_ = std::min(min_lng_, stop.coordinates.lng);
+            max_lng = std::max(max_lng, stop.coordinates.lng);
+        }
+
+        side_ = std::max<size_t>(1, static_cast<size_t>(
+                    std::sqrt(static_cast<double>(stops.size() / stops_per_cell))));
+        lat_step_ = std::max(max_lat - min_lat_, 1e-9) / side_;
+        lng_step_ = std::max(max_lng - min_lng_, 1e-9) / side_;
+
+        cells_.resize(side_ * side_);
+        for (size_t i = 0; i < stops.size(); ++i) {
+            cells_[GetRow(stops[i].coordinates) * side_
+                   + GetColumn(stops[i].coordinates)].push_back(i);
+        }
+    }
+
+    // Calls func with the index of every stop in the cell of the point
+    // and in the cells around it
+    template <typename Func>
+    void ForEachNear(geo::Coordinates point, Func func) const {
+        const size_t row = GetRow(point);
+        const size_t column = GetColumn(point);
+
+        for (size_t r = row > 0 ? row - 1 : 0; r <= std::min(row + 1, side_ - 1); ++r) {
+            for (size_t c = column > 0 ? column - 1 : 0;
+                 c <= std::min(column + 1, side_ - 1); ++c) {
+                for (const size_t index : cells_[r * side_ + c]) {
+                    func(index);
+                }
+            }
+        }
+    }
+
+private:
+    size_t GetRow(geo::Coordinates point) const {
+        return GetCell((point.lat - min_lat_) / lat_step_);
+    }
+
+    size_t GetColumn(geo::Coordinates point) const {
+        return GetCell((point.lng - min_lng_) / lng_step_);
+    }
+
+    size_t GetCell(double position) const {
+        return std::min(side_ - 1, static_cast<size_t>(std::max(position, 0.0)));
+    }
+
+    double min_lat_ = 0;
+    double min_lng_ = 0;
+    double lat_step_ = 1;
+    double lng_step_ = 1;
+
+    size_t side_ = 1;
+
+    std::vector<std::vector<size_t>> cells_;
+};
+
+// Stops lie in districts of different size around random centers,
+// some of them are spread over the whole city
+std::vector<City::Stop> GenerateStops(size_t stop_count, std::mt19937& engine) {
+    const double radius = GetCityRadius(stop_count);
+    const size_t district_count = std::max<size_t>(
+                    1, static_cast<size_t>(std::sqrt(static_cast<double>(stop_count))) / 4);
+
+    std::uniform_real_distribution<double> offset(-radius, radius);
+    std::uniform_real_distribution<double> weight(0.1, 1.0);
+
+    std::vector<geo::Coordinates> centers;
+    std::vector<double> weights;
+    for (size_t i = 0; i < district_count; ++i) {
+        centers.push_back({ CITY_CENTER.lat + 0.8 * offset(engine),
+                            CITY_CENTER.lng + 0.8 * offset(engine) });
+        weights.push_back(weight(engine));
+    }
+
+    std::discrete_distribution<size_t> district(weights.begin(), weights.end());
+    std::normal_distribution<double> spread(0, radius / std::sqrt(district_count) / 2);
+    std::bernoulli_distribution is_sprawl(SPRAWL_SHARE);
+
+    std::vector<City::Stop> stops;
+    stops.reserve(stop_count);
+    for (size_t i = 0; i < stop_count; ++i) {
+        geo::Coordinates coordinates;
+        if (is_sprawl(engine)) {
+            coordinates = { CITY_CENTER.lat + offset(engine),
+                            CITY_CENTER.lng + offset(engine) };
+        } else {
+            const geo::Coordinates& center = centers[district(engine)];
+            coordinates = { center.lat + spread(engine), center.lng + spread(engine) };
+        }
+        stops.push_back({ "Stop "s + std::to_string(i), coordinates, {} });
+    }
+
+    return stops;
+}
+
+// Angle of the direction from one point to another on a local flat map
+double GetHeading(geo::Coordinates from, geo::Coordinates to) {
+    static const double lng_scale = std::cos(CITY_CENTER.lat * PI / 180);
+    return std::atan2(to.lat - from.lat, (to.lng - from.lng) * lng_scale);
+}
+
+/* Continues the route stop by stop to the nearby stops lying roughly in the
+ * heading direction. The heading turns by the given angle at every stop,
+ * a full turn over a route makes it come back where it started. Stops
+ * early if there is nowhere to go */
+void ContinueRoute(const std::vector<City::Stop>& stops, const StopGrid& grid,
+                   std::vector<size_t>& route, size_t length, double heading,
+                   double turn, std::mt19937& engine) {
+    std::uniform_real_distribution<double> noise(0, 0.6);
+    std::normal_distribution<double> wobble(0, 0.2);
+
+    while (route.size() < length) {
+        const geo::Coordinates& current = stops[route.back()].coordinates;
+
+        std::optional<size_t> next;
+        double best_score = 0;
+        grid.ForEachNear(current, [&](size_t index) {
+            if (std::find(route.begin(), route.end(), index) != route.end()) {
+                return;
+            }
+            const double score = std::cos(GetHeading(current, stops[index].coordinates)
+                                          - heading) + noise(engine);
+            if (!next || score > best_score) {
+                next = index;
+                best_score = score;
+            }
+        });
+
+        if (!next) {
+            return;
+        }
+        route.push_back(*next);
+        heading += turn + wobble(engine);
+    }
+}
+
+// Prints a number the shortest way it can be read back exactly
+void PrintNumber(std::ostream& out, double value) {
+    char chars[32];
+    const auto result = std::to_chars(std::begin(chars), std::end(chars), value);
+    out.write(chars, result.ptr - chars);
+}
+
+void PrintString(std::ostream& out, std::string_view str) {
+    out << '"';
+    json::PrintEscaped(out, str);
+    out << '"';
+}
+
+void PrintColor(std::ostream& out, const svg::Color& color) {
+    if (const auto* rgb = std::get_if<svg::Rgb>(&color)) {
+        out << '[' << int(rgb->red) << ", "sv << int(rgb->green) << ", "sv
+            << int(rgb->blue) << ']';
+    } else if (const auto* rgba = std::get_if<svg::Rgba>(&color)) {
+        out << '[' << int(rgba->red) << ", "sv << int(rgba->green) << ", "sv
+            << int(rgba->blue) << ", "sv;
+        PrintNumber(out, rgba->opacity);
+        out << ']';
+    } else if (const auto* str = std::get_if<std::string>(&color)) {
+        PrintString(out, *str);
+    } else {
+        PrintString(out, "none"sv);
+    }
+}
+
+void PrintPoint(std::ostream& out, const svg::Point& point) {
+    out << '[';
+    PrintNumber(out, point.x);
+    out << ", "sv;
+    PrintNumber(out, point.y);
+    out << ']';
+}
+
+void PrintSerializationSettings(std::ostream& out,
+                                const std::filesystem::path& base_file) {
+    out << "\"serialization_settings\": { \"file\": "sv;
+    PrintString(out, base_file.string());
+    out << " }"sv;
+}
+
+void PrintRenderSettings(std::ostream& out,
+                         const renderer::RenderSettings& settings) {
+    out << "\"render_settings\": {\n"sv;
+
+    const auto print_number = [&out](std::string_view key, double value) {
+        out << "    \""sv << key << "\": "sv;
+        PrintNumber(out, value);
+        out << ",\n"sv;
+    };
+
+    print_number("width"sv, settings.width);
+    print_number("height"sv, settings.height);
+    print_number("padding"sv, settings.padding);
+    print_number("stop_radius"sv, settings.stop_radius);
+    print_number("line_width"sv, settings.line_width);
+    print_number("bus_label_font_size"sv, settings.bus_label_font_size);
+    print_number("stop_label_font_size"sv, settings.stop_label_font_size);
+    print_number("underlayer_width"sv, settings.underlayer_width);
+
+    out << "    \"bus_label_offset\": "sv;
+    PrintPoint(out, settings.bus_label_offset);
+    out << ",\n    \"stop_label_offset\": "sv;
+    PrintPoint(out, settings.stop_label_offset);
+    out << ",\n    \"underlayer_color\": "sv;
+    PrintColor(out, settings.underlayer_color);
+
+    out << ",\n    \"color_palette\": ["sv;
+    for (const svg::Color& color : settings.color_palette) {
+        out << (&color == &settings.color_palette.front() ? " "sv : ", "sv);
+        PrintColor(out, color);
+    }
+    out << " ]\n  }"sv;
+}
+
+double ParseShare(const std::string& value) {
+    const double share = std::stod(value);
+    if (share < 0 || share > 1) {
+        throw std::invalid_argument("A share must be from 0 to 1"s);
+    }
+    return share;
+}
+
+// Parses the comma separated shares of request types
+void ParseMix(std::string_view value, RequestMix& mix) {
+    std::array<double*, 4> shares{ &mix.stop_share, &mix.bus_share,
+                                   &mix.route_share, &mix.map_share };
+
+    for (double* share : shares) {
+        const size_t comma = std::min(value.find(','), value.size());
+        *share = std::stod(std::string(value.substr(0, comma)));
+        if (*share < 0) {
+            throw std::invalid_argument("Request shares can't be negative"s);
+        }
+        value.remove_prefix(std::min(comma + 1, value.size()));
+    }
+
+    if (!value.empty()) {
+        throw std::invalid_argument("The mix has more than 4 shares"s);
+    }
+}
+
+} // namespace
+
+City GenerateCity(const CitySettings& settings) {
+    if (settings.stop_count < 2 && settings.bus_count > 0) {
+        throw std::invalid_argument("Buses need at least two stops"s);
+    }
+    if (settings.min_route_length < 2
+     || settings.min_route_length > settings.max_route_length) {
+        throw std::invalid_argument("Route lengths must make a range "s
+                                    + "starting at 2 or more"s);
+    }
+
+    std::mt19937 engine(settings.seed);
+    City city;
+    city.stops = GenerateStops(settings.stop_count, engine);
+
+    // A few stops per cell keep the choice of the next stop local
+    const StopGrid grid(city.stops, 4);
+
+    // Distance of a road one way. The other way is measured on its own,
+    // so that roads around a block or one-way streets differ
+    const auto measure = [&](size_t from, size_t to) {
+        auto& distances = city.stops[from].distances;
+        const bool is_measured = std::any_of(distances.begin(), distances.end(),
+                                             [to](const auto& distance) {
+                                                 return distance.first == to;
+                                             });
+        if (!is_measured) {
+            distances.push_back({ to, MakeRoadDistance(city.stops[from].coordinates,
+                                                       city.stops[to].coordinates,
+                                                       engine) });
+        }
+    };
+
+    std::uniform_int_distribution<size_t> route_length(settings.min_route_length,
+                                                       settings.max_route_length);
+    std::uniform_int_distribution<size_t> stop_index(0, settings.stop_count - 1);
+    std::uniform_real_distribution<double> heading(-PI, PI);
+    std::bernoulli_distribution is_roundtrip(settings.roundtrip_share);
+    std::bernoulli_distribution shares_section(settings.shared_section_share);
+    std::bernoulli_distribution is_measured_back(0.5);
+
+    city.buses.reserve(settings.bus_count);
+    for (size_t i = 0; i < settings.bus_count; ++i) {
+        City::Bus bus{ "Bus "s + std::to_string(i), {}, is_roundtrip(engine) };
+
+        const size_t length = route_length(engine);
+        double start_heading = heading(engine);
+
+        // Some routes go along a section of an earlier one first
+        if (!city.buses.empty() && shares_section(engine)) {
+            const City::Bus& other = city.buses[
+                std::uniform_int_distribution<size_t>(0, city.buses.size() - 1)(engine)];
+            const size_t other_length = other.stops.size() - (other.is_roundtrip ? 1 : 0);
+            const size_t section = std::uniform_int_distribution<size_t>(
+                        2, std::max<size_t>(2, std::min(other_length, length / 2 + 1)))(engine);
+
+            if (other_length >= section) {
+                const size_t begin = std::uniform_int_distribution<size_t>(
+                                                    0, other_length - section)(engine);
+                bus.stops.assign(other.stops.begin() + begin,
+                                 other.stops.begin() + begin + section);
+                start_heading = GetHeading(
+                            city.stops[bus.stops[section - 2]].coordinates,
+                            city.stops[bus.stops[section - 1]].coordinates);
+            }
+        }
+
+        if (bus.stops.empty()) {
+            bus.stops.push_back(stop_index(engine));
+        }
+        ContinueRoute(city.stops, grid, bus.stops, length, start_heading,
+                      bus.is_roundtrip ? 2 * PI / length : 0, engine);
+
+        // A stop with no stops around still needs a way out
+        while (bus.stops.size() < 2) {
+            const size_t stop = stop_index(engine);
+            if (stop != bus.stops.back()) {
+                bus.stops.push_back(stop);
+            }
+        }
+
+        // A roundtrip route ends where it starts
+        if (bus.is_roundtrip) {
+            bus.stops.push_back(bus.stops.front());
+        }
+
+        for (size_t j = 0; j + 1 < bus.stops.size(); ++j) {
+            measure(bus.stops[j], bus.stops[j + 1]);
+            // Otherwise the way back is as long as the way there
+            if (!bus.is_roundtrip && is_measured_back(engine)) {
+                measure(bus.stops[j + 1], bus.stops[j]);
+            }
+        }
+
+        city.buses.push_back(std::move(bus));
+    }
+
+    return city;
+}
+
+std::vector<StatRequest> GenerateRequests(const City& city,
+                                          const RequestMix& mix) {
+    if (city.stops.empty()) {
+        return {};
+    }
+
+    /* Routes go between stops some bus serves, a stop of no bus would
+     * fail every route at once */
+    std::vector<size_t> served_stops;
+    for (const City::Bus& bus : city.buses) {
+        served_stops.insert(served_stops.end(), bus.stops.begin(), bus.stops.end());
+    }
+    std::sort(served_stops.begin(), served_stops.end());
+    served_stops.erase(std::unique(served_stops.begin(), served_stops.end()),
+                       served_stops.end());
+
+    // Without buses there is nothing to ask about
+    const double bus_share = city.buses.empty() ? 0 : mix.bus_share;
+    const double route_share = served_stops.empty() ? 0 : mix.route_share;
+    if (mix.stop_share + bus_share + route_share + mix.map_share <= 0) {
+        throw std::invalid_argument("No request type can be generated");
+    }
+
+    std::mt19937 engine(mix.seed);
+    std::discrete_distribution<int> type({ mix.stop_share, bus_share,
+                                           route_share, mix.map_share });
+    std::uniform_int_distribution<size_t> stop_index(0, city.stops.size() - 1);
+    std::uniform_int_distribution<size_t> bus_index(0, city.buses.empty()
+                                                       ? 0
+                                                       : city.buses.size() - 1);
+    std::uniform_int_distribution<size_t> served_stop_index(
+                        0, served_stops.empty() ? 0 : served_stops.size() - 1);
+
+    constexpr std::array<domain::QueryType, 4> TYPES{
+        domain::QueryType::STOP, domain::QueryType::BUS,
+        domain::QueryType::ROUTE, domain::QueryType::MAP
+    };
+
+    std::vector<StatRequest> requests;
+    requests.reserve(mix.request_count);
+    while (requests.size() < mix.request_count) {
+        StatRequest request{ TYPES[type(engine)] };
+
+        switch (request.type) {
+        case domain::QueryType::STOP:
+            request.from = stop_index(engine);
+            break;
+        case domain::QueryType::BUS:
+            request.from = bus_index(engine);
+            break;
+        case domain::QueryType::ROUTE:
+            request.from = served_stops[served_stop_index(engine)];
+            request.to = served_stops[served_stop_index(engine)];
+            break;
+        case domain::QueryType::MAP:
+            break;
+        case domain::QueryType::ROUTE_MATRIX:
+            throw std::logic_error("RouteMatrix requests aren't generated");
+        case domain::QueryType::ISOCHRONE:
+            throw std::logic_error("Isochrone requests aren't generated");
+        }
+
+        requests.push_back(request);
+    }
+
+    return requests;
+}
+
+bool ApplyOption(std::string_view option, const std::string& value,
+                 CitySettings& city, RequestMix& mix) {
+    if (option == "--stops"sv) {
+        city.stop_count = std::stoul(value);
+    } else if (option == "--buses"sv) {
+        city.bus_count = std::stoul(value);
+    } else if (option == "--min-route"sv) {
+        city.min_route_length = std::stoul(value);
+    } else if (option == "--max-route"sv) {
+        city.max_route_length = std::stoul(value);
+    } else if (option == "--roundtrip-share"sv) {
+        city.roundtrip_share = ParseShare(value);
+    } else if (option == "--shared-share"sv) {
+        city.shared_section_share = ParseShare(value);
+    } else if (option == "--requests"sv) {
+        mix.request_count = std::stoul(value);
+    } else if (option == "--mix"sv) {
+        ParseMix(value, mix);
+    } else if (option == "--seed"sv) {
+        city.seed = static_cast<uint32_t>(std::stoul(value));
+        mix.seed = city.seed;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string_view GetOptionsUsage() {
+    return "[--stops N] [--buses N] [--min-route N] [--max-route N] "
+           "[--roundtrip-share P] [--shared-share P] [--requests N] "
+           "[--mix STOP,BUS,ROUTE,MAP] [--seed N]"sv;
+}
+
+void FillCatalogue(transport_catalogue::TransportCatalogue& catalogue,
+                   const City& city) {
+    for (const City::Stop& stop : city.stops) {
+        catalogue.AddStop(stop.name, stop.coordinates);
+    }
+    for (const City::Stop& stop : city.stops) {
+        for (const auto& [to, distance] : stop.distances) {
+            catalogue.AddDistance(stop.name, city.stops[to].name, distance);
+        }
+    }
+
+    // A route that isn't round goes back the same way, as JSONReader makes it
+    for (const City::Bus& bus : city.buses) {
+        std::vector<std::string_view> stop_names;
+        for (const size_t stop : bus.stops) {
+            stop_names.push_back(city.stops[stop].name);
+        }
+        if (!bus.is_roundtrip) {
+            for (auto iter = bus.stops.rbegin() + 1; iter != bus.stops.rend(); ++iter) {
+                stop_names.push_back(city.stops[*iter].name);
+            }
+        }
+        catalogue.AddBus(bus.name, stop_names, bus.is_roundtrip);
+    }
+}
+
+renderer::RenderSettings MakeRenderSettings() {
+    renderer::RenderSettings settings;
+
+    settings.width = 1200;
+    settings.height = 1200;
+    settings.padding = 50;
+    settings.stop_radius = 5;
+    settings.line_width = 14;
+    settings.bus_label_font_size = 20;
+    settings.bus_label_offset = svg::Point{ 7, 15 };
+    settings.stop_label_font_size = 20;
+    settings.stop_label_offset = svg::Point{ 7, -3 };
+    settings.underlayer_color = svg::Rgba{ 255, 255, 255, 0.85 };
+    settings.underlayer_width = 3;
+    settings.color_palette = { "green"s, svg::Rgb{ 255, 160, 0 }, "red"s,
+                               svg::Rgba{ 0, 128, 255, 0.9 } };
+
+    return settings;
+}
+
+transport_router::RoutingSettings MakeRoutingSettings() {
+    return { 6, 40 };
+}
+
+void PrintMakeBase(std::ostream& out, const City& city,
+                   const std::filesystem::path& base_file) {
+    const transport_router::RoutingSettings routing = MakeRoutingSettings();
+
+    out << "{\n  "sv;
+    PrintSerializationSettings(out, base_file);
+    out << ",\n  \"routing_settings\": { \"bus_wait_time\": "sv;
+    PrintNumber(out, routing.bus_wait_time);
+    out << ", \"bus_velocity\": "sv;
+    PrintNumber(out, routing.bus_velocity);
+    out << " },\n  "sv;
+    PrintRenderSettings(out, MakeRenderSettings());
+    out << ",\n  \"base_requests\": ["sv;
+
+    bool is_first = true;
+    const auto start_request = [&out, &is_first]() {
+        out << (is_first ? "\n    "sv : ",\n    "sv);
+        is_first = false;
+    };
+
+    for (const City::Stop& stop : city.stops) {
+        start_request();
+        out << "{ \"type\": \"Stop\", \"name\": "sv;
+        PrintString(out, stop.name);
+        out << ", \"latitude\": "sv;
+        PrintNumber(out, stop.coordinates.lat);
+        out << ", \"longitude\": "sv;
+        PrintNumber(out, stop.coordinates.lng);
+        out << ", \"road_distances\": {"sv;
+        for (size_t i = 0; i < stop.distances.size(); ++i) {
+            const auto& [to, distance] = stop.distances[i];
+            out << (i == 0 ? " "sv : ", "sv);
+            PrintString(out, city.stops[to].name);
+            out << ": "sv << distance;
+        }
+        out << " } }"sv;
+    }
+
+    for (const City::Bus& bus : city.buses) {
+        start_request();
+        out << "{ \"type\": \"Bus\", \"name\": "sv;
+        PrintString(out, bus.name);
+        out << ", \"is_roundtrip\": "sv << (bus.is_roundtrip ? "true"sv : "false"sv)
+            << ", \"stops\": ["sv;
+        for (size_t i = 0; i < bus.stops.size(); ++i) {
+            out << (i == 0 ? " "sv : ", "sv);
+            PrintString(out, city.stops[bus.stops[i]].name);
+        }
+        out << " ] }"sv;
+    }
+
+    out << "\n  ]\n}\n"sv;
+}
+
+void PrintStatRequests(std::ostream& out, const City& city,
+                       const std::vector<StatRequest>& requests,
+                       const std::filesystem::path& base_file) {
+    out << "{\n  "sv;
+    PrintSerializationSettings(out, base_file);
+    out << ",\n  \"stat_requests\": ["sv;
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const StatRequest& request = requests[i];
+
+        out << (i == 0 ? "\n    "sv : ",\n    "sv) << "{ \"id\": "sv << i + 1;
+        switch (request.type) {
+        case domain::QueryType::STOP:
+            out << ", \"type\": \"Stop\", \"name\": "sv;
+            PrintString(out, city.stops[request.from].name);
+            break;
+        case domain::QueryType::BUS:
+            out << ", \"type\": \"Bus\", \"name\": "sv;
+            PrintString(out, city.buses[request.from].name);
+            break;
+        case domain::QueryType::ROUTE:
+            out << ", \"type\": \"Route\", \"from\": "sv;
+            PrintString(out, city.stops[request.from].name);
+            out << ", \"to\": "sv;
+            PrintString(out, city.stops[request.to].name);
+            break;
+        case domain::QueryType::MAP:
+            out << ", \"type\": \"Map\""sv;
+            break;
+        case domain::QueryType::ROUTE_MATRIX:
+            throw std::logic_error("RouteMatrix requests aren't generated");
+        case domain::QueryType::ISOCHRONE:
+            throw std::logic_error("Isochrone requests aren't generated");
+        }
+        out << " }"sv;
+    }
+
+    out << "\n  ]\n}\n"sv;
+}
+
+} // namespace generator
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "domain.h"
+#include "geo.h"
+#include "map_renderer.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+/* Synthetic cities and requests to them. Are used to measure and load
+ * the catalogue with data of any size. The same settings and seed always
+ * give the same city */
+namespace generator {
+
+struct CitySettings {
+    size_t stop_count = 1000;
+
+    size_t bus_count = 100;
+
+    // Number of stops a route passes one way. A route in a sparse part
+    // of the city can end before it gets that long
+    size_t min_route_length = 5;
+    size_t max_route_length = 30;
+
+    double roundtrip_share = 0.5;
+
+    // Share of routes starting along a section of an earlier route
+    double shared_section_share = 0.3;
+
+    uint32_t seed = 42;
+};
+
+// Shares of request types among stat_requests. Don't have to add up to 1
+struct RequestMix {
+    size_t request_count = 1000;
+
+    double stop_share  = 0.3;
+    double bus_share   = 0.3;
+    double route_share = 0.39;
+    double map_share   = 0.01;
+
+    uint32_t seed = 42;
+};
+
+struct City {
+    struct Stop {
+        std::string name;
+        geo::Coordinates coordinates;
+
+        // Road distances to other stops given by their indexes
+        std::vector<std::pair<size_t, int>> distances;
+    };
+
+    struct Bus {
+        std::string name;
+
+        // Indexes of the stops the way they are listed in base_requests
+        std::vector<size_t> stops;
+
+        bool is_roundtrip = false;
+    };
+
+    std::vector<Stop> stops;
+
+    std::vector<Bus> buses;
+};
+
+/* A stat request to a city. Stop and Bus requests use from only,
+ * which is an index of a stop or a bus. Map requests use neither */
+struct StatRequest {
+    domain::QueryType type;
+    size_t from = 0;
+    size_t to = 0;
+};
+
+/* Stops lie in districts of random size and some are spread over the city.
+ * Routes go from stop to stop nearby, roundtrip ones turn around to come back.
+ * Road distances are given for every pair of stops next to each other on a
+ * route, the way back is given for half of such pairs and differs from the
+ * way there */
+City GenerateCity(const CitySettings& settings);
+
+/* Route requests go between stops served by some bus. Throws
+ * std::invalid_argument if the mix leaves no type the city can be asked */
+std::vector<StatRequest> GenerateRequests(const City& city,
+                                          const RequestMix& mix);
+
+/* Applies a command line option of the city or the requests, like "--stops".
+ * Returns false for an option it doesn't know, throws std::invalid_argument
+ * for a wrong value */
+bool ApplyOption(std::string_view option, const std::string& value,
+                 CitySettings& city, RequestMix& mix);
+
+// Usage of the options ApplyOption knows
+std::string_view GetOptionsUsage();
+
+/* Adds the stops, distances and buses of the city to the catalogue, the
+ * way make_base adds them from the printed document */
+void FillCatalogue(transport_catalogue::TransportCatalogue& catalogue,
+                   const City& city);
+
+// Settings written into every generated make_base document
+renderer::RenderSettings MakeRenderSettings();
+
+transport_router::RoutingSettings MakeRoutingSettings();
+
+// Prints a make_base document of the city
+void PrintMakeBase(std::ostream& out, const City& city,
+                   const std::filesystem::path& base_file);
+
+// Prints a process_requests document with the given requests
+void PrintStatRequests(std::ostream& out, const City& city,
+                       const std::vector<StatRequest>& requests,
+                       const std::filesystem::path& base_file);
+
+} // namespace generator
@@ -0,0 +1,114 @@
+#include "generator.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+struct GeneratorSettings {
+    generator::CitySettings city;
+    generator::RequestMix mix;
+
+    // Written into serialization_settings of both documents
+    std::filesystem::path base_file = "transport_catalogue.db"s;
+
+    // Where the documents go, "-" stands for the standard output
+    std::optional<std::string> make_base_file;
+    std::optional<std::string> stat_requests_file;
+};
+
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue_generator [--make-base FILE] "sv
+           << "[--stat-requests FILE] [--base-file PATH] "sv
+           << generator::GetOptionsUsage() << '\n';
+}
+
+GeneratorSettings ParseArguments(int argc, char* argv[]) {
+    GeneratorSettings settings;
+
+    for (int i = 1; i < argc; i += 2) {
+        const std::string_view option(argv[i]);
+        if (i + 1 == argc) {
+            throw std::invalid_argument("No value for "s + std::string(option));
+        }
+        const std::string value(argv[i + 1]);
+
+        if (option == "--make-base"sv) {
+            settings.make_base_file = value;
+        } else if (option == "--stat-requests"sv) {
+            settings.stat_requests_file = value;
+        } else if (option == "--base-file"sv) {
+            settings.base_file = value;
+        } else if (!generator::ApplyOption(option, value, settings.city, settings.mix)) {
+            throw std::invalid_argument("Unknown option "s + std::string(option));
+        }
+    }
+
+    if (!settings.make_base_file && !settings.stat_requests_file) {
+        throw std::invalid_argument("Nothing to generate"s);
+    }
+
+    return settings;
+}
+
+// Calls print with the file or the standard output
+template <typename Print>
+void Write(const std::string& file, Print print) {
+    if (file == "-"sv) {
+        print(std::cout);
+        return;
+    }
+
+    std::ofstream out(file);
+    if (!out) {
+        throw std::runtime_error("Can't open "s + file);
+    }
+    print(out);
+    if (!out) {
+        throw std::runtime_error("Can't write "s + file);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    GeneratorSettings settings;
+    try {
+        settings = ParseArguments(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        PrintUsage();
+        return 1;
+    }
+
+    std::ios::sync_with_stdio(false);
+
+    try {
+        const generator::City city = generator::GenerateCity(settings.city);
+
+        if (settings.make_base_file) {
+            Write(*settings.make_base_file, [&](std::ostream& out) {
+                generator::PrintMakeBase(out, city, settings.base_file);
+            });
+        }
+
+        if (settings.stat_requests_file) {
+            const std::vector<generator::StatRequest> requests =
+                generator::GenerateRequests(city, settings.mix);
+            Write(*settings.stat_requests_file, [&](std::ostream& out) {
+                generator::PrintStatRequests(out, city, requests, settings.base_file);
+            });
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
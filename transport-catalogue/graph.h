@@ -1,5 +1,6 @@
 #pragma once
 
+#include "memory.h"
 #include "ranges.h"
 
 #include <cstdlib>
@@ -20,7 +21,7 @@ struct Edge {
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
-    using IncidenceList = std::vector<EdgeId>;
+    using IncidenceList = memory::Vector<EdgeId, memory::Category::GRAPH_INCIDENCE_LISTS>;
     using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
 
 public:
@@ -30,6 +31,8 @@ public:
 
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
+    void SetEdgeWeight(EdgeId edge_id, Weight weight);
+    void ReserveEdges(size_t edge_count);
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
@@ -37,8 +40,8 @@ public:
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
 private:
-    std::vector<Edge<Weight>> edges_;
-    std::vector<IncidenceList> incidence_lists_;
+    memory::Vector<Edge<Weight>, memory::Category::GRAPH_EDGES> edges_;
+    memory::Vector<IncidenceList, memory::Category::GRAPH_INCIDENCE_LISTS> incidence_lists_;
 };
 
 template <typename Weight>
@@ -54,6 +57,16 @@ EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
     return id;
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, Weight weight) {
+    edges_.at(edge_id).weight = weight;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::ReserveEdges(size_t edge_count) {
+    edges_.reserve(edge_count);
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
     return incidence_lists_.size();
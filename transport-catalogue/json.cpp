@@ -278,7 +278,7 @@ bool Node::IsBool() const {
 }
 
 bool Node::IsString() const {
-    return std::holds_alternative<std::string>(*this);
+    return std::holds_alternative<String>(*this);
 }
 
 bool Node::IsNull() const {
@@ -305,7 +305,7 @@ bool Node::AsBool() const {
 }
 
 const std::string& Node::AsString() const {
-    if (IsString()) return std::get<std::string>(*this);
+    if (IsString()) return std::get<String>(*this).Get();
     throw std::logic_error("No std::string in Node");
 }
 
@@ -365,7 +365,7 @@ void PrintValue(std::ostream& out, const int value) {
     out << value;
 }
 
-void PrintValue(std::ostream& out, const Array values) {
+void PrintValue(std::ostream& out, const Array& values) {
     out << "[ ";
     bool is_first = true;
     for (const Node& node : values) {
@@ -382,31 +382,13 @@ void PrintValue(std::ostream& out, const std::nullptr_t) {
     out << "null";
 }
 
-void PrintValue(std::ostream& out, const std::string& value) {
+void PrintValue(std::ostream& out, const String& value) {
     out << '\"';
-    for (const char c : value) {
-        switch (c) {
-            case '\n':
-                out << "\\n";
-                break;
-            case '\r':
-                out << "\\r";
-                break;
-            case '\"':
-                out << "\\\"";
-                break;
-            case '\\':
-                out << "\\\\";
-                break;
-            default:
-                out << c;
-                break;
-        }
-    }
+    PrintEscaped(out, value.Get());
     out << '\"';
 }
 
-void PrintValue(std::ostream& out, const Dict values) {
+void PrintValue(std::ostream& out, const Dict& values) {
     out << "{ ";
     bool is_first = true;
     for (const auto& [key, node] : values) {
@@ -414,7 +396,7 @@ void PrintValue(std::ostream& out, const Dict values) {
             out << ", ";
         }
         is_first = false;
-        out << "\"" << key << "\": ";
+        out << "\"" << key.Get() << "\": ";
         PrintNode(out, node);
     }
     out << " }";
@@ -430,6 +412,48 @@ void PrintNode(std::ostream& out, const Node& value) {
     }, value.GetValue());
 }
 
+void PrintEscaped(std::ostream& out, std::string_view str) {
+    // Characters that need no escaping are written in runs
+    size_t run_start = 0;
+    for (size_t pos = 0; pos < str.size(); ++pos) {
+        std::string_view escaped;
+        switch (str[pos]) {
+            case '\n':
+                escaped = "\\n"sv;
+                break;
+            case '\r':
+                escaped = "\\r"sv;
+                break;
+            case '\"':
+                escaped = "\\\""sv;
+                break;
+            case '\\':
+                escaped = "\\\\"sv;
+                break;
+            default:
+                continue;
+        }
+        out.write(str.data() + run_start, pos - run_start);
+        out.write(escaped.data(), escaped.size());
+        run_start = pos + 1;
+    }
+    out.write(str.data() + run_start, str.size() - run_start);
+}
+
+EscapingStreamBuf::int_type EscapingStreamBuf::overflow(int_type ch) {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+        return traits_type::not_eof(ch);
+    }
+    const char c = traits_type::to_char_type(ch);
+    PrintEscaped(out_, std::string_view(&c, 1));
+    return out_ ? ch : traits_type::eof();
+}
+
+std::streamsize EscapingStreamBuf::xsputn(const char* s, std::streamsize count) {
+    PrintEscaped(out_, std::string_view(s, static_cast<size_t>(count)));
+    return out_ ? count : 0;
+}
+
 void Print(const Document& doc, std::ostream& output) {
     PrintNode(output, doc.GetRoot());
 }
@@ -3,16 +3,22 @@
 #include <iostream>
 #include <map>
 #include <ostream>
+#include <streambuf>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
+#include "memory.h"
+
 namespace json {
 
 class Node;
 
-using Dict = std::map<std::string, Node>;
-using Array = std::vector<Node>;
+// Strings of a document count under its memory, as its containers do
+using String = memory::CountedString<memory::Category::JSON>;
+using Dict = memory::Map<String, Node, memory::Category::JSON>;
+using Array = memory::Vector<Node, memory::Category::JSON>;
 
 // An error that should be thrown when JSON is invalid
 class ParsingError : public std::runtime_error {
@@ -39,12 +45,12 @@ struct PrintContext {
 
 class Node final : private std::variant<std::nullptr_t, 
                                         Array, Dict, bool, 
-                                        int, double, std::string>  {
+                                        int, double, String>  {
 public:
     using variant::variant;
     using Value = std::variant<std::nullptr_t, 
                                Array, Dict, bool, 
-                               int, double, std::string>;
+                               int, double, String>;
 
     const Value& GetValue() const;
 
@@ -111,4 +117,24 @@ void Print(const Document& doc, std::ostream& output);
 // Prints a node of the json
 void PrintNode(std::ostream& out, const Node& node);
 
+// Prints the contents of a JSON string, escaping it, but without the quotes
+void PrintEscaped(std::ostream& out, std::string_view str);
+
+/* A stream buffer that escapes everything written through it as the
+ * contents of a JSON string and passes it on to the given stream. Allows
+ * large strings to be written into a JSON output without building them */
+class EscapingStreamBuf final : public std::streambuf {
+public:
+    explicit EscapingStreamBuf(std::ostream& out)
+        : out_(out) {}
+
+protected:
+    int_type overflow(int_type ch) override;
+
+    std::streamsize xsputn(const char* s, std::streamsize count) override;
+
+private:
+    std::ostream& out_;
+};
+
 }  // namespace json
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <stdexcept>
 #include <exception>
 #include <cassert>
+#include <cstdint>
 #include <ostream>
 #include <sstream>
 #include <variant>
@@ -16,6 +17,7 @@
 #include "json_reader.h"
 #include "domain.h"
 #include "router.h"
+#include "stats.h"
 #include "json.h"
 
 namespace json_reader {
@@ -39,8 +41,61 @@ void PrintLnStopInfo(std::ostream& out, domain::StopInfo stop_info) {
     }
 }
 
+void PrintBase64(std::ostream& out, const std::string_view data) {
+    static constexpr std::string_view ALPHABET = 
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"sv;
+
+    // Every 3 bytes become 4 characters, the last group is padded with '='
+    char group[4];
+    for (size_t i = 0; i < data.size(); i += 3) {
+        const size_t size = std::min<size_t>(3, data.size() - i);
+
+        uint32_t bits = 0;
+        for (size_t j = 0; j < 3; ++j) {
+            const uint32_t byte = j < size 
+                                  ? static_cast<unsigned char>(data[i + j]) 
+                                  : 0;
+            bits = (bits << 8) | byte;
+        }
+
+        for (size_t j = 0; j < 4; ++j) {
+            group[j] = j <= size ? ALPHABET[(bits >> (18 - 6 * j)) & 0x3F] : '=';
+        }
+
+        out.write(group, 4);
+    }
+}
+
 } // namespace json_reader::util
 
+namespace {
+
+json::Document LoadDocument(std::istream& in) {
+    stats::ScopedTimer timer("json_load"sv);
+
+    return json::Load(in);
+}
+
+std::string_view GetQueryTypeName(domain::QueryType type) {
+    switch (type) {
+    case domain::QueryType::STOP:
+        return "Stop"sv;
+    case domain::QueryType::BUS:
+        return "Bus"sv;
+    case domain::QueryType::MAP:
+        return "Map"sv;
+    case domain::QueryType::ROUTE:
+        return "Route"sv;
+    case domain::QueryType::ROUTE_MATRIX:
+        return "RouteMatrix"sv;
+    case domain::QueryType::ISOCHRONE:
+        return "Isochrone"sv;
+    }
+    return "Unknown"sv;
+}
+
+} // namespace
+
 JSONReader::JSONReader(): json_(json::Document{nullptr}) {}
 
 JSONReader::JSONReader(transport_catalogue::TransportCatalogue& tc)
@@ -48,6 +103,8 @@ JSONReader::JSONReader(transport_catalogue::TransportCatalogue& tc)
     , json_(json::Document{nullptr}) {}
 
 void JSONReader::ParseMakeBaseJSON() {
+    stats::ScopedTimer timer("parse_queries"sv);
+
     const json::Dict& root_map = json_.GetRoot().AsMap();
 
     const json::Array& base_requests = root_map.at("base_requests"s).AsArray();
@@ -61,6 +118,10 @@ void JSONReader::ParseMakeBaseJSON() {
     serialization_settings_ = AssembleSerializationSettings(
                                                         serialization_settings);
 
+    ParseBaseRequests(base_requests);
+}
+
+void JSONReader::ParseBaseRequests(const json::Array& base_requests) {
     std::for_each(base_requests.begin(), 
                   base_requests.end(), [this](const json::Node& node) {
 
@@ -79,7 +140,47 @@ void JSONReader::ParseMakeBaseJSON() {
     });
 }
 
+void JSONReader::ParseIncrementalMakeBaseJSON() {
+    stats::ScopedTimer timer("parse_queries"sv);
+
+    const json::Dict& root_map = json_.GetRoot().AsMap();
+
+    if (root_map.count("render_settings"s) > 0) {
+        render_settings_ = AssembleRenderSettings(
+                                               root_map.at("render_settings"s));
+    }
+
+    if (root_map.count("routing_settings"s) > 0) {
+        routing_settings_ = AssembleRoutingSettings(
+                                              root_map.at("routing_settings"s));
+    }
+
+    if (root_map.count("base_requests"s) > 0) {
+        ParseBaseRequests(root_map.at("base_requests"s).AsArray());
+    }
+
+    if (root_map.count("removed_requests"s) == 0) return;
+
+    for (const json::Node& node : root_map.at("removed_requests"s).AsArray()) {
+        const json::Dict& query_map = node.AsMap();
+
+        const std::string_view type = query_map.at("type"s).AsString();
+        const std::string_view name = query_map.at("name"s).AsString();
+
+        if (type == "Stop"sv) {
+            removed_stop_names_.push_back(name);
+        } else if (type == "Bus"sv) {
+            removed_bus_names_.push_back(name);
+        } else {
+            throw std::invalid_argument("Unknown query type: "s 
+                                        + std::string(type));
+        }
+    }
+}
+
 void JSONReader::ParseRequestsJSON() {
+    stats::ScopedTimer timer("parse_queries"sv);
+
     const json::Dict& root_map = json_.GetRoot().AsMap();
     const json::Array& stat_requests  = root_map.at("stat_requests"s).AsArray();
     const json::Node& serialization_settings = 
@@ -106,6 +207,14 @@ void JSONReader::ParseRequestsJSON() {
         } else if (type == "Route"sv) {
             route_output_queries_.push_back(AssembleRouteOutputQuery(node));
             query_ptrs_.push_back(&route_output_queries_.back());
+        } else if (type == "RouteMatrix"sv) {
+            route_matrix_output_queries_.push_back(
+                                        AssembleRouteMatrixOutputQuery(node));
+            query_ptrs_.push_back(&route_matrix_output_queries_.back());
+        } else if (type == "Isochrone"sv) {
+            isochrone_output_queries_.push_back(
+                                        AssembleIsochroneOutputQuery(node));
+            query_ptrs_.push_back(&isochrone_output_queries_.back());
         } else {
             throw std::invalid_argument("Unknown query type: "s 
                                          + std::string(type));
@@ -117,10 +226,11 @@ void JSONReader::InitializeRouter() {
     using namespace transport_router;
 
     router_ = std::make_shared<TransportRouter>(*catalogue_, routing_settings_);
+    raptor_router_.reset();
 }
 
 void JSONReader::LoadJSON(std::istream& in) {
-    json_ = json::Load(in);
+    json_ = LoadDocument(in);
 
     ParseMakeBaseJSON();
     ExecuteInputQueries();
@@ -128,9 +238,13 @@ void JSONReader::LoadJSON(std::istream& in) {
 }
 
 void JSONReader::LoadMakeBaseJSON(std::istream& in) {
-    json_ = json::Load(in);
+    json_ = LoadDocument(in);
 
     catalogue_ = std::make_shared<transport_catalogue::TransportCatalogue>();
+    escaped_map_.reset();
+    map_index_.reset();
+    map_layout_.reset();
+    map_renderer_.reset();
 
     ParseMakeBaseJSON();
     ExecuteInputQueries();
@@ -138,8 +252,57 @@ void JSONReader::LoadMakeBaseJSON(std::istream& in) {
     SerializeBase();
 }
 
+void JSONReader::LoadIncrementalMakeBaseJSON(std::istream& in) {
+    using TransportRouter = transport_router::TransportRouter;
+
+    json_ = LoadDocument(in);
+
+    const json::Dict& root_map = json_.GetRoot().AsMap();
+    serialization_settings_ = AssembleSerializationSettings(
+                                        root_map.at("serialization_settings"s));
+
+    DeserializeBase();
+
+    const transport_router::TransportRouterInfo router_info = 
+                                                base_reader_->ReadRouterInfo();
+    const transport_router::RoutingSettings old_routing_settings = 
+                                              router_info.GetRoutingSettings();
+    render_settings_  = base_reader_->ReadRenderSettings();
+    routing_settings_ = old_routing_settings;
+
+    // The base is rewritten in place, so it has to be closed beforehand
+    base_reader_.reset();
+    base_stream_.reset();
+
+    ParseIncrementalMakeBaseJSON();
+
+    std::unordered_set<std::string_view> stale_bus_names = 
+                                                        ExecuteDeltaQueries();
+
+    // Every edge weight depends on routing settings
+    if (routing_settings_.bus_velocity  != old_routing_settings.bus_velocity
+     || routing_settings_.bus_wait_time != old_routing_settings.bus_wait_time) {
+        for (const std::string_view bus_name : catalogue_->GetBusNames()) {
+            stale_bus_names.insert(bus_name);
+        }
+    }
+
+    router_ = std::make_shared<TransportRouter>(*catalogue_, 
+                                                routing_settings_,
+                                                router_info, 
+                                                stale_bus_names);
+    raptor_router_.reset();
+    SerializeBase();
+}
+
+void JSONReader::LoadIncrementalMakeBaseJSON(const std::string& in) {
+    std::istringstream string_in(in);
+
+    LoadIncrementalMakeBaseJSON(string_in);
+}
+
 void JSONReader::LoadRequestsJSON(std::istream& in) {
-    json_ = json::Load(in);
+    json_ = LoadDocument(in);
     ParseRequestsJSON();
     DeserializeBase();
 }
@@ -207,34 +370,200 @@ json::Node JSONReader::AssembleStopNode(domain::StopInfoOpt& stop_info_opt,
     return AssembleErrorNode(id);
 }
 
-json::Node JSONReader::AssembleMapNode(int id) const {
-    renderer::MapRenderer renderer(render_settings_);
+const std::string& JSONReader::GetEscapedMap() const {
+    if (!escaped_map_) {
+        std::ostringstream out;
+        json::EscapingStreamBuf escaping_buf(out);
+        std::ostream escaping_out(&escaping_buf);
 
-    svg::Document document = renderer.RenderMap(*catalogue_);
+        // The svg goes through the escaping stream as soon as it is rendered
+        const renderer::MapRenderer::MapLayout& layout = GetMapLayout();
+        map_renderer_->RenderMap(layout, 
+                                 renderer::MapRenderer::SelectWholeMap(layout), 
+                                 escaping_out);
 
-    std::ostringstream out;
+        escaped_map_ = out.str();
+    }
 
-    document.Render(out);
+    return *escaped_map_;
+}
 
-    return json::Builder{}
-                .StartDict()
-                    .Key("map"s).Value(out.str())
-                    .Key("request_id"s).Value(id)
-                .EndDict().Build();
+const renderer::MapRenderer::MapLayout& JSONReader::GetMapLayout() const {
+    if (!map_layout_) {
+        map_renderer_ = std::make_unique<renderer::MapRenderer>(
+                                                        GetRenderSettings());
+        map_layout_ = std::make_unique<renderer::MapRenderer::MapLayout>(
+                                    map_renderer_->MakeMapLayout(*catalogue_));
+    }
+
+    return *map_layout_;
+}
+
+const renderer::MapIndex& JSONReader::GetMapIndex() const {
+    if (!map_index_) {
+        map_index_ = std::make_unique<renderer::MapIndex>(GetMapLayout());
+    }
+
+    return *map_index_;
+}
+
+void JSONReader::PrintMapNode(std::ostream& out, 
+                              const domain::MapOutputQuery& query) const {
+    // Matches the way json::Print outputs a {"map", "request_id"} dict
+    out << "{ \"map\": \""sv;
+
+    std::optional<domain::MapViewport> viewport = query.viewport;
+    if (query.tile) {
+        viewport = renderer::TileToViewport(*query.tile, GetRenderSettings());
+    }
+
+    std::optional<svg::ViewBox> view_box;
+    if (viewport) {
+        view_box = svg::ViewBox{ viewport->min_x, viewport->min_y,
+                                 viewport->max_x - viewport->min_x,
+                                 viewport->max_y - viewport->min_y };
+    }
+
+    if (query.format == domain::MapFormat::PROTO) {
+        const renderer::MapRenderer::MapLayout& layout = GetMapLayout();
+
+        std::ostringstream geometry;
+        serialization::svg::MapGeometrySerializer::Serialize(
+                *map_renderer_, layout, 
+                viewport ? GetMapIndex().Select(*viewport)
+                         : renderer::MapRenderer::SelectWholeMap(layout),
+                view_box, geometry);
+
+        // Base64 has nothing to escape in a JSON string
+        util::PrintBase64(out, geometry.str());
+    } else if (!viewport) {
+        out << GetEscapedMap();
+    } else {
+        const renderer::MapIndex& index = GetMapIndex();
+
+        // Only the visible part is rendered, straight into the response
+        json::EscapingStreamBuf escaping_buf(out);
+        std::ostream escaping_out(&escaping_buf);
+        map_renderer_->RenderMap(index.GetLayout(), index.Select(*viewport), 
+                                 escaping_out, view_box);
+    }
+
+    out << "\", \"request_id\": "sv << query.id << " }"sv;
+}
+
+void JSONReader::PrintRouteMatrixNode(std::ostream& out, 
+                          const domain::RouteMatrixOutputQuery& query) const {
+    const transport_router::RouteMatrix matrix = 
+                GetRouter().BuildRouteMatrix(query.origins, query.destinations);
+
+    // Matches the way json::Print outputs a {"request_id", "total_times"} dict
+    out << "{ \"request_id\": "sv << query.id << ", \"total_times\": [ "sv;
+
+    for (size_t i = 0; i < matrix.size(); ++i) {
+        out << (i == 0 ? "[ "sv : ", [ "sv);
+
+        for (size_t j = 0; j < matrix[i].size(); ++j) {
+            if (j > 0) {
+                out << ", "sv;
+            }
+            if (matrix[i][j].has_value()) {
+                out << *matrix[i][j];
+            } else {
+                out << "null"sv;
+            }
+        }
+
+        out << " ]"sv;
+    }
+
+    out << " ] }"sv;
 }
 
 json::Node JSONReader::AssembleRouteNode(
                   std::optional<transport_router::RoutingResult> routing_result,
                                                                  int id) const {
-    using namespace transport_router;
-
     if (!routing_result.has_value()) {
         return AssembleErrorNode(id);
     }
-    
+
+    return json::Builder{}.StartDict()
+                .Key("request_id").Value(id)
+                .Key("total_time").Value(routing_result->total_time)
+                .Key("items").Value(AssembleRouteItems(*routing_result))
+            .EndDict().Build();
+}
+
+json::Node JSONReader::AssembleRoutesNode(
+            const std::vector<transport_router::RoutingResult>& routing_results,
+                                                                 int id) const {
+    if (routing_results.empty()) {
+        return AssembleErrorNode(id);
+    }
+
+    json::Array routes_array;
+
+    for (const transport_router::RoutingResult& routing_result : routing_results) {
+        routes_array.push_back(json::Builder{}.StartDict()
+                .Key("total_time").Value(routing_result.total_time)
+                .Key("items").Value(AssembleRouteItems(routing_result))
+            .EndDict().Build());
+    }
+
+    return json::Builder{}.StartDict()
+                .Key("request_id").Value(id)
+                .Key("routes").Value(routes_array)
+            .EndDict().Build();
+}
+
+json::Node JSONReader::AssembleIsochroneNode(
+                            const domain::IsochroneOutputQuery& query) const {
+    const std::optional<std::vector<transport_router::ReachableStop>> 
+        reachable_stops = GetRouter().BuildIsochrone(query.from, query.max_time);
+
+    if (!reachable_stops.has_value()) {
+        return AssembleErrorNode(query.id);
+    }
+
+    json::Array stops_array;
+    stops_array.reserve(reachable_stops->size());
+
+    for (const transport_router::ReachableStop& stop : *reachable_stops) {
+        stops_array.push_back(json::Builder{}.StartDict()
+                .Key("stop_name").Value(std::string(stop.stop_name))
+                .Key("time").Value(stop.time)
+            .EndDict().Build());
+    }
+
+    json::Dict response {
+        { "request_id"s, query.id },
+        { "stops"s, std::move(stops_array) }
+    };
+
+    if (query.render_map) {
+        std::vector<std::pair<size_t, double>> stop_times;
+        stop_times.reserve(reachable_stops->size());
+        for (const transport_router::ReachableStop& stop : *reachable_stops) {
+            stop_times.emplace_back(catalogue_->FindStop(stop.stop_name)->id, 
+                                    stop.time);
+        }
+
+        std::ostringstream overlay;
+        const renderer::MapRenderer::MapLayout& layout = GetMapLayout();
+        map_renderer_->RenderIsochrone(layout, stop_times, query.max_time, overlay);
+
+        response["map"s] = overlay.str();
+    }
+
+    return response;
+}
+
+json::Array JSONReader::AssembleRouteItems(
+                const transport_router::RoutingResult& routing_result) const {
+    using namespace transport_router;
+
     json::Array items_array;
 
-    for (const RouteItem& item : routing_result->items) {
+    for (const RouteItem& item : routing_result.items) {
         if (std::holds_alternative<RouteItemBus>(item)) {
             RouteItemBus bus_item = std::get<RouteItemBus>(item);
 
@@ -261,11 +590,7 @@ json::Node JSONReader::AssembleRouteNode(
         }
     }
 
-    return json::Builder{}.StartDict()
-                .Key("request_id").Value(id)
-                .Key("total_time").Value(routing_result->total_time)
-                .Key("items").Value(items_array)
-            .EndDict().Build();
+    return items_array;
 }
 
 domain::MapOutputQuery JSONReader::AssembleMapOutputQuery(
@@ -273,7 +598,56 @@ domain::MapOutputQuery JSONReader::AssembleMapOutputQuery(
     const json::Dict& request_map = query_node.AsMap();
     const int id = request_map.at("id").AsInt();
 
-    return { id };
+    domain::MapOutputQuery query(id);
+
+    if (request_map.count("bbox"s) > 0 && request_map.count("tile"s) > 0) {
+        throw std::invalid_argument("Map request can't have both a bbox "s
+                                    + "and a tile"s);
+    }
+
+    if (request_map.count("bbox"s) > 0) {
+        const json::Dict& bbox = request_map.at("bbox"s).AsMap();
+        query.viewport = domain::MapViewport{ bbox.at("min_x"s).AsDouble(),
+                                              bbox.at("min_y"s).AsDouble(),
+                                              bbox.at("max_x"s).AsDouble(),
+                                              bbox.at("max_y"s).AsDouble() };
+
+        if (query.viewport->min_x > query.viewport->max_x
+         || query.viewport->min_y > query.viewport->max_y) {
+            throw std::invalid_argument("Map bbox has min greater than max"s);
+        }
+    }
+
+    if (request_map.count("format"s) > 0) {
+        const std::string& format = request_map.at("format"s).AsString();
+
+        if (format == "svg"s) {
+            query.format = domain::MapFormat::SVG;
+        } else if (format == "proto"s) {
+            query.format = domain::MapFormat::PROTO;
+        } else {
+            throw std::invalid_argument("Unknown map format "s + format);
+        }
+    }
+
+    if (request_map.count("tile"s) > 0) {
+        // Beyond that tiles are smaller than a double can tell apart
+        constexpr int MAX_ZOOM = 30;
+
+        const json::Dict& tile = request_map.at("tile"s).AsMap();
+        query.tile = domain::MapTile{ tile.at("z"s).AsInt(),
+                                      tile.at("x"s).AsInt(),
+                                      tile.at("y"s).AsInt() };
+
+        const int z = query.tile->z;
+        if (z < 0 || z > MAX_ZOOM 
+         || query.tile->x < 0 || query.tile->x >= (1 << z)
+         || query.tile->y < 0 || query.tile->y >= (1 << z)) {
+            throw std::invalid_argument("Map tile is out of range"s);
+        }
+    }
+
+    return query;
 }
 
 domain::StopOutputQuery JSONReader::AssembleStopOutputQuery(
@@ -327,7 +701,7 @@ domain::StopInputQuery JSONReader::AssembleStopInputQuery(const json::Node& quer
     std::unordered_map<std::string_view, int> distances;
 
     for (const auto& [name, node] : request_map.at("road_distances"s).AsMap()) {
-        distances[name] = node.AsInt();
+        distances[name.Get()] = node.AsInt();
     }
 
     return { stop_name, std::move(coordinates), std::move(distances) };
@@ -340,7 +714,61 @@ domain::RouteOutputQuery JSONReader::AssembleRouteOutputQuery(
     const std::string_view to     = request_map.at("to").AsString();
     const int id = request_map.at("id").AsInt();
 
-    return { id, from, to };
+    domain::RouteOutputQuery query(id, from, to);
+
+    if (request_map.count("criterion"s) > 0) {
+        const std::string& criterion = request_map.at("criterion"s).AsString();
+
+        if (criterion == "time"s) {
+            query.criterion = domain::RouteCriterion::TIME;
+        } else if (criterion == "transfers"s) {
+            query.criterion = domain::RouteCriterion::TRANSFERS;
+        } else if (criterion == "pareto"s) {
+            query.criterion = domain::RouteCriterion::PARETO;
+        } else {
+            throw std::invalid_argument("Unknown route criterion "s + criterion);
+        }
+    }
+
+    return query;
+}
+
+domain::RouteMatrixOutputQuery JSONReader::AssembleRouteMatrixOutputQuery(
+                                           const json::Node& query_node) const {
+    const json::Dict& request_map = query_node.AsMap();
+    const int id = request_map.at("id"s).AsInt();
+
+    std::vector<std::string_view> origins;
+    for (const json::Node& node : request_map.at("origins"s).AsArray()) {
+        origins.push_back(node.AsString());
+    }
+
+    std::vector<std::string_view> destinations;
+    for (const json::Node& node : request_map.at("destinations"s).AsArray()) {
+        destinations.push_back(node.AsString());
+    }
+
+    return { id, std::move(origins), std::move(destinations) };
+}
+
+domain::IsochroneOutputQuery JSONReader::AssembleIsochroneOutputQuery(
+                                           const json::Node& query_node) const {
+    const json::Dict& request_map = query_node.AsMap();
+    const int id = request_map.at("id"s).AsInt();
+    const std::string_view from = request_map.at("from"s).AsString();
+    const double max_time = request_map.at("max_time"s).AsDouble();
+
+    if (max_time < 0) {
+        throw std::invalid_argument("Isochrone max_time can't be negative"s);
+    }
+
+    domain::IsochroneOutputQuery query(id, from, max_time);
+
+    if (request_map.count("render_map"s) > 0) {
+        query.render_map = request_map.at("render_map"s).AsBool();
+    }
+
+    return query;
 }
 
 renderer::RenderSettings JSONReader::AssembleRenderSettings(const json::Node& render_settings) const {
@@ -379,6 +807,26 @@ renderer::RenderSettings JSONReader::AssembleRenderSettings(const json::Node& re
         rs.color_palette.push_back(ExtractColor(color_node));
     }
 
+    if (settings_map.count("route_simplification_tolerance"s) > 0) {
+        rs.route_simplification_tolerance = 
+                  settings_map.at("route_simplification_tolerance"s).AsDouble();
+        if (rs.route_simplification_tolerance < 0) {
+            throw std::invalid_argument("Route simplification tolerance "s
+                                        + "can't be negative"s);
+        }
+    }
+
+    if (settings_map.count("coordinate_precision"s) > 0) {
+        rs.coordinate_precision = 
+                            settings_map.at("coordinate_precision"s).AsInt();
+        constexpr int MAX_PRECISION = 
+                            renderer::RenderSettings::MAX_COORDINATE_PRECISION;
+        if (*rs.coordinate_precision < 0 
+         || *rs.coordinate_precision > MAX_PRECISION) {
+            throw std::invalid_argument("Coordinate precision is out of range"s);
+        }
+    }
+
     return rs;
 }
 
@@ -389,7 +837,18 @@ transport_router::RoutingSettings JSONReader::AssembleRoutingSettings(
     double bus_velocity  = settings_map.at("bus_velocity").AsDouble();
     double bus_wait_time = settings_map.at("bus_wait_time").AsDouble();
 
-    return { bus_wait_time, bus_velocity };
+    bool contraction_hierarchy = false;
+    if (settings_map.count("contraction_hierarchy"s) > 0) {
+        contraction_hierarchy = 
+                        settings_map.at("contraction_hierarchy"s).AsBool();
+    }
+
+    bool a_star = false;
+    if (settings_map.count("a_star"s) > 0) {
+        a_star = settings_map.at("a_star"s).AsBool();
+    }
+
+    return { bus_wait_time, bus_velocity, contraction_hierarchy, a_star };
 }
 
 serialization::SerializationSettings JSONReader::AssembleSerializationSettings(
@@ -424,88 +883,219 @@ svg::Color JSONReader::ExtractColor(const json::Node& node) const {
 }
 
 void JSONReader::ExecuteInputQueries() {
-    std::for_each(stop_input_queries_.begin(), 
-                  stop_input_queries_.end(), 
-        [this](const domain::StopInputQuery& stop_query) {
-        
-        catalogue_->AddStop(std::string(stop_query.name), 
-                            stop_query.coordinates);
-    });
-    std::for_each(stop_input_queries_.begin(), 
-                  stop_input_queries_.end(), 
-        [this](const domain::StopInputQuery& stop_query) {
-        
+    stats::ScopedTimer timer("execute_input_queries"sv);
+
+    catalogue_->AddStops(stop_input_queries_);
+    catalogue_->AddDistances(stop_input_queries_);
+    catalogue_->AddBuses(bus_input_queries_);
+}
+
+std::unordered_set<std::string_view> JSONReader::ExecuteDeltaQueries() {
+    stats::ScopedTimer timer("execute_delta_queries"sv);
+
+    std::unordered_set<std::string_view> stale_bus_names;
+
+    for (const std::string_view bus_name : removed_bus_names_) {
+        catalogue_->RemoveBus(bus_name);
+        stale_bus_names.insert(bus_name);
+    }
+
+    for (const domain::StopInputQuery& stop_query : stop_input_queries_) {
+        if (catalogue_->HasStop(stop_query.name)) {
+            catalogue_->SetStopCoordinates(stop_query.name, 
+                                           stop_query.coordinates);
+        } else {
+            catalogue_->AddStop(stop_query.name, stop_query.coordinates);
+        }
+    }
+
+    for (const domain::StopInputQuery& stop_query : stop_input_queries_) {
         for (const auto& [dest_name, distance] : stop_query.distances) {
             catalogue_->AddDistance(stop_query.name, dest_name, distance);
         }
-    });
-    std::for_each(bus_input_queries_.begin(), 
-                  bus_input_queries_.end(), 
-        [this](const domain::BusInputQuery& bus_query) {
-        
-        catalogue_->AddBus(std::string(bus_query.name), bus_query.stop_names, bus_query.is_roundtrip);
-    });
+    }
+
+    for (const domain::BusInputQuery& bus_query : bus_input_queries_) {
+        if (catalogue_->HasBus(bus_query.name)) {
+            catalogue_->SetBusRoute(bus_query.name, bus_query.stop_names, 
+                                    bus_query.is_roundtrip);
+        } else {
+            catalogue_->AddBus(bus_query.name, bus_query.stop_names, 
+                               bus_query.is_roundtrip);
+        }
+
+        stale_bus_names.insert(bus_query.name);
+    }
+
+    /* A changed distance may be used in either direction, so every bus 
+     * serving both stops gets recomputed */
+    for (const domain::StopInputQuery& stop_query : stop_input_queries_) {
+        const domain::StopPtr from_ptr = catalogue_->FindStop(stop_query.name);
+
+        for (const auto& [dest_name, distance] : stop_query.distances) {
+            const domain::StopPtr to_ptr = catalogue_->FindStop(dest_name);
+
+            for (const domain::BusPtr bus_ptr : from_ptr->buses) {
+                if (to_ptr->buses.count(bus_ptr) > 0) {
+                    stale_bus_names.insert(bus_ptr->name);
+                }
+            }
+        }
+    }
+
+    for (const std::string_view stop_name : removed_stop_names_) {
+        catalogue_->RemoveStop(stop_name);
+    }
+
+    return stale_bus_names;
 }
 
 void JSONReader::ExecuteOutputQueries(std::ostream& out) const {
-    json::Array output_array;
+    stats::ScopedTimer timer("execute_output_queries"sv);
+
+    /* The array is printed element by element, the same way json::Print
+     * would do it, so that map responses can be written without putting 
+     * the whole svg into a json::Node */
+    out << "[ "sv;
 
+    bool is_first = true;
     std::for_each(query_ptrs_.begin(), 
                   query_ptrs_.end(), 
-        [this, &output_array](const domain::OutputQuery* query_ptr) {
+        [this, &out, &is_first](const domain::OutputQuery* query_ptr) {
+
+        if (!is_first) {
+            out << ", "sv;
+        }
+        is_first = false;
+
+        const bool is_timed = stats::IsEnabled();
+        const stats::Clock::time_point start = is_timed ? stats::Clock::now()
+                                                        : stats::Clock::time_point{};
+
+        ExecuteOutputQuery(out, *query_ptr);
+
+        if (is_timed) {
+            stats::AddQuery(GetQueryTypeName(query_ptr->type),
+                            stats::Clock::now() - start, [this, query_ptr]() {
+                return AssembleQueryDetails(*query_ptr);
+            });
+        }
+    });
+
+    out << " ]"sv;
+}
+
+void JSONReader::ExecuteOutputQuery(std::ostream& out, 
+                                    const domain::OutputQuery& query) const {
+    if (query.type == domain::QueryType::STOP) {
         
-        if (query_ptr->type == domain::QueryType::STOP) {
-            
-            const domain::StopOutputQuery* stop_query_ptr {
-                static_cast<const domain::StopOutputQuery*>(query_ptr)
-            };
-            
-            domain::StopInfoOpt stop_info_opt {
-                catalogue_->GetStopInfo(stop_query_ptr->stop_name)
-            };
-            
-            output_array.push_back(AssembleStopNode(stop_info_opt, 
-                                                    query_ptr->id));
+        const domain::StopOutputQuery& stop_query {
+            static_cast<const domain::StopOutputQuery&>(query)
+        };
         
-        } else if (query_ptr->type == domain::QueryType::BUS) {
+        domain::StopInfoOpt stop_info_opt {
+            catalogue_->GetStopInfo(stop_query.stop_name)
+        };
         
-            const domain::BusOutputQuery* bus_query_ptr {
-                static_cast<const domain::BusOutputQuery*>(query_ptr)            
-            };
+        json::PrintNode(out, AssembleStopNode(stop_info_opt, query.id));
+    
+    } else if (query.type == domain::QueryType::BUS) {
+    
+        const domain::BusOutputQuery& bus_query {
+            static_cast<const domain::BusOutputQuery&>(query)
+        };
 
-            domain::BusInfoOpt bus_info_opt {
-                catalogue_->GetBusInfo(bus_query_ptr->bus_name)
-            }; 
-            
-            output_array.push_back(AssembleBusNode(bus_info_opt, 
-                                                   query_ptr->id));
+        domain::BusInfoOpt bus_info_opt {
+            catalogue_->GetBusInfo(bus_query.bus_name)
+        }; 
         
-        } else if (query_ptr->type == domain::QueryType::MAP) {
+        json::PrintNode(out, AssembleBusNode(bus_info_opt, query.id));
+    
+    } else if (query.type == domain::QueryType::MAP) {
+    
+        PrintMapNode(out, static_cast<const domain::MapOutputQuery&>(query));
+
+    } else if (query.type == domain::QueryType::ROUTE) {
         
-            const domain::MapOutputQuery* map_query_ptr {
-                static_cast<const domain::MapOutputQuery*>(query_ptr)
-            };
+        const domain::RouteOutputQuery& route_query {
+            static_cast<const domain::RouteOutputQuery&>(query)
+        };
         
-            output_array.push_back(AssembleMapNode(map_query_ptr->id));
-
-        } else if (query_ptr->type == domain::QueryType::ROUTE) {
-            
-            const domain::RouteOutputQuery* route_query_ptr {
-                static_cast<const domain::RouteOutputQuery*>(query_ptr)
-            };
-            
+        if (route_query.criterion == domain::RouteCriterion::PARETO) {
+            json::PrintNode(out, AssembleRoutesNode(
+                GetRaptorRouter().BuildRoutes(route_query.from, route_query.to),
+                query.id));
+        } else {
+            // The table of the graph router answers the fastest routes at once
             std::optional<transport_router::RoutingResult> routing_result {
-                router_->BuildRoute(route_query_ptr->from, 
-                                    route_query_ptr->to)
+                route_query.criterion == domain::RouteCriterion::TIME
+                    ? GetRouter().BuildRoute(route_query.from, route_query.to)
+                    : GetRaptorRouter().BuildRoute(route_query.from, route_query.to,
+                                                   route_query.criterion)
             };
-            
-            output_array.push_back(AssembleRouteNode(routing_result, 
-                                                     route_query_ptr->id));
+
+            json::PrintNode(out, AssembleRouteNode(routing_result, query.id));
         }
-    });
+    } else if (query.type == domain::QueryType::ROUTE_MATRIX) {
+
+        PrintRouteMatrixNode(out, 
+                    static_cast<const domain::RouteMatrixOutputQuery&>(query));
+
+    } else if (query.type == domain::QueryType::ISOCHRONE) {
+
+        json::PrintNode(out, AssembleIsochroneNode(
+                    static_cast<const domain::IsochroneOutputQuery&>(query)));
+    }
+}
+
+json::Dict JSONReader::AssembleQueryDetails(
+                                    const domain::OutputQuery& query) const {
+    json::Dict details{ { "id"s, query.id } };
+
+    if (query.type == domain::QueryType::STOP) {
+        details["name"s] = std::string(
+                static_cast<const domain::StopOutputQuery&>(query).stop_name);
+    } else if (query.type == domain::QueryType::BUS) {
+        details["name"s] = std::string(
+                static_cast<const domain::BusOutputQuery&>(query).bus_name);
+    } else if (query.type == domain::QueryType::ROUTE) {
+        const auto& route_query = static_cast<const domain::RouteOutputQuery&>(query);
+        details["from"s] = std::string(route_query.from);
+        details["to"s] = std::string(route_query.to);
+        if (route_query.criterion == domain::RouteCriterion::TRANSFERS) {
+            details["criterion"s] = "transfers"s;
+        } else if (route_query.criterion == domain::RouteCriterion::PARETO) {
+            details["criterion"s] = "pareto"s;
+        }
+    } else if (query.type == domain::QueryType::ROUTE_MATRIX) {
+        const auto& matrix_query = 
+                    static_cast<const domain::RouteMatrixOutputQuery&>(query);
+        details["origins"s] = static_cast<int>(matrix_query.origins.size());
+        details["destinations"s] = static_cast<int>(matrix_query.destinations.size());
+    } else if (query.type == domain::QueryType::ISOCHRONE) {
+        const auto& isochrone_query = 
+                    static_cast<const domain::IsochroneOutputQuery&>(query);
+        details["from"s] = std::string(isochrone_query.from);
+        details["max_time"s] = isochrone_query.max_time;
+    } else if (query.type == domain::QueryType::MAP) {
+        const auto& map_query = static_cast<const domain::MapOutputQuery&>(query);
+
+        details["format"s] = map_query.format == domain::MapFormat::PROTO 
+                           ? "proto"s : "svg"s;
+        if (map_query.viewport) {
+            details["bbox"s] = json::Dict{ { "min_x"s, map_query.viewport->min_x },
+                                           { "min_y"s, map_query.viewport->min_y },
+                                           { "max_x"s, map_query.viewport->max_x },
+                                           { "max_y"s, map_query.viewport->max_y } };
+        }
+        if (map_query.tile) {
+            details["tile"s] = json::Dict{ { "z"s, map_query.tile->z },
+                                           { "x"s, map_query.tile->x },
+                                           { "y"s, map_query.tile->y } };
+        }
+    }
 
-    json::Document output_doc{output_array};
-    json::Print(output_doc, out);
+    return details;
 }
 
 void JSONReader::SerializeBase() const {
@@ -513,25 +1103,71 @@ void JSONReader::SerializeBase() const {
 
     std::ofstream ofs(serialization_settings_.filename, std::ios::binary);
 
-    DatabaseSerializer::Serialize(*catalogue_, render_settings_, *router_, ofs);
+    DatabaseSerializer::Serialize(*catalogue_, *render_settings_, *router_, ofs);
 }
 
 void JSONReader::DeserializeBase() {
-    using DatabaseSerializer = serialization::database::DatabaseSerializer;
+    using DatabaseReader = serialization::database::DatabaseReader;
     using TransportCatalogue = transport_catalogue::TransportCatalogue;
+
+    stats::ScopedTimer timer("deserialize_base"sv);
+
+    base_stream_ = std::make_unique<std::ifstream>(
+                                serialization_settings_.filename, 
+                                std::ios::binary);
+
+    if (!*base_stream_) {
+        throw std::runtime_error("Failed to open base file "s 
+                                 + serialization_settings_.filename.string());
+    }
+
+    base_reader_ = std::make_unique<DatabaseReader>(*base_stream_);
+
+    catalogue_ = std::make_shared<TransportCatalogue>(
+                                                base_reader_->ReadCatalogue());
+    render_settings_.reset();
+    escaped_map_.reset();
+    map_index_.reset();
+    map_layout_.reset();
+    map_renderer_.reset();
+    router_.reset();
+    raptor_router_.reset();
+}
+
+const transport_router::TransportRouter& JSONReader::GetRouter() const {
     using TransportRouter = transport_router::TransportRouter;
-    using Database = serialization::database::Database;
 
-    std::ifstream ifs(serialization_settings_.filename, std::ios::binary);
+    if (!router_) {
+        router_ = std::make_shared<TransportRouter>(
+                                            *catalogue_, 
+                                            base_reader_->ReadRouterInfo());
 
-    Database db = DatabaseSerializer::Deserialize(ifs);
+        // Without the section the graph is contracted on the first route
+        if (router_->GetRoutingSettings().contraction_hierarchy) {
+            if (auto data = base_reader_->ReadContractionHierarchy()) {
+                router_->LoadContractionHierarchy(*data);
+            }
+        }
+    }
+
+    return *router_;
+}
+
+const transport_router::RaptorRouter& JSONReader::GetRaptorRouter() const {
+    if (!raptor_router_) {
+        // Raptor needs no route graph, so a base gives only the settings
+        raptor_router_ = std::make_unique<transport_router::RaptorRouter>(
+                                        *catalogue_, 
+                                        router_ ? router_->GetRoutingSettings()
+                                                : base_reader_->ReadRoutingSettings());
+    }
 
-    catalogue_ = std::make_shared<TransportCatalogue>(std::move(db.catalogue));
-    render_settings_ = std::move(db.render_settings);
-    router_ = std::make_shared<TransportRouter>(*catalogue_, db.router_info);
+    return *raptor_router_;
 }
 
 std::string JSONReader::ReadJSON(std::istream& in) {
+    stats::ScopedTimer timer("read_json"sv);
+
     std::vector<std::string> lines;
     std::string line;
 
@@ -565,6 +1201,8 @@ std::string JSONReader::ReadJSON(std::istream& in) {
     }
 
     if (brace_count != 0) throw json::ParsingError("Invalid JSON");
+
+    stats::AddCounter("json_bytes_read"sv, result.size());
     return result;
 }
 
@@ -573,7 +1211,11 @@ const json::Document& JSONReader::GetDoc() const {
 }
 
 const renderer::RenderSettings JSONReader::GetRenderSettings() const {
-    return render_settings_;
+    if (!render_settings_) {
+        render_settings_ = base_reader_->ReadRenderSettings();
+    }
+
+    return *render_settings_;
 }
 
 namespace tests {
@@ -844,6 +1486,21 @@ void TestAssembleQuery() {
     assert(test_load);
 }
 
+void TestBase64() {
+    const auto encode = [](std::string_view data) {
+        std::ostringstream out;
+        util::PrintBase64(out, data);
+        return out.str();
+    };
+
+    assert(encode(""sv).empty());
+    assert(encode("f"sv) == "Zg=="s);
+    assert(encode("fo"sv) == "Zm8="s);
+    assert(encode("foo"sv) == "Zm9v"s);
+    assert(encode("foobar"sv) == "Zm9vYmFy"s);
+    assert(encode("\xff\xfe\x00"sv) == "//4A"s);
+}
+
 } // namespace json_reader::tests
 
 } // namespace json_reader
\ No newline at end of file
@@ -1,8 +1,13 @@
 #pragma once
+#include <fstream>
 #include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_set>
 
 #include "transport_catalogue.h"
 #include "transport_router.h"
+#include "raptor.h"
 #include "request_handler.h"
 #include "serialization.h"
 #include "map_renderer.h"
@@ -19,6 +24,9 @@ void PrintLnBusInfo(std::ostream& out, domain::BusInfo bus_info);
 // Prints bus info. Is used for debug purposes only
 void PrintLnStopInfo(std::ostream& out, domain::StopInfo stop_info);
 
+// Prints binary data encoded in base64
+void PrintBase64(std::ostream& out, const std::string_view data);
+
 } // namespace json_reader::utils
 
 class JSONReader final : private handlers::InputHandler, 
@@ -38,6 +46,14 @@ public:
 
     void LoadMakeBaseJSON(const std::string& in);
 
+    /* Applies a delta document to an existing base and rewrites it. Stops and
+     * buses from base_requests are added or replaced, the ones listed in 
+     * removed_requests are removed. Only edges of the affected buses are
+     * recomputed, the rest of the graph is taken from the base */
+    void LoadIncrementalMakeBaseJSON(std::istream& in);
+
+    void LoadIncrementalMakeBaseJSON(const std::string& in);
+
     void LoadRequestsJSON(const std::string& in);
 
     void LoadJSON(const std::string& in);
@@ -50,6 +66,9 @@ public:
 
     void SerializeBase() const;
 
+    /* Opens the base and loads the catalogue section only. Render settings 
+     * and the router are loaded from the base on the first request that 
+     * needs them */
     void DeserializeBase();
 
     const json::Document& GetDoc() const;
@@ -64,24 +83,64 @@ private:
     // Parses the document, collecting queries into respective containers
     void ParseMakeBaseJSON();
 
+    // Collects stop and bus input queries from base_requests
+    void ParseBaseRequests(const json::Array& base_requests);
+
+    // Parses a delta document of the incremental make_base
+    void ParseIncrementalMakeBaseJSON();
+
+    /* Applies parsed delta to the catalogue. Returns names of the buses 
+     * whose edges have to be recomputed */
+    std::unordered_set<std::string_view> ExecuteDeltaQueries();
+
     void ParseRequestsJSON();
 
     // Binary serialization settings
     serialization::SerializationSettings serialization_settings_;
 
-    // Map rendering settings taken from the given JSON
-    renderer::RenderSettings render_settings_;
+    /* Map rendering settings taken from the given JSON or lazily loaded
+     * from the base */
+    mutable std::optional<renderer::RenderSettings> render_settings_;
 
     // Routing settings taken from the given JSON
     transport_router::RoutingSettings routing_settings_;
 
+    /* The map depends on the catalogue and render settings only, so it is 
+     * rendered on the first Map request and reused by the rest of them.
+     * Is kept already escaped as the contents of a JSON string */
+    mutable std::optional<std::string> escaped_map_;
+
+    /* Serve all Map requests and are built on the first one. The layout
+     * holds the projected stops and refers to the palette of the renderer,
+     * the index refers to the layout */
+    mutable std::unique_ptr<renderer::MapRenderer> map_renderer_;
+
+    mutable std::unique_ptr<renderer::MapRenderer::MapLayout> map_layout_;
+
+    mutable std::unique_ptr<renderer::MapIndex> map_index_;
+
     // A reference to the transport database
     std::shared_ptr<transport_catalogue::TransportCatalogue> catalogue_;
 
     // Loaded JSON document
     json::Document json_;
 
-    std::shared_ptr<transport_router::TransportRouter> router_;
+    // Is built at make_base or lazily loaded from the base
+    mutable std::shared_ptr<transport_router::TransportRouter> router_;
+
+    /* Serves Route requests for criteria other than time. Is built on the
+     * first of them */
+    mutable std::unique_ptr<transport_router::RaptorRouter> raptor_router_;
+
+    // Opened base file that sections are read from on demand
+    std::unique_ptr<std::ifstream> base_stream_;
+
+    std::unique_ptr<serialization::database::DatabaseReader> base_reader_;
+
+    // Names of stops and buses removed by the incremental make_base
+    std::vector<std::string_view> removed_stop_names_;
+
+    std::vector<std::string_view> removed_bus_names_;
 
     // A container for the map output queries
     std::deque<domain::MapOutputQuery> map_output_queries_;
@@ -89,6 +148,12 @@ private:
     // A container for the route output queries
     std::deque<domain::RouteOutputQuery> route_output_queries_;
 
+    // A container for the route matrix output queries
+    std::deque<domain::RouteMatrixOutputQuery> route_matrix_output_queries_;
+
+    // A container for the isochrone output queries
+    std::deque<domain::IsochroneOutputQuery> isochrone_output_queries_;
+
     /* A container that houses pointers to output queries, allowing 
      * for the easy iteration and execution in a given order */
     std::deque<const domain::OutputQuery*> query_ptrs_;
@@ -109,6 +174,10 @@ private:
                                        const json::Node& render_settings) const;
     domain::RouteOutputQuery AssembleRouteOutputQuery(
                                             const json::Node& query_node) const;
+    domain::RouteMatrixOutputQuery AssembleRouteMatrixOutputQuery(
+                                            const json::Node& query_node) const;
+    domain::IsochroneOutputQuery AssembleIsochroneOutputQuery(
+                                            const json::Node& query_node) const;
     transport_router::RoutingSettings AssembleRoutingSettings(
                                       const json::Node& routing_settings) const;
     serialization::SerializationSettings AssembleSerializationSettings(
@@ -116,11 +185,44 @@ private:
 
     void InitializeRouter();
 
+    // Returns the router, loading it from the base on the first call
+    const transport_router::TransportRouter& GetRouter() const;
+
+    // Returns the round-based router, building it on the first call
+    const transport_router::RaptorRouter& GetRaptorRouter() const;
+
+    /* Returns the SVG map escaped for a JSON string, rendering it on the
+     * first call straight into the escaping stream */
+    const std::string& GetEscapedMap() const;
+
+    // Prints the response to a single output query
+    void ExecuteOutputQuery(std::ostream& out, 
+                            const domain::OutputQuery& query) const;
+
+    // Id, type and parameters of a query for the slow query log
+    json::Dict AssembleQueryDetails(const domain::OutputQuery& query) const;
+
     /* This set of methods assembles JSON nodes, so that they
      * can be then easily printed out */
-    json::Node AssembleMapNode(int id) const;
 
     json::Node AssembleErrorNode(const int id) const;
+
+    /* Prints a map response without building a JSON node for it. Requests
+     * for a bbox or a tile get only the visible part of the map */
+    void PrintMapNode(std::ostream& out, 
+                      const domain::MapOutputQuery& query) const;
+
+    /* Prints a route matrix response without building a JSON node for it,
+     * a matrix of thousands of pairs would take a node per time */
+    void PrintRouteMatrixNode(std::ostream& out,
+                              const domain::RouteMatrixOutputQuery& query) const;
+
+    // Returns the layout of the map, projecting the stops on the first call
+    const renderer::MapRenderer::MapLayout& GetMapLayout() const;
+
+    // Returns the spatial index of the map, building it on the first call
+    const renderer::MapIndex& GetMapIndex() const;
+
     // Extracts color from a JSON Node
     svg::Color ExtractColor(const json::Node& node) const;
 
@@ -131,6 +233,17 @@ private:
     json::Node AssembleRouteNode(
                   std::optional<transport_router::RoutingResult> routing_result,
                                                                   int id) const;
+
+    // Assembles a response with every journey of a pareto Route request
+    json::Node AssembleRoutesNode(
+                  const std::vector<transport_router::RoutingResult>& routing_results,
+                                                                  int id) const;
+
+    json::Array AssembleRouteItems(
+                  const transport_router::RoutingResult& routing_result) const;
+
+    json::Node AssembleIsochroneNode(
+                  const domain::IsochroneOutputQuery& query) const;
 };
 
 namespace tests {
@@ -139,6 +252,8 @@ void TestJSON();
 
 void TestAssembleQuery();
 
+void TestBase64();
+
 } // namespace json_reader::tests
 
 } // namespace json_reader
\ No newline at end of file
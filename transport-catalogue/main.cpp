@@ -1,12 +1,21 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
+#include "raptor.h"
 #include "request_handler.h"
 #include "serialization.h"
 #include "map_renderer.h"
 #include "json_reader.h"
+#include "memory.h"
+#include "stats.h"
 
+#include <chrono>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 using namespace std;
 
@@ -26,22 +35,31 @@ void RunTests() {
 
         TestDistances();
         cerr << "TestDistances OK!"s << endl;        
+
+        TestRemoveAndUpdate();
+        cerr << "TestRemoveAndUpdate OK!"s << endl;
+
+        TestBulkLoad();
+        cerr << "TestBulkLoad OK!"s << endl;
     }
 
     {
-        /*using namespace json_reader::tests;
+        using namespace json_reader::tests;
 
-        TestAssembleQuery();
+        /*TestAssembleQuery();
         cerr << "TestAssembleQuery OK!"s << endl;
 
         TestJSON();
         cerr << "TestJSON OK!"s << endl;*/
+
+        TestBase64();
+        cerr << "TestBase64 OK!"s << endl;
     }
 
     {
-        /*using namespace transport_router::tests;
+        using namespace transport_router::tests;
 
-        TestBasicRouting();
+        /*TestBasicRouting();
         cerr << "TestBasicRouting OK!"s << endl;
 
         TestComplexRouting();
@@ -49,13 +67,96 @@ void RunTests() {
 
         TestTrickyRouting();
         cerr << "TestTrickyRouting OK!"s << endl;*/
+
+        TestIncrementalGraph();
+        cerr << "TestIncrementalGraph OK!"s << endl;
+
+        TestDynamicRouterUpdates();
+        cerr << "TestDynamicRouterUpdates OK!"s << endl;
+
+        TestRouteMatrix();
+        cerr << "TestRouteMatrix OK!"s << endl;
+
+        TestIsochrone();
+        cerr << "TestIsochrone OK!"s << endl;
+
+        TestContractionHierarchy();
+        cerr << "TestContractionHierarchy OK!"s << endl;
+
+        TestContractionHierarchyRouting();
+        cerr << "TestContractionHierarchyRouting OK!"s << endl;
+
+        TestAStarRouting();
+        cerr << "TestAStarRouting OK!"s << endl;
+
+        TestRaptorRouting();
+        cerr << "TestRaptorRouting OK!"s << endl;
+
+        TestRaptorMatchesRouter();
+        cerr << "TestRaptorMatchesRouter OK!"s << endl;
     }
     
+    {
+        using namespace svg::my_tests;
+
+        TestPolyLineRender();
+        cerr << "TestPolyLineRender OK!"s << endl;
+
+        TestTextRender();
+        cerr << "TestTextRender OK!"s << endl;
+
+        TestStreamingDocument();
+        cerr << "TestStreamingDocument OK!"s << endl;
+
+        TestNumberFormatting();
+        cerr << "TestNumberFormatting OK!"s << endl;
+    }
+
+    {
+        using namespace renderer::tests;
+
+        TestLayeredRender();
+        cerr << "TestLayeredRender OK!"s << endl;
+
+        TestMapIndex();
+        cerr << "TestMapIndex OK!"s << endl;
+
+        TestRouteSimplification();
+        cerr << "TestRouteSimplification OK!"s << endl;
+
+        TestIsochroneRender();
+        cerr << "TestIsochroneRender OK!"s << endl;
+    }
+
     {
         using namespace serialization::database::tests;
 
         TestDatabaseSerialization();
         cerr << "TestDatabaseSerialization OK!"s << endl;
+
+        TestDatabaseSections();
+        cerr << "TestDatabaseSections OK!"s << endl;
+    }
+
+    {
+        using namespace serialization::svg::tests;
+
+        TestMapGeometry();
+        cerr << "TestMapGeometry OK!"s << endl;
+    }
+
+    {
+        using namespace stats::tests;
+
+        TestStats();
+        cerr << "TestStats OK!"s << endl;
+    }
+
+    {
+        using namespace memory::tests;
+
+        TestTrackingAllocator();
+        cerr << "TestTrackingAllocator OK!"s << endl;
     }
 
     cerr << "All tests OK!"s << std::endl;
@@ -64,21 +165,98 @@ void RunTests() {
 using namespace std::literals;
 
 void PrintUsage(std::ostream& stream = std::cerr) {
-    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv;
+    stream << "Usage: transport_catalogue "sv
+           << "[make_base [--incremental]|process_requests] "sv
+           << "[--stats[=FILE]] [--slow-query-ms=MS] [--prometheus=FILE] "sv
+           << "[--memory[=FILE]]\n"sv;
+}
+
+/* Prints a report of the run with the given function to the file, or to 
+ * stderr if there is no file */
+template <typename Print>
+void PrintReport(const std::string& file, Print print) {
+    if (file.empty()) {
+        print(std::cerr);
+        return;
+    }
+
+    std::ofstream out(file);
+    if (!out) {
+        std::cerr << "Failed to open report file "sv << file << '\n';
+        return;
+    }
+    print(out);
+}
+
+// Returns the value of an option like --name=value if the argument is one
+std::optional<std::string_view> GetOptionValue(std::string_view argument,
+                                               std::string_view name) {
+    if (argument.size() <= name.size() + 1
+     || argument.substr(0, name.size()) != name
+     || argument[name.size()] != '=') {
+        return std::nullopt;
+    }
+    return argument.substr(name.size() + 1);
 }
 
 int main(int argc, char* argv[]) {
     //RunTests();
 
-    if (argc != 2) {
+    if (argc < 2) {
         PrintUsage();
         return 1;
     }
 
     const std::string_view mode(argv[1]);
 
+    bool is_incremental = false;
+    std::optional<std::string> stats_file;
+    std::optional<std::string> prometheus_file;
+    std::optional<double> slow_query_ms;
+    std::optional<std::string> memory_file;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string_view option(argv[i]);
+
+        try {
+            if (option == "--incremental"sv && mode == "make_base"sv) {
+                is_incremental = true;
+            } else if (option == "--stats"sv) {
+                stats_file = ""s;
+            } else if (const auto file = GetOptionValue(option, "--stats"sv)) {
+                stats_file = std::string(*file);
+            } else if (option == "--memory"sv) {
+                memory_file = ""s;
+            } else if (const auto file = GetOptionValue(option, "--memory"sv)) {
+                memory_file = std::string(*file);
+            } else if (const auto file = GetOptionValue(option, "--prometheus"sv)) {
+                prometheus_file = std::string(*file);
+            } else if (const auto ms = GetOptionValue(option, "--slow-query-ms"sv)) {
+                slow_query_ms = std::stod(std::string(*ms));
+            } else {
+                throw std::invalid_argument("Unknown option "s + std::string(option));
+            }
+        } catch (const std::exception&) {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (stats_file || prometheus_file) {
+        stats::Enable();
+    }
+    if (slow_query_ms) {
+        stats::EnableSlowQueryLog(
+            std::chrono::duration_cast<stats::Clock::duration>(
+                std::chrono::duration<double, std::milli>(*slow_query_ms)),
+            std::cerr);
+    }
+
     json_reader::JSONReader reader;
-    if (mode == "make_base"sv) {
+    if (mode == "make_base"sv && is_incremental) {
+        reader.LoadIncrementalMakeBaseJSON(
+                                  json_reader::JSONReader::ReadJSON(std::cin));
+    } else if (mode == "make_base"sv) {
         reader.LoadMakeBaseJSON(json_reader::JSONReader::ReadJSON(std::cin));
     } else if (mode == "process_requests"sv) {
         reader.LoadRequestsJSON(json_reader::JSONReader::ReadJSON(std::cin));
@@ -87,4 +265,14 @@ int main(int argc, char* argv[]) {
         PrintUsage();
         return 1;
     }
-}
\ No newline at end of file
+
+    if (stats_file) {
+        PrintReport(*stats_file, stats::Print);
+    }
+    if (prometheus_file) {
+        PrintReport(*prometheus_file, stats::PrintPrometheus);
+    }
+    if (memory_file) {
+        PrintReport(*memory_file, memory::PrintReport);
+    }
+}
@@ -1,7 +1,15 @@
 #include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <deque>
+#include <numeric>
+#include <string>
+#include <sstream>
 
 #include "map_renderer.h"
+#include "parallel.h"
+#include "stats.h"
 #include "svg.h"
 #include "transport_catalogue.h"
 
@@ -34,70 +42,94 @@ SphereProjector MakeSphereProjector(const transport_catalogue::TransportCatalogu
                            renderer.render_settings.padding);
 }
 
-CoordinatesTransformer::CoordinatesTransformer(
-            const transport_catalogue::TransportCatalogue& catalogue, 
-            const MapRenderer& renderer)
-    : projector_(MakeSphereProjector(catalogue, renderer)) {}
+namespace {
 
-// Collects stop points for a given bus
-std::vector<svg::Point> CoordinatesTransformer::TransformRouteCoords(
-            const transport_catalogue::TransportCatalogue& catalogue, 
-            const std::string_view bus_name) const {
-    const domain::Bus& bus = *catalogue.FindBus(bus_name);
+// Distance from the point to the segment [from, to]
+double GetDistanceToSegment(svg::Point point, svg::Point from, svg::Point to) {
+    const double dx = to.x - from.x;
+    const double dy = to.y - from.y;
+    const double length_squared = dx * dx + dy * dy;
 
-    std::vector<svg::Point> points(bus.route.size());
+    double t = 0;
+    if (length_squared > 0) {
+        t = ((point.x - from.x) * dx + (point.y - from.y) * dy) / length_squared;
+        t = std::clamp(t, 0.0, 1.0);
+    }
 
-    std::transform(bus.route.begin(), bus.route.end(), points.begin(),
-        [this, &catalogue](const domain::StopPtr stop_ptr) {
-            return TransformStopCoords(catalogue, stop_ptr->name);
-        });
-
-    return points;
+    return std::hypot(point.x - (from.x + t * dx), point.y - (from.y + t * dy));
 }
 
-// Projects stop geo coordinates onto a plane
-svg::Point CoordinatesTransformer::TransformStopCoords(
-            const transport_catalogue::TransportCatalogue& catalogue, 
-            const std::string_view stop_name) const {
-    const domain::Stop& stop = *catalogue.FindStop(stop_name);
-    return projector_(stop.coordinates);
-}
+} // namespace
+
+std::vector<bool> SimplifyPolyline(const std::vector<svg::Point>& points, 
+                                   double tolerance) {
+    std::vector<bool> is_kept(points.size(), false);
+    if (points.empty()) {
+        return is_kept;
+    }
+
+    is_kept.front() = true;
+    is_kept.back() = true;
+
+    // Ranges [first, last] with both ends kept, which are yet to be split
+    std::vector<std::pair<size_t, size_t>> ranges;
+    if (points.size() > 2) {
+        ranges.push_back({ 0, points.size() - 1 });
+    }
+
+    while (!ranges.empty()) {
+        const auto [first, last] = ranges.back();
+        ranges.pop_back();
+
+        // The point farthest from the segment is kept if it is too far
+        size_t farthest = first;
+        double max_distance = 0;
+        for (size_t i = first + 1; i < last; ++i) {
+            const double distance = GetDistanceToSegment(points[i], points[first], 
+                                                         points[last]);
+            if (distance > max_distance) {
+                farthest = i;
+                max_distance = distance;
+            }
+        }
 
-} // namespace renderer::util
+        if (max_distance <= tolerance) continue;
 
-MapRenderer::MapRenderer(RenderSettings render_settings)
-    : render_settings(render_settings) {}
+        is_kept[farthest] = true;
+        if (farthest - first > 1) ranges.push_back({ first, farthest });
+        if (last - farthest > 1) ranges.push_back({ farthest, last });
+    }
 
-void MapRenderer::DrawRoute(std::string_view bus_name, 
-                            const std::vector<svg::Point>& points) {
-    const svg::Color& line_color = render_settings.color_palette.at(color_counter_ % render_settings.color_palette.size());
-    if (points.empty()) return; 
-    
-    doc_.Add(std::move(GetRouteLine(line_color, points)));
-    bus_names_to_colors_[bus_name] = &line_color;
-    color_counter_++;
+    return is_kept;
 }
 
+} // namespace renderer::util
 
-void MapRenderer::DrawRouteName(const std::string_view bus_name, 
-                                const svg::Point& begin, 
-                                const svg::Point& end) {
-    doc_.Add(GetUnderlayerText(bus_name, begin, BUS));
-    doc_.Add(GetRouteNameText(bus_name, begin));
-    doc_.Add(GetUnderlayerText(bus_name, end, BUS));
-    doc_.Add(GetRouteNameText(bus_name, end));
+MapRenderer::MapRenderer(RenderSettings render_settings)
+    : render_settings(render_settings)
+    , label_font_family_(svg::utils::InternString("Verdana"s))
+    , bus_label_font_weight_(svg::utils::InternString("bold"s)) {}
+
+void MapRenderer::DrawRoute(svg::ObjectContainer& container,
+                            const svg::Color& line_color, 
+                            std::vector<svg::Point>::const_iterator first,
+                            std::vector<svg::Point>::const_iterator last) const {
+    container.Add(GetRouteLine(line_color, first, last));
 }
 
-void MapRenderer::DrawRoundRouteName(const std::string_view bus_name, 
-                                     const svg::Point& begin) {
-    doc_.Add(GetUnderlayerText(bus_name, begin, BUS));
-    doc_.Add(GetRouteNameText(bus_name, begin));
+void MapRenderer::DrawRouteName(svg::ObjectContainer& container,
+                                const std::string_view bus_name, 
+                                const svg::Color& color,
+                                const svg::Point& pos) const {
+    container.Add(GetUnderlayerText(bus_name, pos, BUS));
+    container.Add(GetRouteNameText(bus_name, color, pos));
 }
 
-void MapRenderer::DrawStopName(const std::string_view stop_name, 
-                               const svg::Point& pos) {
-    doc_.Add(GetUnderlayerText(stop_name, pos, STOP));
-    doc_.Add(GetStopNameText(stop_name, pos));
+void MapRenderer::DrawStopName(svg::ObjectContainer& container,
+                               const std::string_view stop_name, 
+                               const svg::Point& pos) const {
+    container.Add(GetUnderlayerText(stop_name, pos, STOP));
+    container.Add(GetStopNameText(stop_name, pos));
 }
 
 svg::Text MapRenderer::GetStopNameText(const std::string_view stop_name,
@@ -105,7 +137,7 @@ svg::Text MapRenderer::GetStopNameText(const std::string_view stop_name,
     svg::Text stop_name_text;
     stop_name_text.SetOffset(render_settings.stop_label_offset)
                   .SetPosition(pos)
-                  .SetFontFamily("Verdana"s)
+                  .SetFontFamily(label_font_family_)
                   .SetData(std::string(stop_name))
                   .SetFillColor("black"s)
                   .SetFontSize(render_settings.stop_label_font_size);
@@ -114,8 +146,9 @@ svg::Text MapRenderer::GetStopNameText(const std::string_view stop_name,
 }
 
 svg::Polyline MapRenderer::GetRouteLine(
-                            const svg::Color& line_color, 
-                            const std::vector<svg::Point>& points) const {
+                    const svg::Color& line_color, 
+                    std::vector<svg::Point>::const_iterator first,
+                    std::vector<svg::Point>::const_iterator last) const {
     svg::Polyline route;
 
     route.SetStrokeColor(line_color)
@@ -124,25 +157,23 @@ svg::Polyline MapRenderer::GetRouteLine(
          .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
          .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 
-    std::for_each(points.begin(), points.end(), 
-        [&route](const svg::Point& point) {
-            route.AddPoint(point);
-        });
+    route.AddPoints(first, last);
 
     return route;
 }
 
 svg::Text MapRenderer::GetRouteNameText(const std::string_view bus_name,
+                                        const svg::Color& color,
                                         const svg::Point& pos) const {
     svg::Text route_name;
 
     route_name.SetData(std::string(bus_name))
               .SetPosition(pos)
               .SetOffset(render_settings.bus_label_offset)
-              .SetFontFamily("Verdana"s)
+              .SetFontFamily(label_font_family_)
               .SetFontSize(render_settings.bus_label_font_size)
-              .SetFontWeight("bold"s)
-              .SetFillColor(*bus_names_to_colors_.at(bus_name));
+              .SetFontWeight(bus_label_font_weight_)
+              .SetFillColor(color);
 
     return route_name;
 }
@@ -163,7 +194,7 @@ svg::Text MapRenderer::GetUnderlayerText(const std::string_view text,
     underlayer_text.SetData(std::string(text))
                    .SetPosition(pos)
                    .SetOffset(offset)
-                   .SetFontFamily("Verdana"s)
+                   .SetFontFamily(label_font_family_)
                    .SetFontSize(label_size)
                    .SetFillColor(render_settings.underlayer_color)
                    .SetStrokeWidth(render_settings.underlayer_width)
@@ -171,7 +202,7 @@ svg::Text MapRenderer::GetUnderlayerText(const std::string_view text,
                    .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
                    .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 
-    if (type == BUS) underlayer_text.SetFontWeight("bold"s);
+    if (type == BUS) underlayer_text.SetFontWeight(bus_label_font_weight_);
 
     return underlayer_text;
 }
@@ -186,81 +217,689 @@ svg::Circle MapRenderer::GetStopCircle(const svg::Point pos) const {
     return stop_circle;
 }
 
-void MapRenderer::DrawStop(const svg::Point& pos) {
-    doc_.Add(GetStopCircle(pos));
+void MapRenderer::DrawStop(svg::ObjectContainer& container,
+                           const svg::Point& pos) const {
+    container.Add(GetStopCircle(pos));
 }
 
-svg::Document MapRenderer::RenderMap(const transport_catalogue::TransportCatalogue& catalogue) {
-    renderer::util::CoordinatesTransformer transformer(catalogue, *this);
-    std::vector<std::string_view> bus_names = catalogue.GetBusNames();
-    std::vector<std::string_view> stop_names = catalogue.GetStopNames();
+MapRenderer::MapLayout MapRenderer::MakeMapLayout(
+            const transport_catalogue::TransportCatalogue& catalogue) const {
+    stats::ScopedTimer timer("map_layout"sv);
+
+    MapLayout layout;
+
+    // Coordinates of all stops by id, one array per component
+    std::vector<double> lats(catalogue.GetStopCount());
+    std::vector<double> lngs(catalogue.GetStopCount());
+
+    // Only stops served by some bus are drawn and affect the projection
+    for (const std::string_view stop_name : catalogue.GetStopNames()) {
+        const domain::StopPtr stop_ptr = catalogue.FindStop(stop_name);
+        lats[stop_ptr->id] = stop_ptr->coordinates.lat;
+        lngs[stop_ptr->id] = stop_ptr->coordinates.lng;
+        if (!stop_ptr->buses.empty()) {
+            layout.stops.push_back(stop_ptr);
+        }
+    }
+
+    const util::SphereProjector projector = util::MakeSphereProjector(catalogue, 
+                                                                      *this);
+
+    // Every stop is projected once, routes and stops refer to these points
+    layout.stop_xs.resize(lats.size());
+    layout.stop_ys.resize(lats.size());
+    parallel::ForEachChunk(lats.size(), [&](size_t begin, size_t end) {
+        projector.Project(lats.data() + begin, lngs.data() + begin, 
+                          layout.stop_xs.data() + begin, 
+                          layout.stop_ys.data() + begin, end - begin);
+    }, 16384);
+
+    const auto get_point = [&layout](const domain::StopPtr stop_ptr) {
+        return svg::Point{ layout.stop_xs[stop_ptr->id], 
+                           layout.stop_ys[stop_ptr->id] };
+    };
+
+    layout.stop_points.reserve(layout.stops.size());
+    for (const domain::StopPtr stop_ptr : layout.stops) {
+        layout.stop_points.push_back(get_point(stop_ptr));
+    }
+
+    for (const std::string_view bus_name : catalogue.GetBusNames()) {
+        layout.buses.push_back(catalogue.FindBus(bus_name));
+    }
+
+    layout.bus_points.resize(layout.buses.size());
+    layout.bus_kept_points.resize(layout.buses.size());
+    parallel::ForEachChunk(layout.buses.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const domain::Route& route = layout.buses[i]->route;
+            std::vector<svg::Point>& points = layout.bus_points[i];
+            points.reserve(route.size());
+            for (const domain::StopPtr stop_ptr : route) {
+                points.push_back(get_point(stop_ptr));
+            }
 
-    std::map<std::string_view, std::vector<svg::Point>> bus_names_to_points;
+            if (render_settings.route_simplification_tolerance > 0) {
+                layout.bus_kept_points[i] = util::SimplifyPolyline(points, 
+                                render_settings.route_simplification_tolerance);
+            }
+        }
+    }, 64);
 
-    // Rendering bus route lines
-    std::for_each(bus_names.begin(), bus_names.end(), 
-        [this, &transformer, &bus_names_to_points, &catalogue](std::string_view bus_name) {
-            std::vector<svg::Point> points = transformer.TransformRouteCoords(catalogue, bus_name);
-            DrawRoute(bus_name, points);
-            bus_names_to_points[bus_name] = std::move(points);
-        });
+    // Palette colors are given out in the order of bus names, skipping empty routes
+    layout.bus_colors.resize(layout.buses.size(), nullptr);
+    size_t color_counter = 0;
+    for (size_t i = 0; i < layout.buses.size(); ++i) {
+        if (layout.bus_points[i].empty()) continue;
 
-    // Rendering bus route names
-    std::for_each(bus_names_to_points.begin(), bus_names_to_points.end(), 
-        [this, &catalogue](const std::pair<std::string_view, std::vector<svg::Point>>& bus_name_to_points) {
-            const auto& [bus_name, points] = bus_name_to_points;
-                
-            const domain::Bus& bus = *catalogue.FindBus(bus_name);
+        const std::vector<svg::Color>& palette = render_settings.color_palette;
+        layout.bus_colors[i] = &palette.at(color_counter++ % palette.size());
+    }
 
-            if (bus.route.empty()) return;
+    return layout;
+}
 
-            if (bus.is_roundtrip) {
-                DrawRoundRouteName(bus_name, points.front());
-            } else {
-                svg::Point midpoint = points.at(points.size() / 2);
+MapRenderer::PointRange MapRenderer::GetRouteRunPoints(
+                const MapLayout& layout, const MapSelection::RouteRun& run,
+                std::vector<svg::Point>& buffer) {
+    const std::vector<svg::Point>& points = layout.bus_points[run.bus_index];
+    const std::vector<bool>& is_kept = layout.bus_kept_points[run.bus_index];
 
-                if (midpoint == points.front()) {
-                    DrawRoundRouteName(bus_name, points.front());
-                } else {
-                    DrawRouteName(bus_name, points.front(), midpoint);
-                }
-            }
-        });
+    if (is_kept.empty()) {
+        return { points.begin() + run.begin, points.begin() + run.end };
+    }
 
-    // Rendering stop circles
-    std::for_each(stop_names.begin(), stop_names.end(), 
-        [this, &transformer, &catalogue](const std::string_view& stop_name) {
-            const domain::Stop& stop = *catalogue.FindStop(stop_name);
+    buffer.clear();
+    for (size_t i = run.begin; i < run.end; ++i) {
+        if (is_kept[i] || i == run.begin || i + 1 == run.end) {
+            buffer.push_back(points[i]);
+        }
+    }
 
-            if (stop.buses.empty()) return;
+    return { buffer.cbegin(), buffer.cend() };
+}
 
-            svg::Point pos = transformer.TransformStopCoords(catalogue, stop_name);
+MapRenderer::MapSelection MapRenderer::SelectWholeMap(const MapLayout& layout) {
+    MapSelection selection;
 
-            DrawStop(pos);
-        });
+    for (size_t i = 0; i < layout.buses.size(); ++i) {
+        if (layout.bus_points[i].empty()) continue;
 
-    // Rendering stop names
-    std::for_each(stop_names.begin(), stop_names.end(),
-        [this, &transformer, &catalogue](const std::string_view& stop_name) {
-            const domain::Stop& stop = *catalogue.FindStop(stop_name);
+        selection.route_runs.push_back({ i, 0, layout.bus_points[i].size() });
+    }
 
-            if (stop.buses.empty()) return;
+    for (size_t i = 0; i < layout.buses.size(); ++i) {
+        for (const size_t point : GetRouteLabelPoints(layout, i)) {
+            selection.route_labels.push_back({ i, point });
+        }
+    }
 
-            svg::Point pos = transformer.TransformStopCoords(catalogue, stop_name);
+    selection.stops.resize(layout.stops.size());
+    std::iota(selection.stops.begin(), selection.stops.end(), 0);
 
-            DrawStopName(stop_name, pos);
-        });
+    return selection;
+}
+
+std::vector<size_t> MapRenderer::GetRouteLabelPoints(const MapLayout& layout, 
+                                                     size_t bus_index) {
+    const std::vector<svg::Point>& points = layout.bus_points[bus_index];
+
+    if (points.empty()) return {};
+
+    if (layout.buses[bus_index]->is_roundtrip) return { 0 };
+
+    const size_t midpoint = points.size() / 2;
+
+    // A route that turns back where it started is labeled once
+    if (points[midpoint] == points.front()) return { 0 };
+
+    return { 0, midpoint };
+}
+
+void MapRenderer::DrawLayer(svg::ObjectContainer& container, 
+                            const MapLayout& layout, 
+                            const MapSelection& selection,
+                            MapLayer layer) const {
+    switch (layer) {
+    case MapLayer::ROUTE_LINES: {
+        std::vector<svg::Point> buffer;
+        for (const MapSelection::RouteRun& run : selection.route_runs) {
+            const auto [first, last] = GetRouteRunPoints(layout, run, buffer);
+
+            DrawRoute(container, *layout.bus_colors[run.bus_index], 
+                      first, last);
+        }
+        break;
+    }
+
+    case MapLayer::ROUTE_NAMES:
+        for (const auto& [bus_index, point] : selection.route_labels) {
+            DrawRouteName(container, layout.buses[bus_index]->name, 
+                          *layout.bus_colors[bus_index],
+                          layout.bus_points[bus_index][point]);
+        }
+        break;
+
+    case MapLayer::STOP_CIRCLES:
+        for (const size_t stop : selection.stops) {
+            DrawStop(container, layout.stop_points[stop]);
+        }
+        break;
+
+    case MapLayer::STOP_NAMES:
+        for (const size_t stop : selection.stops) {
+            DrawStopName(container, layout.stops[stop]->name, 
+                         layout.stop_points[stop]);
+        }
+        break;
+    }
+}
+
+const svg::Document& MapRenderer::RenderMap(const transport_catalogue::TransportCatalogue& catalogue) {
+    RenderMap(catalogue, doc_);
 
     return doc_;
+}
+
+void MapRenderer::RenderMap(const transport_catalogue::TransportCatalogue& catalogue,
+                            svg::ObjectContainer& container) const {
+    const MapLayout layout = MakeMapLayout(catalogue);
+    const MapSelection selection = SelectWholeMap(layout);
+
+    for (const MapLayer layer : MAP_LAYERS) {
+        DrawLayer(container, layout, selection, layer);
+    }
+}
+
+void MapRenderer::RenderMap(const transport_catalogue::TransportCatalogue& catalogue,
+                            std::ostream& out) const {
+    const MapLayout layout = MakeMapLayout(catalogue);
 
+    RenderMap(layout, SelectWholeMap(layout), out);
+}
+
+void MapRenderer::RenderIsochrone(
+                    const MapLayout& layout,
+                    const std::vector<std::pair<size_t, double>>& stop_times,
+                    double max_time, std::ostream& out) const {
+    // Halos are wider than stop circles, so the stops stay visible
+    constexpr double HALO_RADIUS_FACTOR = 3;
+
+    const std::vector<svg::Color>& palette = render_settings.color_palette;
+
+    // The latest stops are drawn first, so the sooner ones end up on top
+    std::vector<std::pair<size_t, double>> sorted_times = stop_times;
+    std::stable_sort(sorted_times.begin(), sorted_times.end(), 
+                     [](const auto& lhs, const auto& rhs) {
+                         return lhs.second > rhs.second;
+                     });
+
+    svg::StreamingDocument document(out, std::nullopt, 
+                                    render_settings.coordinate_precision);
+
+    for (const auto& [stop_id, time] : sorted_times) {
+        svg::Color color = render_settings.underlayer_color;
+        if (!palette.empty()) {
+            const double share = max_time > 0 ? time / max_time : 0;
+            const size_t band = static_cast<size_t>(share * palette.size());
+            color = palette[std::min(band, palette.size() - 1)];
+        }
+
+        document.Add(svg::Circle()
+                        .SetCenter({ layout.stop_xs[stop_id], layout.stop_ys[stop_id] })
+                        .SetRadius(render_settings.stop_radius * HALO_RADIUS_FACTOR)
+                        .SetFillColor(color));
+    }
+
+    document.Finish();
+}
+
+void MapRenderer::RenderMap(const MapLayout& layout, 
+                            const MapSelection& selection,
+                            std::ostream& out, 
+                            std::optional<svg::ViewBox> view_box) const {
+    stats::ScopedTimer timer("render_map"sv);
+
+    // Each layer is rendered into a buffer of its own
+    std::vector<std::ostringstream> buffers(MAP_LAYERS.size());
+    parallel::ForEachChunk(MAP_LAYERS.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            svg::ShapeWriter writer(buffers[i], 
+                                    render_settings.coordinate_precision);
+            DrawLayer(writer, layout, selection, MAP_LAYERS[i]);
+        }
+    }, 1);
+
+    svg::StreamingDocument document(out, view_box, 
+                                    render_settings.coordinate_precision);
+    for (const std::ostringstream& buffer : buffers) {
+        const std::string rendered = buffer.str();
+        stats::AddCounter("map_bytes_written"sv, rendered.size());
+        document.AddRendered(rendered);
+    }
+    document.Finish();
 }
 
 svg::Document MapRenderer::GetDoc() const {
     return doc_;
 }
 
+namespace {
+
+bool Contains(const domain::MapViewport& viewport, const svg::Point& point) {
+    return viewport.min_x <= point.x && point.x <= viewport.max_x
+        && viewport.min_y <= point.y && point.y <= viewport.max_y;
+}
+
+// Liang-Barsky clipping: whether any part of the segment is inside
+bool Crosses(const domain::MapViewport& viewport, 
+             const svg::Point& from, const svg::Point& to) {
+    double t_enter = 0.0;
+    double t_leave = 1.0;
+
+    auto clip = [&t_enter, &t_leave](double p, double q) {
+        if (p == 0.0) return q >= 0.0;
+
+        const double t = q / p;
+        if (p < 0.0) {
+            if (t > t_leave) return false;
+            t_enter = std::max(t_enter, t);
+        } else {
+            if (t < t_enter) return false;
+            t_leave = std::min(t_leave, t);
+        }
+        return true;
+    };
+
+    const double dx = to.x - from.x;
+    const double dy = to.y - from.y;
+
+    return clip(-dx, from.x - viewport.min_x) 
+        && clip( dx, viewport.max_x - from.x)
+        && clip(-dy, from.y - viewport.min_y) 
+        && clip( dy, viewport.max_y - from.y);
+}
+
+} // namespace
+
+MapIndex::MapIndex(const MapRenderer::MapLayout& layout)
+    : layout_(layout) {
+    const std::vector<svg::Point>& stop_points = layout_.stop_points;
+
+    if (stop_points.empty()) {
+        cells_.resize(1);
+        return;
+    }
+
+    bounds_ = { stop_points.front().x, stop_points.front().y,
+                stop_points.front().x, stop_points.front().y };
+    for (const svg::Point& point : stop_points) {
+        bounds_.min_x = std::min(bounds_.min_x, point.x);
+        bounds_.min_y = std::min(bounds_.min_y, point.y);
+        bounds_.max_x = std::max(bounds_.max_x, point.x);
+        bounds_.max_y = std::max(bounds_.max_y, point.y);
+    }
+
+    // About one stop per cell, with the grid size capped
+    constexpr size_t MAX_CELLS_PER_SIDE = 1024;
+    const size_t side = std::clamp<size_t>(
+                static_cast<size_t>(std::sqrt(stop_points.size())), 
+                1, MAX_CELLS_PER_SIDE);
+
+    columns_ = side;
+    rows_ = side;
+    cell_width_  = std::max((bounds_.max_x - bounds_.min_x) / columns_, util::EPSILON);
+    cell_height_ = std::max((bounds_.max_y - bounds_.min_y) / rows_, util::EPSILON);
+    cells_.resize(columns_ * rows_);
+
+    for (size_t i = 0; i < stop_points.size(); ++i) {
+        const auto [column, last_column] = GetCellRange(
+                stop_points[i].x, stop_points[i].x, bounds_.min_x, cell_width_, columns_);
+        const auto [row, last_row] = GetCellRange(
+                stop_points[i].y, stop_points[i].y, bounds_.min_y, cell_height_, rows_);
+        cells_[row * columns_ + column].stops.push_back(i);
+    }
+
+    // A segment goes to every cell its bounding box overlaps
+    for (size_t bus = 0; bus < layout_.bus_points.size(); ++bus) {
+        const std::vector<svg::Point>& points = layout_.bus_points[bus];
+
+        for (size_t i = 0; i + 1 < points.size(); ++i) {
+            const auto [first_column, last_column] = GetCellRange(
+                    std::min(points[i].x, points[i + 1].x), 
+                    std::max(points[i].x, points[i + 1].x),
+                    bounds_.min_x, cell_width_, columns_);
+            const auto [first_row, last_row] = GetCellRange(
+                    std::min(points[i].y, points[i + 1].y), 
+                    std::max(points[i].y, points[i + 1].y),
+                    bounds_.min_y, cell_height_, rows_);
+
+            for (size_t row = first_row; row <= last_row; ++row) {
+                for (size_t column = first_column; column <= last_column; ++column) {
+                    cells_[row * columns_ + column].segments.push_back({ bus, i });
+                }
+            }
+        }
+    }
+}
+
+const MapRenderer::MapLayout& MapIndex::GetLayout() const {
+    return layout_;
+}
+
+std::pair<size_t, size_t> MapIndex::GetCellRange(double min, double max, 
+                                                  double origin, double cell_size,
+                                                  size_t cell_count) const {
+    auto to_cell = [origin, cell_size, cell_count](double coordinate) {
+        const double cell = std::floor((coordinate - origin) / cell_size);
+        return static_cast<size_t>(
+                std::clamp(cell, 0.0, static_cast<double>(cell_count - 1)));
+    };
+
+    return { to_cell(min), to_cell(max) };
+}
+
+MapRenderer::MapSelection MapIndex::Select(const domain::MapViewport& viewport) const {
+    MapRenderer::MapSelection selection;
+
+    const bool overlaps_grid = !layout_.stop_points.empty()
+                            && viewport.min_x <= bounds_.max_x 
+                            && bounds_.min_x <= viewport.max_x
+                            && viewport.min_y <= bounds_.max_y 
+                            && bounds_.min_y <= viewport.max_y;
+
+    std::vector<Segment> segments;
+
+    if (overlaps_grid) {
+        const auto [first_column, last_column] = GetCellRange(
+                viewport.min_x, viewport.max_x, bounds_.min_x, cell_width_, columns_);
+        const auto [first_row, last_row] = GetCellRange(
+                viewport.min_y, viewport.max_y, bounds_.min_y, cell_height_, rows_);
+
+        for (size_t row = first_row; row <= last_row; ++row) {
+            for (size_t column = first_column; column <= last_column; ++column) {
+                const Cell& cell = cells_[row * columns_ + column];
+
+                for (const size_t stop : cell.stops) {
+                    if (Contains(viewport, layout_.stop_points[stop])) {
+                        selection.stops.push_back(stop);
+                    }
+                }
+
+                for (const Segment& segment : cell.segments) {
+                    const auto& points = layout_.bus_points[segment.bus_index];
+                    if (Crosses(viewport, points[segment.point_index], 
+                                          points[segment.point_index + 1])) {
+                        segments.push_back(segment);
+                    }
+                }
+            }
+        }
+    }
+
+    std::sort(selection.stops.begin(), selection.stops.end());
+
+    // A segment may be found in several cells
+    std::sort(segments.begin(), segments.end());
+    segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+
+    size_t segment_pos = 0;
+    for (size_t bus = 0; bus < layout_.buses.size(); ++bus) {
+        const std::vector<svg::Point>& points = layout_.bus_points[bus];
+
+        // A route of a single stop has no segments, only a point
+        if (points.size() == 1 && Contains(viewport, points.front())) {
+            selection.route_runs.push_back({ bus, 0, 1 });
+        }
+
+        // Consecutive visible segments are joined into a single line
+        for (; segment_pos < segments.size() 
+               && segments[segment_pos].bus_index == bus; ++segment_pos) {
+            const size_t point = segments[segment_pos].point_index;
+            auto& runs = selection.route_runs;
+
+            if (!runs.empty() && runs.back().bus_index == bus 
+                              && runs.back().end == point + 1) {
+                runs.back().end = point + 2;
+            } else {
+                runs.push_back({ bus, point, point + 2 });
+            }
+        }
+
+        for (const size_t point : MapRenderer::GetRouteLabelPoints(layout_, bus)) {
+            if (Contains(viewport, points[point])) {
+                selection.route_labels.push_back({ bus, point });
+            }
+        }
+    }
+
+    return selection;
+}
+
+domain::MapViewport TileToViewport(const domain::MapTile& tile, 
+                                   const RenderSettings& settings) {
+    const double tiles_per_side = static_cast<double>(1LL << tile.z);
+    const double tile_width  = settings.width / tiles_per_side;
+    const double tile_height = settings.height / tiles_per_side;
+
+    return { tile.x * tile_width,        tile.y * tile_height,
+             (tile.x + 1) * tile_width,  (tile.y + 1) * tile_height };
+}
+
 namespace tests {
 
+RenderSettings MakeTestRenderSettings() {
+    RenderSettings rs;
+    rs.width = 600;
+    rs.height = 400;
+    rs.padding = 50;
+    rs.stop_radius = 5;
+    rs.line_width = 14;
+    rs.bus_label_font_size = 20;
+    rs.bus_label_offset = svg::Point{ 7, 15 };
+    rs.stop_label_font_size = 20;
+    rs.stop_label_offset = svg::Point{ 7, -3 };
+    rs.underlayer_color = svg::Rgba{ 255, 255, 255, 0.85 };
+    rs.underlayer_width = 3;
+    rs.color_palette = std::vector<svg::Color>{ "green", svg::Rgb{ 255, 160, 0 } };
+
+    return rs;
+}
+
+void TestLayeredRender() {
+    transport_catalogue::TransportCatalogue tc;
+
+    tc.AddStop("Marushkino"sv, { 55.595884, 37.209755 });
+    tc.AddStop("Tolstopaltsevo"sv, { 55.611087, 37.208290 });
+    tc.AddStop("Biryusinka"sv, { 55.581065, 37.648390 });
+    tc.AddStop("Rasskazovka"sv, { 55.632761, 37.333324 });
+    tc.AddStop("Lonely"sv, { 55.0, 37.0 });
+
+    tc.AddBus("11"sv, { "Marushkino"sv, "Tolstopaltsevo"sv, "Marushkino"sv });
+    tc.AddBus("256"sv, { "Biryusinka"sv, "Rasskazovka"sv, "Biryusinka"sv });
+    tc.AddBus("47"sv, { "Rasskazovka"sv, "Marushkino"sv, "Rasskazovka"sv }, true);
+    tc.AddBus("empty"sv, {});
+
+    const RenderSettings rs = MakeTestRenderSettings();
+
+    // Layers rendered into separate buffers make the same document
+    MapRenderer stored_renderer(rs);
+    std::ostringstream stored;
+    stored_renderer.RenderMap(tc).Render(stored);
+
+    std::ostringstream layered;
+    MapRenderer(rs).RenderMap(tc, layered);
+
+    bool test_layered = stored.str() == layered.str();
+    assert(test_layered);
+
+    // The unused stop is neither drawn nor taken into the projection
+    bool test_unused_stop = layered.str().find("Lonely"s) == std::string::npos;
+    assert(test_unused_stop);
+}
+
+void TestMapIndex() {
+    using MapSelection = MapRenderer::MapSelection;
+
+    // A deterministic scatter of stops and routes
+    uint32_t seed = 7;
+    auto next = [&seed](uint32_t bound) {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 16) % bound;
+    };
+
+    constexpr uint32_t STOP_COUNT = 300;
+
+    transport_catalogue::TransportCatalogue tc;
+    std::deque<std::string> names;
+    for (uint32_t i = 0; i < STOP_COUNT; ++i) {
+        names.push_back("Stop "s + std::to_string(i));
+        tc.AddStop(names.back(), { 55.0 + next(1000) * 1e-3, 
+                                   37.0 + next(1000) * 1e-3 });
+    }
+    for (int i = 0; i < 30; ++i) {
+        std::vector<std::string_view> route;
+        for (uint32_t j = 0, length = 1 + next(12); j < length; ++j) {
+            route.push_back(names[next(STOP_COUNT)]);
+        }
+        names.push_back("Bus "s + std::to_string(i));
+        tc.AddBus(names.back(), route, next(2) == 0);
+    }
+
+    const MapRenderer renderer(MakeTestRenderSettings());
+    const MapRenderer::MapLayout layout = renderer.MakeMapLayout(tc);
+    const MapIndex index(layout);
+    assert(&index.GetLayout() == &layout);
+
+    // The whole plane selects the whole map
+    {
+        const MapSelection whole = MapRenderer::SelectWholeMap(layout);
+        const MapSelection selected = index.Select({ -1e9, -1e9, 1e9, 1e9 });
+
+        assert(selected.stops == whole.stops);
+        assert(selected.route_labels == whole.route_labels);
+        assert(selected.route_runs.size() == whole.route_runs.size());
+        for (size_t i = 0; i < whole.route_runs.size(); ++i) {
+            assert(selected.route_runs[i].bus_index == whole.route_runs[i].bus_index);
+            assert(selected.route_runs[i].begin == whole.route_runs[i].begin);
+            assert(selected.route_runs[i].end == whole.route_runs[i].end);
+        }
+    }
+
+    // Every tile gets exactly the stops a full scan finds
+    constexpr int ZOOM = 2;
+    size_t total_stops = 0;
+    for (int x = 0; x < (1 << ZOOM); ++x) {
+        for (int y = 0; y < (1 << ZOOM); ++y) {
+            const domain::MapViewport viewport = TileToViewport(
+                                    { ZOOM, x, y }, renderer.render_settings);
+            const MapSelection selected = index.Select(viewport);
+
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < layout.stop_points.size(); ++i) {
+                const svg::Point& p = layout.stop_points[i];
+                if (viewport.min_x <= p.x && p.x <= viewport.max_x 
+                 && viewport.min_y <= p.y && p.y <= viewport.max_y) {
+                    expected.push_back(i);
+                }
+            }
+            assert(selected.stops == expected);
+            total_stops += expected.size();
+
+            // Runs are valid pieces of routes
+            for (const MapSelection::RouteRun& run : selected.route_runs) {
+                assert(run.begin < run.end);
+                assert(run.end <= layout.bus_points[run.bus_index].size());
+            }
+        }
+    }
+    assert(total_stops >= layout.stops.size());
+}
+
+void TestRouteSimplification() {
+    // Small bumps are dropped, the turn is kept
+    const std::vector<svg::Point> points{ 
+        { 0, 0 }, { 10, 0.5 }, { 20, -0.5 }, { 30, 0 }, { 30, 10 }, { 30, 20 } 
+    };
+    bool test_bumps = util::SimplifyPolyline(points, 1) 
+                   == std::vector<bool>{ true, false, false, true, false, true };
+    assert(test_bumps);
+
+    // Without tolerance only points lying on the line are dropped
+    bool test_exact = util::SimplifyPolyline(points, 0)
+                   == std::vector<bool>{ true, true, true, true, false, true };
+    assert(test_exact);
+
+    assert(util::SimplifyPolyline({}, 1).empty());
+    assert(util::SimplifyPolyline({ { 1, 1 } }, 1) == std::vector<bool>{ true });
+
+    transport_catalogue::TransportCatalogue tc;
+
+    tc.AddStop("A"sv, { 55.0, 37.0 });
+    tc.AddStop("B"sv, { 55.0001, 37.1 });
+    tc.AddStop("C"sv, { 55.0, 37.2 });
+    tc.AddStop("D"sv, { 55.0001, 37.3 });
+    tc.AddStop("E"sv, { 55.0, 37.4 });
+
+    tc.AddBus("1"sv, { "A"sv, "B"sv, "C"sv, "D"sv, "E"sv }, true);
+
+    RenderSettings rs = MakeTestRenderSettings();
+    rs.route_simplification_tolerance = 5;
+
+    std::ostringstream out;
+    MapRenderer(rs).RenderMap(tc, out);
+    const std::string svg = out.str();
+
+    // The line goes straight from the first stop to the last one
+    const size_t points_begin = svg.find("points=\""s) + 8;
+    const std::string line_points = svg.substr(points_begin, 
+                                       svg.find('"', points_begin) - points_begin);
+    bool test_line = std::count(line_points.begin(), line_points.end(), ' ') == 1;
+    assert(test_line);
+
+    // Every stop is still drawn
+    size_t circles = 0;
+    for (size_t pos = svg.find("<circle"s); pos != std::string::npos; 
+                pos = svg.find("<circle"s, pos + 1)) {
+        ++circles;
+    }
+    assert(circles == 5);
+}
+
+void TestIsochroneRender() {
+    transport_catalogue::TransportCatalogue tc;
+
+    tc.AddStop("Marushkino"sv, { 55.595884, 37.209755 });
+    tc.AddStop("Tolstopaltsevo"sv, { 55.611087, 37.208290 });
+    tc.AddStop("Rasskazovka"sv, { 55.632761, 37.333324 });
+
+    tc.AddBus("11"sv, { "Marushkino"sv, "Tolstopaltsevo"sv, 
+                        "Rasskazovka"sv, "Marushkino"sv }, true);
+
+    const MapRenderer renderer(MakeTestRenderSettings());
+    const MapRenderer::MapLayout layout = renderer.MakeMapLayout(tc);
+
+    const size_t marushkino = tc.FindStop("Marushkino"sv)->id;
+    const size_t rasskazovka = tc.FindStop("Rasskazovka"sv)->id;
+
+    std::ostringstream out;
+    renderer.RenderIsochrone(layout, { { marushkino, 0 }, { rasskazovka, 9 } }, 
+                             10, out);
+    const std::string svg = out.str();
+
+    // The later stop is in the second band and is drawn first
+    const size_t late_pos = svg.find("fill=\"rgb(255,160,0)\""s);
+    const size_t soon_pos = svg.find("fill=\"green\""s);
+    assert(late_pos != std::string::npos && soon_pos != std::string::npos);
+    assert(late_pos < soon_pos);
+
+    // Halos are centered where the map draws the stops
+    std::ostringstream center;
+    center << "cx=\""s << layout.stop_xs[marushkino] << "\""s;
+    assert(svg.find(center.str()) != std::string::npos);
+    assert(svg.find("</svg>"s) != std::string::npos);
+}
+
 } // namespace renderer::tests
 
 } // namespace renderer
\ No newline at end of file
@@ -1,8 +1,12 @@
 #pragma once
 #include <algorithm>
+#include <array>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
 
 #include "domain.h"
 #include "geo.h"
@@ -81,6 +85,17 @@ public:
         };
     }
 
+    /* Projects count points given as separate arrays of latitudes and 
+     * longitudes. Same as operator() point by point, but the loop has 
+     * no dependencies between iterations and gets vectorized */
+    void Project(const double* lats, const double* lngs, 
+                 double* xs, double* ys, size_t count) const {
+        for (size_t i = 0; i < count; ++i) {
+            xs[i] = (lngs[i] - min_lon_) * zoom_coeff_ + padding_;
+            ys[i] = (max_lat_ - lats[i]) * zoom_coeff_ + padding_;
+        }
+    }
+
 private:
 
     double padding_;
@@ -93,30 +108,13 @@ private:
 
 };
 
-SphereProjector MakeSphereConstructor(const transport_catalogue::TransportCatalogue& catalogue, const MapRenderer& renderer);
-
-class CoordinatesTransformer {
-public:
-
-    CoordinatesTransformer(
-            const transport_catalogue::TransportCatalogue& catalogue, 
-            const MapRenderer& renderer);
-
-    // Returns a vector of coordinates for stops in a bus route
-    std::vector<svg::Point> TransformRouteCoords(
-            const transport_catalogue::TransportCatalogue& catalogue, 
-            const std::string_view bus_name) const;
-
-    // Returns a svg::Point-projected coordinate of a given stop
-    svg::Point TransformStopCoords(
-            const transport_catalogue::TransportCatalogue& catalogue, 
-            const std::string_view stop_name) const; 
+SphereProjector MakeSphereProjector(const transport_catalogue::TransportCatalogue& catalogue, const MapRenderer& renderer);
 
-private:
-
-    SphereProjector projector_;
-
-};
+/* Simplifies a polyline with the Douglas-Peucker algorithm: returns which 
+ * points are kept so that the line deviates from the dropped ones by at 
+ * most tolerance. The first and the last points are always kept */
+std::vector<bool> SimplifyPolyline(const std::vector<svg::Point>& points, 
+                                   double tolerance);
 
 } // namespace renderer::util
 
@@ -154,6 +152,17 @@ struct RenderSettings {
     // Color palette used to color route lines
     std::vector<svg::Color> color_palette;
 
+    /* Route lines may deviate from the stops by this distance to be drawn
+     * with fewer points. Stops themselves are drawn exactly. 0 keeps all */
+    double route_simplification_tolerance = 0;
+
+    /* Digits after the point in coordinates and sizes of the svg. Without
+     * it numbers are printed the way a default stream prints them */
+    std::optional<int> coordinate_precision;
+
+    // More digits than a double holds make no difference
+    static constexpr int MAX_COORDINATE_PRECISION = 17;
+
 };
 
 class MapRenderer {
@@ -167,45 +176,140 @@ public:
 
     MapRenderer(RenderSettings render_settings); 
 
-    svg::Document RenderMap(const transport_catalogue
-                                ::TransportCatalogue& catalogue);
+    // Renders the map into the document and returns it
+    const svg::Document& RenderMap(const transport_catalogue
+                                       ::TransportCatalogue& catalogue);
 
-    svg::Document GetDoc() const;
+    /* Renders the map into any container, e.g. a streaming one, which 
+     * writes shapes out as soon as they are drawn */
+    void RenderMap(const transport_catalogue::TransportCatalogue& catalogue,
+                   svg::ObjectContainer& container) const;
 
-private:
+    /* Renders the whole svg-document into the stream. Layers are rendered
+     * concurrently into buffers of their own and written out in z-order */
+    void RenderMap(const transport_catalogue::TransportCatalogue& catalogue,
+                   std::ostream& out) const;
 
-    enum UnderlayerTextType {
-        STOP, BUS
+    svg::Document GetDoc() const;
+
+    /* Everything the layers are drawn from. Is computed once per map and 
+     * then only read, so layers can be drawn in parallel. Colors point 
+     * into the palette of the renderer that made the layout */
+    struct MapLayout {
+        // Buses in the order of their names with projected routes and colors
+        std::vector<domain::BusPtr> buses;
+        std::vector<std::vector<svg::Point>> bus_points;
+        std::vector<const svg::Color*> bus_colors;
+
+        // Route points kept by the simplification. Empty when all are kept
+        std::vector<std::vector<bool>> bus_kept_points;
+
+        // Stops served by buses in the order of their names and their points
+        std::vector<domain::StopPtr> stops;
+        std::vector<svg::Point> stop_points;
+
+        /* Projected coordinates of every stop of the catalogue indexed by 
+         * stop id. Each stop is projected once, routes and stops read 
+         * their points from here */
+        std::vector<double> stop_xs;
+        std::vector<double> stop_ys;
     };
 
-    // Is used to match the colors of routes with colors of their labels
-    std::unordered_map<std::string_view, const svg::Color*> bus_names_to_colors_; 
+    // Parts of a layout that get drawn
+    struct MapSelection {
+        // Points [begin, end) of a bus route that are drawn as one line
+        struct RouteRun {
+            size_t bus_index;
+            size_t begin;
+            size_t end;
+        };
 
-    svg::Document doc_;
+        std::vector<RouteRun> route_runs;
 
-    // Is used to cycle through the colors given in color_palette render setting
-    int color_counter_ = 0;
+        // Route labels given as a bus index and an index of the labeled point
+        std::vector<std::pair<size_t, size_t>> route_labels;
 
-    // Draws the route line and adds it to the document
-    void DrawRoute(const std::string_view bus_name, 
-                   const std::vector<svg::Point>& points);
+        // Indexes of drawn stops in ascending order
+        std::vector<size_t> stops;
+    };
+
+    MapLayout MakeMapLayout(
+            const transport_catalogue::TransportCatalogue& catalogue) const;
+
+    using PointRange = std::pair<std::vector<svg::Point>::const_iterator,
+                                 std::vector<svg::Point>::const_iterator>;
+
+    /* Returns the points of the route run that make its line: the ends of
+     * the run and the points in between kept by the simplification. When
+     * nothing is dropped the range points into the layout, otherwise the
+     * kept points are collected into the buffer and the range points there */
+    static PointRange GetRouteRunPoints(const MapLayout& layout, 
+                                        const MapSelection::RouteRun& run,
+                                        std::vector<svg::Point>& buffer);
+
+    // Selects everything, which makes the whole map
+    static MapSelection SelectWholeMap(const MapLayout& layout);
+
+    /* Returns indexes of the route points that get a label: the first one
+     * and, unless the route is round, the last stop before turning back */
+    static std::vector<size_t> GetRouteLabelPoints(const MapLayout& layout, 
+                                                   size_t bus_index);
+
+    /* Renders the selected part of the layout as an svg-document into the
+     * stream, layers concurrently as above */
+    void RenderMap(const MapLayout& layout, const MapSelection& selection,
+                   std::ostream& out, 
+                   std::optional<svg::ViewBox> view_box = std::nullopt) const;
+
+    /* Renders an svg-document to be laid over the map of the layout: a halo
+     * around every reached stop, given by its id and arrival time. Colors of
+     * the palette split [0, max_time] into equal bands, the sooner a stop is
+     * reached the closer to the start of the palette its color is */
+    void RenderIsochrone(const MapLayout& layout,
+                         const std::vector<std::pair<size_t, double>>& stop_times,
+                         double max_time, std::ostream& out) const;
+
+private:
+
+    enum UnderlayerTextType {
+        STOP, BUS
+    };
 
-    // Draws the route label and adds it to the document
-    void DrawRouteName(const std::string_view bus_name, 
-                       const svg::Point& begin, 
-                       const svg::Point& end);
+    // Layers of the map from the bottom to the top
+    enum class MapLayer {
+        ROUTE_LINES, ROUTE_NAMES, STOP_CIRCLES, STOP_NAMES
+    };
 
-    /* Draws the round route label and adds it to the document.
-     * Round route label is only displayed once */
-    void DrawRoundRouteName(const std::string_view bus_name, 
-                            const svg::Point& begin);
+    static constexpr std::array<MapLayer, 4> MAP_LAYERS {
+        MapLayer::ROUTE_LINES, MapLayer::ROUTE_NAMES,
+        MapLayer::STOP_CIRCLES, MapLayer::STOP_NAMES
+    };
 
-    // Draws a stop circle and adds it to the document
-    void DrawStop(const svg::Point& pos);
+    svg::Document doc_;
 
-    // Draws stop label and adds it to the document
-    void DrawStopName(const std::string_view stop_name, 
-                      const svg::Point& pos);
+    // Draws one layer of the selected part of the map into the container
+    void DrawLayer(svg::ObjectContainer& container, const MapLayout& layout, 
+                   const MapSelection& selection, MapLayer layer) const;
+
+    // Draws the route line through points [first, last) and adds it to the container
+    void DrawRoute(svg::ObjectContainer& container,
+                   const svg::Color& line_color, 
+                   std::vector<svg::Point>::const_iterator first,
+                   std::vector<svg::Point>::const_iterator last) const;
+
+    // Draws a route label at the given point and adds it to the container
+    void DrawRouteName(svg::ObjectContainer& container,
+                       const std::string_view bus_name, 
+                       const svg::Color& color,
+                       const svg::Point& pos) const;
+
+    // Draws a stop circle and adds it to the container
+    void DrawStop(svg::ObjectContainer& container, const svg::Point& pos) const;
+
+    // Draws stop label and adds it to the container
+    void DrawStopName(svg::ObjectContainer& container,
+                      const std::string_view stop_name, 
+                      const svg::Point& pos) const;
     
     // Draws a circle with set parameters
     svg::Circle GetStopCircle(const svg::Point pos) const;
@@ -214,20 +318,97 @@ private:
     svg::Text GetStopNameText(const std::string_view stop_name, const svg::Point& pos) const;
 
     // Draws a text for the route name with set parameters
-    svg::Text GetRouteNameText(const std::string_view bus_names, const svg::Point& pos) const;
+    svg::Text GetRouteNameText(const std::string_view bus_names, const svg::Color& color, const svg::Point& pos) const;
 
     // Draws a text for the route or stop underlayer text with set parameters
     svg::Text GetUnderlayerText(const std::string_view text, const svg::Point& pos, UnderlayerTextType type) const;
 
     // Draws a route line with set parameters
-    svg::Polyline GetRouteLine(const svg::Color& line_color, const std::vector<svg::Point>& points) const;
+    svg::Polyline GetRouteLine(const svg::Color& line_color, 
+                               std::vector<svg::Point>::const_iterator first,
+                               std::vector<svg::Point>::const_iterator last) const;
+
+    // Label fonts are interned once, so layers drawn in parallel share no lock
+    const std::string* const label_font_family_;
+
+    const std::string* const bus_label_font_weight_;
 
 };
 
+/* A uniform grid over the projected stops and route segments of a map
+ * layout. Selects the parts of the map that fall into a viewport without
+ * scanning the whole map */
+class MapIndex {
+public:
+    // The layout is not copied and must outlive the index
+    explicit MapIndex(const MapRenderer::MapLayout& layout);
+
+    const MapRenderer::MapLayout& GetLayout() const;
+
+    /* Selects stops and route labels placed inside the viewport and the
+     * pieces of route lines that cross it */
+    MapRenderer::MapSelection Select(const domain::MapViewport& viewport) const;
+
+private:
+    // A segment between points point_index and point_index + 1 of a route
+    struct Segment {
+        size_t bus_index;
+        size_t point_index;
+
+        bool operator<(const Segment& other) const {
+            return std::pair{ bus_index, point_index } 
+                 < std::pair{ other.bus_index, other.point_index };
+        }
+
+        bool operator==(const Segment& other) const {
+            return bus_index == other.bus_index 
+                && point_index == other.point_index;
+        }
+    };
+
+    struct Cell {
+        std::vector<size_t> stops;
+        std::vector<Segment> segments;
+    };
+
+    // Returns the range of cell columns or rows covering [min, max]
+    std::pair<size_t, size_t> GetCellRange(double min, double max, 
+                                           double origin, double cell_size,
+                                           size_t cell_count) const;
+
+    const MapRenderer::MapLayout& layout_;
+
+    // Bounding box of all stops, which is the area the grid covers
+    domain::MapViewport bounds_{};
+
+    size_t columns_ = 1;
+
+    size_t rows_ = 1;
+
+    double cell_width_ = 1;
+
+    double cell_height_ = 1;
+
+    // Cells row by row
+    std::vector<Cell> cells_;
+};
+
+// Returns the part of the map plane a tile covers
+domain::MapViewport TileToViewport(const domain::MapTile& tile, 
+                                   const RenderSettings& settings);
+
 namespace tests {
 
 void TestSVG();
 
+void TestLayeredRender();
+
+void TestMapIndex();
+
+void TestRouteSimplification();
+
+void TestIsochroneRender();
+
 } // namespace renderer::tests
 
 } // namespace renderer
\ No newline at end of file
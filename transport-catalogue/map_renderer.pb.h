@@ -190,6 +190,8 @@ class RenderSettings final :
     kBusLabelFontSizeFieldNumber = 6,
     kStopLabelFontSizeFieldNumber = 8,
     kUnderlayerWidthFieldNumber = 11,
+    kRouteSimplificationToleranceFieldNumber = 13,
+    kCoordinatePrecisionFieldNumber = 14,
   };
   // repeated .serialize_transport_catalogue.Color color_palette = 12;
   int color_palette_size() const;
@@ -335,6 +337,28 @@ class RenderSettings final :
   void _internal_set_underlayer_width(double value);
   public:
 
+  // double route_simplification_tolerance = 13;
+  void clear_route_simplification_tolerance();
+  double route_simplification_tolerance() const;
+  void set_route_simplification_tolerance(double value);
+  private:
+  double _internal_route_simplification_tolerance() const;
+  void _internal_set_route_simplification_tolerance(double value);
+  public:
+
+  // optional int32 coordinate_precision = 14;
+  bool has_coordinate_precision() const;
+  private:
+  bool _internal_has_coordinate_precision() const;
+  public:
+  void clear_coordinate_precision();
+  int32_t coordinate_precision() const;
+  void set_coordinate_precision(int32_t value);
+  private:
+  int32_t _internal_coordinate_precision() const;
+  void _internal_set_coordinate_precision(int32_t value);
+  public:
+
   // @@protoc_insertion_point(class_scope:serialize_transport_catalogue.RenderSettings)
  private:
   class _Internal;
@@ -343,6 +367,8 @@ class RenderSettings final :
   typedef void InternalArenaConstructable_;
   typedef void DestructorSkippable_;
   struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
     ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::serialize_transport_catalogue::Color > color_palette_;
     ::serialize_transport_catalogue::Point* bus_label_offset_;
     ::serialize_transport_catalogue::Point* stop_label_offset_;
@@ -355,7 +381,8 @@ class RenderSettings final :
     double bus_label_font_size_;
     double stop_label_font_size_;
     double underlayer_width_;
-    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    double route_simplification_tolerance_;
+    int32_t coordinate_precision_;
   };
   union { Impl_ _impl_; };
   friend struct ::TableStruct_map_5frenderer_2eproto;
@@ -823,6 +850,54 @@ RenderSettings::color_palette() const {
   return _impl_.color_palette_;
 }
 
+// double route_simplification_tolerance = 13;
+inline void RenderSettings::clear_route_simplification_tolerance() {
+  _impl_.route_simplification_tolerance_ = 0;
+}
+inline double RenderSettings::_internal_route_simplification_tolerance() const {
+  return _impl_.route_simplification_tolerance_;
+}
+inline double RenderSettings::route_simplification_tolerance() const {
+  // @@protoc_insertion_point(field_get:serialize_transport_catalogue.RenderSettings.route_simplification_tolerance)
+  return _internal_route_simplification_tolerance();
+}
+inline void RenderSettings::_internal_set_route_simplification_tolerance(double value) {
+  
+  _impl_.route_simplification_tolerance_ = value;
+}
+inline void RenderSettings::set_route_simplification_tolerance(double value) {
+  _internal_set_route_simplification_tolerance(value);
+  // @@protoc_insertion_point(field_set:serialize_transport_catalogue.RenderSettings.route_simplification_tolerance)
+}
+
+// optional int32 coordinate_precision = 14;
+inline bool RenderSettings::_internal_has_coordinate_precision() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000001u) != 0;
+  return value;
+}
+inline bool RenderSettings::has_coordinate_precision() const {
+  return _internal_has_coordinate_precision();
+}
+inline void RenderSettings::clear_coordinate_precision() {
+  _impl_.coordinate_precision_ = 0;
+  _impl_._has_bits_[0] &= ~0x00000001u;
+}
+inline int32_t RenderSettings::_internal_coordinate_precision() const {
+  return _impl_.coordinate_precision_;
+}
+inline int32_t RenderSettings::coordinate_precision() const {
+  // @@protoc_insertion_point(field_get:serialize_transport_catalogue.RenderSettings.coordinate_precision)
+  return _internal_coordinate_precision();
+}
+inline void RenderSettings::_internal_set_coordinate_precision(int32_t value) {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  _impl_.coordinate_precision_ = value;
+}
+inline void RenderSettings::set_coordinate_precision(int32_t value) {
+  _internal_set_coordinate_precision(value);
+  // @@protoc_insertion_point(field_set:serialize_transport_catalogue.RenderSettings.coordinate_precision)
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
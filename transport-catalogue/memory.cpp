@@ -0,0 +1,177 @@
+#include <cassert>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "transport_catalogue.h"
+#include "json_builder.h"
+#include "memory.h"
+#include "json.h"
+
+namespace memory {
+
+using namespace std::literals;
+
+namespace {
+
+// Byte counts outgrow int on big bases, such numbers are printed as doubles
+json::Node MakeBytesNode(int64_t value) {
+    if (value <= std::numeric_limits<int>::max()) {
+        return static_cast<int>(value);
+    }
+    return static_cast<double>(value);
+}
+
+} // namespace
+
+std::string_view GetCategoryName(Category category) {
+    switch (category) {
+    case Category::CATALOGUE_STOPS:
+        return "catalogue_stops"sv;
+    case Category::CATALOGUE_BUSES:
+        return "catalogue_buses"sv;
+    case Category::CATALOGUE_NAMES:
+        return "catalogue_names"sv;
+    case Category::CATALOGUE_DISTANCES:
+        return "catalogue_distances"sv;
+    case Category::GRAPH_EDGES:
+        return "graph_edges"sv;
+    case Category::GRAPH_INCIDENCE_LISTS:
+        return "graph_incidence_lists"sv;
+    case Category::ROUTER_TABLE:
+        return "router_table"sv;
+    case Category::ROUTER_VERTEX_IDS:
+        return "router_vertex_ids"sv;
+    case Category::ROUTER_EDGE_INFO:
+        return "router_edge_info"sv;
+    case Category::RAPTOR_ROUTES:
+        return "raptor_routes"sv;
+    case Category::CONTRACTION_HIERARCHY:
+        return "contraction_hierarchy"sv;
+    case Category::JSON:
+        return "json"sv;
+    case Category::COUNT:
+        break;
+    }
+    return "unknown"sv;
+}
+
+Usage GetUsage(Category category) {
+    const detail::Counter& counter = detail::counters[static_cast<size_t>(category)];
+
+    return { counter.bytes.load(std::memory_order_relaxed),
+             counter.peak_bytes.load(std::memory_order_relaxed),
+             counter.allocations.load(std::memory_order_relaxed) };
+}
+
+void PrintReport(std::ostream& out) {
+    constexpr size_t CATEGORY_COUNT = static_cast<size_t>(Category::COUNT);
+
+    // Building the report allocates json nodes, so usage is taken beforehand
+    std::array<Usage, CATEGORY_COUNT> usages;
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i) {
+        usages[i] = GetUsage(static_cast<Category>(i));
+    }
+
+    json::Dict categories;
+    int64_t total_bytes = 0;
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i) {
+        categories[std::string(GetCategoryName(static_cast<Category>(i)))] =
+            json::Builder{}.StartDict()
+                .Key("bytes"s).Value(MakeBytesNode(usages[i].bytes))
+                .Key("peak_bytes"s).Value(MakeBytesNode(usages[i].peak_bytes))
+                .Key("allocations"s).Value(MakeBytesNode(usages[i].allocations))
+            .EndDict().Build();
+        total_bytes += usages[i].bytes;
+    }
+
+    json::Print(json::Document{ json::Builder{}.StartDict()
+        .Key("categories"s).Value(std::move(categories))
+        .Key("total_bytes"s).Value(MakeBytesNode(total_bytes))
+    .EndDict().Build() }, out);
+    out << '\n';
+}
+
+namespace tests {
+
+void TestTrackingAllocator() {
+    {
+        const Usage before = GetUsage(Category::ROUTER_TABLE);
+
+        Vector<double, Category::ROUTER_TABLE> values;
+        values.reserve(100);
+        assert(GetUsage(Category::ROUTER_TABLE).bytes
+               == before.bytes + static_cast<int64_t>(100 * sizeof(double)));
+        assert(GetUsage(Category::ROUTER_TABLE).allocations == before.allocations + 1);
+
+        // A map allocates its nodes through the rebound allocator
+        Map<int, int, Category::ROUTER_TABLE> numbers{ { 1, 1 }, { 2, 4 } };
+        assert(GetUsage(Category::ROUTER_TABLE).allocations == before.allocations + 3);
+
+        values.clear();
+        values.shrink_to_fit();
+        numbers.clear();
+        assert(GetUsage(Category::ROUTER_TABLE).bytes == before.bytes);
+        assert(GetUsage(Category::ROUTER_TABLE).allocations == before.allocations);
+        assert(GetUsage(Category::ROUTER_TABLE).peak_bytes
+               >= before.bytes + static_cast<int64_t>(100 * sizeof(double)));
+    }
+
+    // The catalogue counts its containers under their categories
+    {
+        const Usage stops_before = GetUsage(Category::CATALOGUE_STOPS);
+        const Usage distances_before = GetUsage(Category::CATALOGUE_DISTANCES);
+
+        transport_catalogue::TransportCatalogue catalogue;
+        catalogue.AddStop("A"sv, { 55.6, 37.2 });
+        catalogue.AddStop("B"sv, { 55.7, 37.3 });
+        catalogue.AddDistance("A"sv, "B"sv, 1000);
+
+        assert(GetUsage(Category::CATALOGUE_STOPS).bytes > stops_before.bytes);
+        assert(GetUsage(Category::CATALOGUE_DISTANCES).bytes > distances_before.bytes);
+
+        // Names, routes and bus sets of the elements are counted as well
+        const Usage names_before = GetUsage(Category::CATALOGUE_NAMES);
+        const Usage buses_before = GetUsage(Category::CATALOGUE_BUSES);
+        const Usage stops_with_buses = GetUsage(Category::CATALOGUE_STOPS);
+
+        catalogue.AddStop("A stop with a long name"sv, { 55.8, 37.4 });
+        assert(GetUsage(Category::CATALOGUE_NAMES).bytes 
+               >= names_before.bytes + static_cast<int64_t>(sizeof("A stop with a long name")));
+
+        catalogue.AddBus("1"sv, { "A"sv, "B"sv }, false);
+        assert(GetUsage(Category::CATALOGUE_BUSES).bytes 
+               >= buses_before.bytes + static_cast<int64_t>(2 * sizeof(domain::StopPtr)));
+        assert(GetUsage(Category::CATALOGUE_STOPS).allocations 
+               >= stops_with_buses.allocations + 2);
+    }
+
+    // Heap buffers of JSON strings are counted with the document
+    {
+        const Usage before = GetUsage(Category::JSON);
+        {
+            const std::string long_string(100, 'x');
+            json::Node node{ json::String(long_string) };
+            json::Node copy = node;
+            assert(GetUsage(Category::JSON).bytes 
+                   >= before.bytes + static_cast<int64_t>(2 * long_string.size()));
+
+            json::Node moved = std::move(node);
+            assert(moved.AsString() == long_string);
+        }
+        assert(GetUsage(Category::JSON).bytes == before.bytes);
+        assert(GetUsage(Category::JSON).allocations == before.allocations);
+    }
+
+    std::ostringstream out;
+    PrintReport(out);
+    std::istringstream in(out.str());
+    const json::Dict report = json::Load(in).GetRoot().AsMap();
+    assert(report.at("categories"s).AsMap().size()
+           == static_cast<size_t>(Category::COUNT));
+    assert(report.at("categories"s).AsMap().count("router_table"s) > 0);
+}
+
+} // namespace memory::tests
+
+} // namespace memory
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* Heap memory held by the main structures. Their containers allocate through
+ * TrackingAllocator of a category, so the bytes each category holds are
+ * known at any moment. Containers owned by the elements, like stop names or
+ * bus routes, are tracked the same way */
+namespace memory {
+
+enum class Category : size_t {
+    CATALOGUE_STOPS,
+    CATALOGUE_BUSES,
+    CATALOGUE_NAMES,
+    CATALOGUE_DISTANCES,
+    GRAPH_EDGES,
+    GRAPH_INCIDENCE_LISTS,
+    ROUTER_TABLE,
+    ROUTER_VERTEX_IDS,
+    ROUTER_EDGE_INFO,
+    RAPTOR_ROUTES,
+    CONTRACTION_HIERARCHY,
+    JSON,
+    COUNT
+};
+
+std::string_view GetCategoryName(Category category);
+
+struct Usage {
+    int64_t bytes = 0;
+
+    // The most bytes the category ever held at once
+    int64_t peak_bytes = 0;
+
+    // Allocations not freed yet
+    int64_t allocations = 0;
+};
+
+namespace detail {
+
+struct Counter {
+    std::atomic<int64_t> bytes{ 0 };
+    std::atomic<int64_t> peak_bytes{ 0 };
+    std::atomic<int64_t> allocations{ 0 };
+};
+
+inline std::array<Counter, static_cast<size_t>(Category::COUNT)> counters;
+
+inline void Allocate(Category category, size_t size) {
+    Counter& counter = counters[static_cast<size_t>(category)];
+
+    const int64_t bytes = counter.bytes.fetch_add(static_cast<int64_t>(size),
+                                                  std::memory_order_relaxed)
+                        + static_cast<int64_t>(size);
+    int64_t peak_bytes = counter.peak_bytes.load(std::memory_order_relaxed);
+    while (bytes > peak_bytes
+           && !counter.peak_bytes.compare_exchange_weak(peak_bytes, bytes,
+                                                        std::memory_order_relaxed)) {
+    }
+
+    counter.allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void Deallocate(Category category, size_t size) {
+    Counter& counter = counters[static_cast<size_t>(category)];
+
+    counter.bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+    counter.allocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+} // namespace memory::detail
+
+// The standard allocator that counts what it holds under the category
+template <typename T, Category category>
+class TrackingAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = TrackingAllocator<U, category>;
+    };
+
+    TrackingAllocator() noexcept = default;
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, category>&) noexcept {}
+
+    T* allocate(size_t count) {
+        T* ptr = std::allocator<T>{}.allocate(count);
+        detail::Allocate(category, count * sizeof(T));
+        return ptr;
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept {
+        detail::Deallocate(category, count * sizeof(T));
+        std::allocator<T>{}.deallocate(ptr, count);
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U, category>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U, category>&) const noexcept {
+        return false;
+    }
+};
+
+template <typename T, Category category>
+using Vector = std::vector<T, TrackingAllocator<T, category>>;
+
+template <typename T, Category category>
+using Deque = std::deque<T, TrackingAllocator<T, category>>;
+
+template <typename Key, Category category, typename Compare = std::less<Key>>
+using Set = std::set<Key, Compare, TrackingAllocator<Key, category>>;
+
+// Short strings are kept inline and allocate nothing
+template <Category category>
+using String = std::basic_string<char, std::char_traits<char>,
+                                 TrackingAllocator<char, category>>;
+
+/* A std::string that counts its heap buffer under the category. Is used
+ * where the interface hands out std::string, so the string can't get a
+ * tracking allocator. Short strings are kept inline and count nothing */
+template <Category category>
+class CountedString {
+public:
+    CountedString() = default;
+
+    CountedString(std::string str)
+        : str_(std::move(str)) {
+        Count();
+    }
+
+    CountedString(const char* str)
+        : CountedString(std::string(str)) {}
+
+    CountedString(const CountedString& other)
+        : str_(other.str_) {
+        Count();
+    }
+
+    // The buffer moves along with its bytes
+    CountedString(CountedString&& other) noexcept
+        : str_(std::move(other.str_))
+        , bytes_(std::exchange(other.bytes_, 0)) {}
+
+    CountedString& operator=(CountedString other) noexcept {
+        std::swap(str_, other.str_);
+        std::swap(bytes_, other.bytes_);
+        return *this;
+    }
+
+    ~CountedString() {
+        if (bytes_ > 0) {
+            detail::Deallocate(category, bytes_);
+        }
+    }
+
+    const std::string& Get() const {
+        return str_;
+    }
+
+    operator const std::string&() const {
+        return str_;
+    }
+
+    bool operator==(const CountedString& other) const {
+        return str_ == other.str_;
+    }
+
+    bool operator!=(const CountedString& other) const {
+        return str_ != other.str_;
+    }
+
+    bool operator<(const CountedString& other) const {
+        return str_ < other.str_;
+    }
+
+private:
+    void Count() {
+        if (str_.capacity() > std::string().capacity()) {
+            bytes_ = str_.capacity() + 1;
+            detail::Allocate(category, bytes_);
+        }
+    }
+
+    std::string str_;
+
+    size_t bytes_ = 0;
+};
+
+template <typename Key, typename Value, Category category,
+          typename Compare = std::less<Key>>
+using Map = std::map<Key, Value, Compare,
+                     TrackingAllocator<std::pair<const Key, Value>, category>>;
+
+template <typename Key, typename Value, Category category,
+          typename Hash = std::hash<Key>>
+using UnorderedMap = std::unordered_map<Key, Value, Hash, std::equal_to<Key>,
+                     TrackingAllocator<std::pair<const Key, Value>, category>>;
+
+Usage GetUsage(Category category);
+
+/* Prints bytes, peak bytes and live allocations of every category and their
+ * total as a JSON dict */
+void PrintReport(std::ostream& out);
+
+namespace tests {
+
+void TestTrackingAllocator();
+
+} // namespace memory::tests
+
+} // namespace memory
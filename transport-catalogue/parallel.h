@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// Returns the number of threads the helpers below split the work between
+inline size_t GetThreadCount() {
+    const size_t hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads == 0 ? 1 : hardware_threads;
+}
+
+/* Splits [0, count) into contiguous chunks and calls func(begin, end) for
+ * each of them on a separate thread. Small inputs are processed on the
+ * calling thread. The first exception thrown by a chunk is rethrown once
+ * every thread is joined */
+template <typename Func>
+void ForEachChunk(size_t count, Func func, size_t min_chunk_size = 1024) {
+    const size_t chunk_count = std::min(GetThreadCount(),
+                                        count / std::max<size_t>(min_chunk_size, 1));
+    if (chunk_count <= 1) {
+        func(size_t{0}, count);
+        return;
+    }
+
+    const size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+    std::vector<std::exception_ptr> errors(chunk_count);
+    std::vector<std::thread> threads;
+    threads.reserve(chunk_count);
+
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+        const size_t begin = std::min(chunk * chunk_size, count);
+        const size_t end   = std::min(begin + chunk_size, count);
+        threads.emplace_back([&func, &errors, chunk, begin, end]() {
+            try {
+                func(begin, end);
+            } catch (...) {
+                errors[chunk] = std::current_exception();
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+} // namespace parallel
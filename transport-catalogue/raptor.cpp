@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <variant>
+
+#include "generator.h"
+#include "parallel.h"
+#include "raptor.h"
+#include "stats.h"
+
+namespace transport_router {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr Weight INFINITE_TIME = std::numeric_limits<Weight>::infinity();
+
+/* Arrivals are sums of doubles gathered in a different order than the times
+ * of the items, so a journey has to be sooner by more than the rounding to
+ * count as better */
+constexpr Weight TIME_EPSILON = 1e-9;
+
+// Fewer routes than that in a round are scanned on the calling thread
+constexpr size_t MIN_ROUTES_PER_THREAD = 512;
+
+} // namespace
+
+RaptorRouter::RaptorRouter(const TransportCatalogue& catalogue,
+                           RoutingSettings settings)
+    : catalogue_(&catalogue)
+    , settings_(std::move(settings)) {
+    constexpr double MIN_PER_HOUR  = 60;
+
+    constexpr double METERS_PER_KM = 1000;
+
+    stats::ScopedTimer timer("build_raptor"sv);
+
+    stops_.resize(catalogue.GetStopCount());
+    for (std::string_view stop_name : catalogue.GetStopNames()) {
+        const domain::StopPtr stop_ptr = catalogue.FindStop(stop_name);
+        stops_[stop_ptr->id] = stop_ptr;
+    }
+
+    for (std::string_view bus_name : catalogue.GetBusNames()) {
+        const domain::BusPtr bus_ptr = catalogue.FindBus(bus_name);
+
+        // A bus with a single stop can't take anyone anywhere
+        if (bus_ptr->route.size() >= 2) {
+            buses_.push_back(bus_ptr);
+        }
+    }
+
+    route_offsets_.resize(buses_.size() + 1, 0);
+    for (size_t i = 0; i < buses_.size(); ++i) {
+        route_offsets_[i + 1] = route_offsets_[i]
+                              + static_cast<Index>(buses_[i]->route.size());
+    }
+
+    route_stops_.resize(route_offsets_.back());
+    route_times_.resize(route_offsets_.back());
+
+    /* Times are summed up from the first stop exactly the way TransportRouter
+     * sums up its edges, so both give the same times to the same rides */
+    parallel::ForEachChunk(buses_.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const domain::Route& route = buses_[i]->route;
+            const Index offset = route_offsets_[i];
+
+            double total_distance = 0.0;
+            for (size_t j = 0; j < route.size(); ++j) {
+                if (j > 0) {
+                    total_distance += catalogue.GetDistance(route[j - 1]->name,
+                                                            route[j]->name);
+                }
+                route_stops_[offset + j] = static_cast<Index>(route[j]->id);
+                route_times_[offset + j] = (total_distance / settings_.bus_velocity)
+                                         * (MIN_PER_HOUR / METERS_PER_KM);
+            }
+        }
+    }, 16);
+
+    stop_offsets_.resize(stops_.size() + 1, 0);
+    for (const Index stop : route_stops_) {
+        ++stop_offsets_[stop + 1];
+    }
+    for (size_t i = 0; i < stops_.size(); ++i) {
+        stop_offsets_[i + 1] += stop_offsets_[i];
+    }
+
+    stop_visits_.resize(route_stops_.size());
+    std::vector<Index> next_visits(stop_offsets_.begin(), stop_offsets_.end() - 1);
+    for (Index route = 0; route < buses_.size(); ++route) {
+        for (Index position = route_offsets_[route];
+                   position < route_offsets_[route + 1]; ++position) {
+            stop_visits_[next_visits[route_stops_[position]]++] = {
+                route, position - route_offsets_[route] };
+        }
+    }
+
+    stats::AddCounter("raptor_routes"sv, buses_.size());
+}
+
+std::vector<RoutingResult> RaptorRouter::BuildRoutes(
+                                                std::string_view from,
+                                                std::string_view to) const {
+    const std::optional<Index> from_opt = GetStopIndex(from);
+    const std::optional<Index> to_opt   = GetStopIndex(to);
+    if (!from_opt.has_value() || !to_opt.has_value()) return {};
+
+    if (*from_opt == *to_opt) {
+        return { RoutingResult{ /* "total_time": */ 0.0, /* "items": */ {} } };
+    }
+
+    const Index target = *to_opt;
+
+    /* Arrivals and labels of the stops are the best over all the rounds so
+     * far. Within a round they are only read, improvements found by the route
+     * scans are applied at its end, so a round never rides two buses */
+    std::vector<Weight> arrivals(stops_.size(), INFINITE_TIME);
+    std::vector<Index> stop_labels(stops_.size(), NO_INDEX);
+    std::vector<Label> labels;
+
+    arrivals[*from_opt] = 0.0;
+    stop_labels[*from_opt] = 0;
+    labels.push_back({ 0.0, NO_INDEX, NO_INDEX, NO_INDEX, NO_INDEX });
+
+    std::vector<Index> marked_stops{ *from_opt };
+    std::vector<bool> is_marked(stops_.size(), false);
+
+    // The earliest position of a marked stop on every route queued in a round
+    std::vector<Index> route_positions(buses_.size(), NO_INDEX);
+    std::vector<Index> queued_routes;
+
+    // Labels of the target, one per round that made it reachable sooner
+    std::vector<Index> target_labels;
+
+    while (!marked_stops.empty()) {
+        queued_routes.clear();
+        for (const Index stop : marked_stops) {
+            is_marked[stop] = false;
+
+            for (Index visit = stop_offsets_[stop];
+                       visit < stop_offsets_[stop + 1]; ++visit) {
+                const StopVisit& stop_visit = stop_visits_[visit];
+                Index& position = route_positions[stop_visit.route];
+
+                if (position == NO_INDEX) {
+                    queued_routes.push_back(stop_visit.route);
+                    position = stop_visit.position;
+                } else {
+                    position = std::min(position, stop_visit.position);
+                }
+            }
+        }
+        marked_stops.clear();
+
+        /* Chunks are merged in the order of their routes, so the result
+         * doesn't depend on the number of threads */
+        std::map<size_t, std::vector<Improvement>> chunk_improvements;
+        std::mutex chunk_improvements_mutex;
+
+        parallel::ForEachChunk(queued_routes.size(), [&](size_t begin, size_t end) {
+            std::vector<Improvement> improvements;
+            for (size_t i = begin; i < end; ++i) {
+                ScanRoute(queued_routes[i], route_positions[queued_routes[i]],
+                          target, arrivals, stop_labels, improvements);
+            }
+
+            std::lock_guard guard(chunk_improvements_mutex);
+            chunk_improvements[begin] = std::move(improvements);
+        }, MIN_ROUTES_PER_THREAD);
+
+        for (const Index route : queued_routes) {
+            route_positions[route] = NO_INDEX;
+        }
+
+        const Index target_label = stop_labels[target];
+
+        for (const auto& [begin, improvements] : chunk_improvements) {
+            for (const Improvement& improvement : improvements) {
+                if (improvement.arrival >= arrivals[improvement.stop] - TIME_EPSILON
+                 || improvement.arrival >= arrivals[target] - TIME_EPSILON) {
+                    continue;
+                }
+
+                arrivals[improvement.stop] = improvement.arrival;
+                stop_labels[improvement.stop] = static_cast<Index>(labels.size());
+                labels.push_back({ improvement.arrival, improvement.parent,
+                                   improvement.route, improvement.board_position,
+                                   improvement.alight_position });
+
+                if (!is_marked[improvement.stop]) {
+                    is_marked[improvement.stop] = true;
+                    marked_stops.push_back(improvement.stop);
+                }
+            }
+        }
+
+        if (stop_labels[target] != target_label) {
+            target_labels.push_back(stop_labels[target]);
+        }
+    }
+
+    std::vector<RoutingResult> results;
+    results.reserve(target_labels.size());
+    for (const Index label : target_labels) {
+        results.push_back(AssembleRoutingResult(labels, label));
+    }
+
+    return results;
+}
+
+std::optional<RoutingResult> RaptorRouter::BuildRoute(
+                                        std::string_view from,
+                                        std::string_view to,
+                                        domain::RouteCriterion criterion) const {
+    std::vector<RoutingResult> results = BuildRoutes(from, to);
+    if (results.empty()) return std::nullopt;
+
+    if (criterion == domain::RouteCriterion::TRANSFERS) {
+        return std::move(results.front());
+    }
+    return std::move(results.back());
+}
+
+void RaptorRouter::ScanRoute(Index route, Index position, Index target,
+                             const std::vector<Weight>& arrivals,
+                             const std::vector<Index>& labels,
+                             std::vector<Improvement>& improvements) const {
+    const Index route_begin = route_offsets_[route];
+    const Index route_end   = route_offsets_[route + 1];
+
+    /* Riding from the boarding position b to a position i takes the time
+     * arrivals[b] + wait - times[b] + times[i], so the bus is boarded where
+     * the first three terms are the least */
+    Weight boarding_time = INFINITE_TIME;
+    Index board_position = NO_INDEX;
+    Index board_label = NO_INDEX;
+
+    for (Index i = route_begin + position; i < route_end; ++i) {
+        const Index stop = route_stops_[i];
+
+        if (board_position != NO_INDEX) {
+            const Weight arrival = boarding_time + route_times_[i];
+
+            if (arrival < arrivals[stop] - TIME_EPSILON
+             && arrival < arrivals[target] - TIME_EPSILON) {
+                improvements.push_back({ stop, arrival, board_label, route,
+                                         board_position, i - route_begin });
+            }
+        }
+
+        if (arrivals[stop] != INFINITE_TIME) {
+            const Weight time = arrivals[stop] + settings_.bus_wait_time
+                              - route_times_[i];
+            if (time < boarding_time) {
+                boarding_time = time;
+                board_position = i - route_begin;
+                board_label = labels[stop];
+            }
+        }
+    }
+}
+
+RoutingResult RaptorRouter::AssembleRoutingResult(const std::vector<Label>& labels,
+                                                  Index label) const {
+    std::vector<const Label*> rides;
+    for (; labels[label].parent != NO_INDEX; label = labels[label].parent) {
+        rides.push_back(&labels[label]);
+    }
+    std::reverse(rides.begin(), rides.end());
+
+    RoutingResult result{ 0.0, {} };
+    result.items.reserve(rides.size() * 2);
+
+    for (const Label* ride : rides) {
+        const Index route_begin = route_offsets_[ride->route];
+        const Index board = route_begin + ride->board_position;
+        const Index alight = route_begin + ride->alight_position;
+        const Weight ride_time = route_times_[alight] - route_times_[board];
+
+        result.items.emplace_back(RouteItemWait{
+                                    std::string(stops_[route_stops_[board]]->name),
+                                    settings_.bus_wait_time });
+        result.items.emplace_back(RouteItemBus{
+                                    std::string(buses_[ride->route]->name),
+                                    static_cast<int>(alight - board),
+                                    ride_time });
+
+        result.total_time += settings_.bus_wait_time;
+        result.total_time += ride_time;
+    }
+
+    return result;
+}
+
+std::optional<RaptorRouter::Index> RaptorRouter::GetStopIndex(
+                                            std::string_view stop_name) const {
+    if (!catalogue_->HasStop(stop_name)) return std::nullopt;
+
+    const Index stop = static_cast<Index>(catalogue_->FindStop(stop_name)->id);
+
+    // Stops no bus goes through can't be routed from or to
+    if (stop_offsets_[stop] == stop_offsets_[stop + 1]) return std::nullopt;
+
+    return stop;
+}
+
+namespace tests {
+
+namespace {
+
+// Number of buses a journey rides
+size_t CountBuses(const RoutingResult& result) {
+    return std::count_if(result.items.begin(), result.items.end(),
+                         [](const RouteItem& item) {
+                             return std::holds_alternative<RouteItemBus>(item);
+                         });
+}
+
+Weight SumItemTimes(const RoutingResult& result) {
+    Weight total_time = 0.0;
+    for (const RouteItem& item : result.items) {
+        if (std::holds_alternative<RouteItemBus>(item)) {
+            total_time += std::get<RouteItemBus>(item).time;
+        } else if (std::holds_alternative<RouteItemWait>(item)) {
+            total_time += std::get<RouteItemWait>(item).time;
+        }
+    }
+    return total_time;
+}
+
+} // namespace
+
+void TestRaptorRouting() {
+    transport_catalogue::TransportCatalogue tc;
+
+    tc.AddStop("Tolstopaltsevo"sv, { 55.611087, 37.20829 });
+    tc.AddStop("Marushkino"sv, { 55.595884, 37.209755 });
+    tc.AddStop("Rasskazovka"sv, { 55.632761, 37.333324 });
+    tc.AddStop("Lonely"sv, { 55.65, 37.4 });
+
+    tc.AddDistance("Tolstopaltsevo"sv, "Rasskazovka"sv, 10000);
+    tc.AddDistance("Tolstopaltsevo"sv, "Marushkino"sv, 1000);
+    tc.AddDistance("Marushkino"sv, "Rasskazovka"sv, 1000);
+
+    // A slow direct bus and two fast ones with a transfer in between
+    tc.AddBus("750"sv, { "Tolstopaltsevo"sv, "Rasskazovka"sv, "Tolstopaltsevo"sv });
+    tc.AddBus("14"sv, { "Tolstopaltsevo"sv, "Marushkino"sv, "Tolstopaltsevo"sv });
+    tc.AddBus("15"sv, { "Marushkino"sv, "Rasskazovka"sv, "Marushkino"sv });
+
+    RoutingSettings settings {
+        /* bus_wait_time: */  2,
+        /* bus_velocity:  */  60
+    };
+
+    const RaptorRouter router(tc, settings);
+
+    const std::vector<RoutingResult> routes = router.BuildRoutes(
+                                        "Tolstopaltsevo"sv, "Rasskazovka"sv);
+    assert(routes.size() == 2);
+    assert(CountBuses(routes[0]) == 1 && DoubleEq(routes[0].total_time, 12));
+    assert(CountBuses(routes[1]) == 2 && DoubleEq(routes[1].total_time, 6));
+
+    const RouteItemWait& wait = std::get<RouteItemWait>(routes[1].items[2]);
+    assert(wait.stop_name == "Marushkino"s && DoubleEq(wait.time, 2));
+    const RouteItemBus& bus = std::get<RouteItemBus>(routes[1].items[3]);
+    assert(bus.bus_name == "15"s && bus.span_count == 1 && DoubleEq(bus.time, 1));
+
+    const auto fewest_buses = router.BuildRoute("Tolstopaltsevo"sv, "Rasskazovka"sv,
+                                                domain::RouteCriterion::TRANSFERS);
+    assert(fewest_buses && std::get<RouteItemBus>(fewest_buses->items[1]).bus_name
+                           == "750"s);
+
+    const auto fastest = router.BuildRoute("Tolstopaltsevo"sv, "Rasskazovka"sv,
+                                           domain::RouteCriterion::TIME);
+    assert(fastest && DoubleEq(fastest->total_time, 6));
+
+    // The way back rides the second half of the same routes
+    const std::vector<RoutingResult> routes_back = router.BuildRoutes(
+                                        "Rasskazovka"sv, "Tolstopaltsevo"sv);
+    assert(routes_back.size() == 2);
+    assert(DoubleEq(routes_back[1].total_time, 6));
+
+    const std::vector<RoutingResult> same_stop = router.BuildRoutes(
+                                        "Marushkino"sv, "Marushkino"sv);
+    assert(same_stop.size() == 1 && same_stop[0].items.empty());
+
+    assert(router.BuildRoutes("Lonely"sv, "Marushkino"sv).empty());
+    assert(router.BuildRoutes("Marushkino"sv, "Nowhere"sv).empty());
+    assert(!router.BuildRoute("Marushkino"sv, "Lonely"sv,
+                              domain::RouteCriterion::TIME));
+}
+
+void TestRaptorMatchesRouter() {
+    generator::CitySettings city_settings;
+    city_settings.stop_count = 80;
+    city_settings.bus_count = 12;
+    city_settings.seed = 7;
+
+    transport_catalogue::TransportCatalogue tc;
+    generator::FillCatalogue(tc, generator::GenerateCity(city_settings));
+
+    const RoutingSettings settings = generator::MakeRoutingSettings();
+    const TransportRouter transport_router(tc, settings);
+    const RaptorRouter raptor_router(tc, settings);
+
+    for (const std::string_view from : tc.GetStopNames()) {
+        for (const std::string_view to : tc.GetStopNames()) {
+            const auto expected = transport_router.BuildRoute(from, to);
+            const std::vector<RoutingResult> routes = raptor_router.BuildRoutes(from, to);
+
+            assert(expected.has_value() == !routes.empty());
+            if (!expected) continue;
+
+            // The fastest journey takes as long as the one over the graph
+            assert(DoubleEq(routes.back().total_time, expected->total_time));
+            assert(CountBuses(routes.front()) <= CountBuses(*expected));
+
+            // Every next journey rides more buses and arrives sooner
+            for (size_t i = 0; i < routes.size(); ++i) {
+                assert(DoubleEq(SumItemTimes(routes[i]), routes[i].total_time));
+                if (i > 0) {
+                    assert(CountBuses(routes[i]) > CountBuses(routes[i - 1]));
+                    assert(routes[i].total_time < routes[i - 1].total_time);
+                }
+            }
+        }
+    }
+}
+
+} // namespace transport_router::tests
+
+} // namespace transport_router
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "domain.h"
+#include "memory.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+namespace transport_router {
+
+/* Round-based router over the bus routes of the catalogue. Round k finds the
+ * fastest journeys riding at most k buses, so besides the fastest journey
+ * it finds the one with the fewest buses and every journey in between that
+ * isn't worse in both. Times are the same as in TransportRouter: every bus
+ * is waited for bus_wait_time, then ridden at bus_velocity */
+class RaptorRouter {
+public:
+    using TransportCatalogue = transport_catalogue::TransportCatalogue;
+
+    RaptorRouter(const TransportCatalogue& catalogue, RoutingSettings settings);
+
+    /* Returns journeys not worse than each other in both time and the number
+     * of buses, from the fewest buses to the fastest. Empty if a stop is
+     * unknown, is on no route or the other stop can't be reached */
+    std::vector<RoutingResult> BuildRoutes(std::string_view from,
+                                           std::string_view to) const;
+
+    /* Returns the fastest journey for TIME and the fastest of the journeys
+     * with the fewest buses for TRANSFERS */
+    std::optional<RoutingResult> BuildRoute(std::string_view from,
+                                            std::string_view to,
+                                            domain::RouteCriterion criterion) const;
+
+private:
+    using Index = uint32_t;
+
+    static constexpr Index NO_INDEX = static_cast<Index>(-1);
+
+    // A position of a stop on a route
+    struct StopVisit {
+        Index route;
+        Index position;
+    };
+
+    // The best arrival at a stop found so far and the ride that gave it
+    struct Label {
+        Weight arrival;
+
+        // Label of the stop the bus was boarded at, NO_INDEX for the origin
+        Index parent;
+
+        Index route;
+        Index board_position;
+        Index alight_position;
+    };
+
+    // An arrival found while scanning routes, applied after the whole round
+    struct Improvement {
+        Index stop;
+        Weight arrival;
+        Index parent;
+        Index route;
+        Index board_position;
+        Index alight_position;
+    };
+
+    /* Scans the route from the position on, boarding at stops reached by
+     * the previous rounds and alighting where it improves their arrivals */
+    void ScanRoute(Index route, Index position, Index target,
+                   const std::vector<Weight>& arrivals,
+                   const std::vector<Index>& labels,
+                   std::vector<Improvement>& improvements) const;
+
+    // Turns the chain of labels ending at the label into wait and bus items
+    RoutingResult AssembleRoutingResult(const std::vector<Label>& labels,
+                                        Index label) const;
+
+    std::optional<Index> GetStopIndex(std::string_view stop_name) const;
+
+    const TransportCatalogue* catalogue_;
+
+    RoutingSettings settings_;
+
+    std::vector<domain::StopPtr> stops_;
+
+    std::vector<domain::BusPtr> buses_;
+
+    /* Stops of every route one after another, the route i takes positions
+     * [route_offsets_[i], route_offsets_[i + 1]). Ride times are counted
+     * from the first stop of the route */
+    memory::Vector<Index, memory::Category::RAPTOR_ROUTES> route_offsets_;
+
+    memory::Vector<Index, memory::Category::RAPTOR_ROUTES> route_stops_;
+
+    memory::Vector<Weight, memory::Category::RAPTOR_ROUTES> route_times_;
+
+    // Visits of every stop one after another, laid out like the routes
+    memory::Vector<Index, memory::Category::RAPTOR_ROUTES> stop_offsets_;
+
+    memory::Vector<StopVisit, memory::Category::RAPTOR_ROUTES> stop_visits_;
+};
+
+namespace tests {
+
+void TestRaptorRouting();
+
+void TestRaptorMatchesRouter();
+
+} // namespace transport_router::tests
+
+} // namespace transport_router
@@ -1,12 +1,15 @@
 #pragma once
 
 #include "graph.h"
+#include "memory.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <optional>
+#include <queue>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
@@ -32,12 +35,30 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    // Returns the weight of the shortest route without assembling its edges
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const;
+
+    /* The updates below are for a caller that keeps one router alive while
+     * the graph changes. make_base and process_requests don't: the table
+     * isn't stored in the base, so every process builds it from scratch */
+
+    /* Updates the routes after the edge was added to the graph. Only the
+     * routes that become shorter through the new edge are rewritten */
+    void OnEdgeAdded(EdgeId edge_id);
+
+    /* Updates the routes after the weight of the edge was changed in the 
+     * graph. A decrease is handled like an insertion, an increase recomputes 
+     * only the rows whose shortest path tree contains the edge */
+    void OnEdgeWeightChanged(EdgeId edge_id, Weight old_weight);
+
 private:
     struct RouteInternalData {
         Weight weight;
         std::optional<EdgeId> prev_edge;
     };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+    using RoutesRow = memory::Vector<std::optional<RouteInternalData>, 
+                                     memory::Category::ROUTER_TABLE>;
+    using RoutesInternalData = memory::Vector<RoutesRow, memory::Category::ROUTER_TABLE>;
 
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
@@ -78,6 +99,54 @@ private:
         }
     }
 
+    // Relaxes every route through the given edge: from -> edge.from -> edge.to -> to
+    void RelaxRoutesInternalDataThroughEdge(EdgeId edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        const size_t vertex_count = graph_.GetVertexCount();
+        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+            const auto& route_from = routes_internal_data_[vertex_from][edge.from];
+            if (!route_from) {
+                continue;
+            }
+            const RouteInternalData route_through{route_from->weight + edge.weight, edge_id};
+            for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+                if (const auto& route_to = routes_internal_data_[edge.to][vertex_to]) {
+                    RelaxRoute(vertex_from, vertex_to, route_through, *route_to);
+                }
+            }
+        }
+    }
+
+    // Recomputes a single row of the table with Dijkstra's algorithm
+    void RebuildRoutesInternalDataFrom(VertexId vertex_from) {
+        auto& row = routes_internal_data_[vertex_from];
+        std::fill(row.begin(), row.end(), std::nullopt);
+        row[vertex_from] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        queue.push({ZERO_WEIGHT, vertex_from});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (row[vertex]->weight < weight) {
+                continue;
+            }
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                const Weight candidate_weight = weight + edge.weight;
+                auto& route = row[edge.to];
+                if (!route || candidate_weight < route->weight) {
+                    route = RouteInternalData{candidate_weight, edge_id};
+                    queue.push({candidate_weight, edge.to});
+                }
+            }
+        }
+    }
+
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
@@ -87,7 +156,7 @@ template <typename Weight>
 Router<Weight>::Router(const Graph& graph)
     : graph_(graph)
     , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+                            RoutesRow(graph.GetVertexCount()))
 {
     InitializeRoutesInternalData(graph);
 
@@ -119,4 +188,39 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
     return RouteInfo{weight, std::move(edges)};
 }
 
+template <typename Weight>
+std::optional<Weight> Router<Weight>::GetRouteWeight(VertexId from, VertexId to) const {
+    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
+    if (!route_internal_data) {
+        return std::nullopt;
+    }
+    return route_internal_data->weight;
+}
+
+template <typename Weight>
+void Router<Weight>::OnEdgeAdded(EdgeId edge_id) {
+    RelaxRoutesInternalDataThroughEdge(edge_id);
+}
+
+template <typename Weight>
+void Router<Weight>::OnEdgeWeightChanged(EdgeId edge_id, Weight old_weight) {
+    const auto& edge = graph_.GetEdge(edge_id);
+    if (edge.weight < old_weight) {
+        RelaxRoutesInternalDataThroughEdge(edge_id);
+        return;
+    }
+    if (!(old_weight < edge.weight)) {
+        return;
+    }
+    /* The edge is a part of the shortest path tree of a row if and only if 
+     * it is the last edge of the route to its head vertex */
+    const size_t vertex_count = graph_.GetVertexCount();
+    for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+        const auto& route = routes_internal_data_[vertex_from][edge.to];
+        if (route && route->prev_edge == edge_id) {
+            RebuildRoutesInternalDataFrom(vertex_from);
+        }
+    }
+}
+
 }  // namespace graph
\ No newline at end of file
@@ -1,33 +1,157 @@
 #include "transport_catalogue.pb.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
+#include "map_geometry.pb.h"
 #include "map_renderer.pb.h"
 #include "serialization.h"
 #include "map_renderer.h"
 #include "graph.pb.h"
 #include "domain.h"
 #include "svg.pb.h"
+#include "stats.h"
 #include "geo.h"
 
 #include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <memory>
 #include <set>
 #include <sstream>
+#include <stdexcept>
 #include <variant>
 
 namespace serialization {
 
 namespace database {
 
+namespace {
+
+/* The header holds the magic word, the version of the format and the size
+ * of the table of contents, numbers are little-endian */
+constexpr char MAGIC[] = { 'T', 'C', 'D', 'B' };
+constexpr size_t MAGIC_SIZE = sizeof(MAGIC);
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr size_t HEADER_SIZE = MAGIC_SIZE + sizeof(uint32_t) + sizeof(uint64_t);
+
+void WriteNumber(char* out, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        out[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+uint64_t ReadNumber(const char* in, size_t size) {
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(in[i])) << (i * 8);
+    }
+
+    return value;
+}
+
+void WriteHeader(std::ostream& out, uint64_t toc_size) {
+    char header[HEADER_SIZE];
+
+    std::copy(std::begin(MAGIC), std::end(MAGIC), header);
+    WriteNumber(header + MAGIC_SIZE, FORMAT_VERSION, sizeof(uint32_t));
+    WriteNumber(header + MAGIC_SIZE + sizeof(uint32_t), toc_size, sizeof(uint64_t));
+
+    out.write(header, HEADER_SIZE);
+}
+
+uint64_t ReadHeader(std::istream& in) {
+    char header[HEADER_SIZE];
+
+    if (!in.read(header, HEADER_SIZE)) {
+        throw std::runtime_error("Base file is too short to have a header");
+    }
+
+    if (!std::equal(std::begin(MAGIC), std::end(MAGIC), header)) {
+        throw std::runtime_error("File is not a transport catalogue base");
+    }
+
+    const uint64_t version = ReadNumber(header + MAGIC_SIZE, sizeof(uint32_t));
+    if (version != FORMAT_VERSION) {
+        throw std::runtime_error("Base file format version "
+                                 + std::to_string(version) + " is not supported");
+    }
+
+    return ReadNumber(header + MAGIC_SIZE + sizeof(uint32_t), sizeof(uint64_t));
+}
+
+// Returns the number of bytes from the current position to the end
+uint64_t GetRemainingSize(std::istream& in) {
+    const std::streampos position = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streampos end = in.tellg();
+    in.seekg(position);
+
+    if (position < 0 || end < position) {
+        throw std::runtime_error("Base file stream can't be measured");
+    }
+
+    return static_cast<uint64_t>(end - position);
+}
+
+} // namespace
+
 void DatabaseSerializer::Serialize(const TransportCatalogue& catalogue,
                                    const RenderSettings& render_settings,
                                    const TransportRouter& router,
                                    std::ostream& out) {
-    BuildSerialized(catalogue, 
-                    render_settings,
-                    router
-    ).SerializeToOstream(&out);
+    using TCSerializer  = transport_catalogue::TransportCatalogueSerializer;
+    using SVGSerializer = svg::SVGSerializer;
+    using RouterSerializer = router::RouterSerializer;
+
+    stats::ScopedTimer timer("serialize_base");
+
+    std::vector<std::pair<serialize::SectionType, std::string>> sections {
+        { serialize::CATALOGUE, 
+          TCSerializer::BuildSerialized(catalogue).SerializeAsString() },
+        { serialize::RENDER_SETTINGS, 
+          SVGSerializer::BuildSerialized(render_settings).SerializeAsString() },
+        { serialize::GRAPH_INFO, 
+          RouterSerializer::BuildSerialized(router).SerializeAsString() },
+        { serialize::ROUTING_SETTINGS,
+          RouterSerializer::BuildSerializedRoutingSettings(
+              router.GetRoutingSettings()).SerializeAsString() }
+    };
+
+    // The graph is contracted here, so process_requests doesn't pay for it
+    if (const auto* hierarchy = router.GetContractionHierarchy()) {
+        sections.emplace_back(serialize::CONTRACTION_HIERARCHY,
+            RouterSerializer::BuildSerializedHierarchy(
+                *hierarchy, router.GetRouteGraph().GetVertexCount())
+            .SerializeAsString());
+    }
+
+    serialize::TableOfContents toc;
+    uint64_t offset = 0;
+
+    for (const auto& [type, data] : sections) {
+        serialize::Section& section = *toc.add_sections();
+
+        section.set_type(type);
+        section.set_offset(offset);
+        section.set_size(data.size());
+
+        offset += data.size();
+    }
+
+    const std::string serialized_toc = toc.SerializeAsString();
+
+    WriteHeader(out, serialized_toc.size());
+    out.write(serialized_toc.data(), serialized_toc.size());
+
+    for (const auto& [type, data] : sections) {
+        out.write(data.data(), data.size());
+    }
+
+    stats::AddCounter("base_bytes_written", 
+                      HEADER_SIZE + serialized_toc.size() + offset);
 }
 
 DatabaseSerializer::SerializedDatabase
@@ -50,22 +174,13 @@ DatabaseSerializer::BuildSerialized(const TransportCatalogue& catalogue,
 }
 
 Database DatabaseSerializer::Deserialize(std::istream &in) {
-    using TCSerializer  = transport_catalogue::TransportCatalogueSerializer;
-    using SVGSerializer = svg::SVGSerializer;
-    using RouterSerializer = router::RouterSerializer;
+    DatabaseReader reader(in);
 
-    serialize::Database serialized_db;
-
-    serialized_db.ParseFromIstream(&in);
-
-    TransportCatalogue catalogue = TCSerializer
-                                 ::BuildDeserialized(serialized_db.catalogue());
+    TransportCatalogue catalogue = reader.ReadCatalogue();
 
-    RenderSettings render_settings = 
-              SVGSerializer::BuildDeserialized(serialized_db.render_settings());
+    RenderSettings render_settings = reader.ReadRenderSettings();
 
-    transport_router::TransportRouterInfo router_info =
-                RouterSerializer::BuildDeserialized(serialized_db.graph_info());
+    transport_router::TransportRouterInfo router_info = reader.ReadRouterInfo();
 
     return {
         std::move(catalogue),
@@ -74,6 +189,143 @@ Database DatabaseSerializer::Deserialize(std::istream &in) {
     };
 }
 
+DatabaseReader::DatabaseReader(std::istream& in)
+    : in_(in) {
+    const uint64_t toc_size = ReadHeader(in_);
+
+    // Sizes are checked before anything is allocated for them
+    const uint64_t remaining_size = GetRemainingSize(in_);
+    if (toc_size > remaining_size) {
+        throw std::runtime_error("Base file table of contents is truncated");
+    }
+
+    std::string serialized_toc(toc_size, '\0');
+
+    if (!in_.read(serialized_toc.data(), toc_size)) {
+        throw std::runtime_error("Base file table of contents is truncated");
+    }
+
+    serialize::TableOfContents toc;
+
+    if (!toc.ParseFromString(serialized_toc)) {
+        throw std::runtime_error("Base file table of contents is corrupted");
+    }
+
+    sections_begin_ = static_cast<std::streamoff>(HEADER_SIZE + toc_size);
+
+    const uint64_t sections_size = remaining_size - toc_size;
+
+    for (const serialize::Section& section : toc.sections()) {
+        if (section.offset() > sections_size 
+         || section.size() > sections_size - section.offset()) {
+            throw std::runtime_error("Base file section "
+                                     + serialize::SectionType_Name(section.type())
+                                     + " is truncated");
+        }
+
+        sections_[section.type()] = section;
+    }
+}
+
+std::string DatabaseReader::ReadSection(serialize::SectionType type) {
+    const auto section_iter = sections_.find(type);
+
+    if (section_iter == sections_.end()) {
+        throw std::runtime_error("Base file has no section of type "
+                                 + serialize::SectionType_Name(type));
+    }
+
+    const serialize::Section& section = section_iter->second;
+
+    std::string data(section.size(), '\0');
+
+    in_.clear();
+    in_.seekg(sections_begin_ + static_cast<std::streamoff>(section.offset()));
+
+    if (!in_.read(data.data(), section.size())) {
+        throw std::runtime_error("Base file section "
+                                 + serialize::SectionType_Name(type)
+                                 + " is truncated");
+    }
+
+    stats::AddCounter("base_bytes_read", data.size());
+
+    return data;
+}
+
+void DatabaseReader::ParseSection(serialize::SectionType type,
+                                  google::protobuf::MessageLite& message) {
+    if (!message.ParseFromString(ReadSection(type))) {
+        throw std::runtime_error("Base file section "
+                                 + serialize::SectionType_Name(type)
+                                 + " is corrupted");
+    }
+}
+
+DatabaseReader::TransportCatalogue DatabaseReader::ReadCatalogue() {
+    using TCSerializer = transport_catalogue::TransportCatalogueSerializer;
+
+    stats::ScopedTimer timer("read_catalogue");
+
+    serialize::TransportCatalogue serialized_catalogue;
+    ParseSection(serialize::CATALOGUE, serialized_catalogue);
+
+    return TCSerializer::BuildDeserialized(serialized_catalogue);
+}
+
+DatabaseReader::RenderSettings DatabaseReader::ReadRenderSettings() {
+    using SVGSerializer = svg::SVGSerializer;
+
+    stats::ScopedTimer timer("read_render_settings");
+
+    serialize::RenderSettings serialized_settings;
+    ParseSection(serialize::RENDER_SETTINGS, serialized_settings);
+
+    return SVGSerializer::BuildDeserialized(serialized_settings);
+}
+
+DatabaseReader::TransportRouterInfo DatabaseReader::ReadRouterInfo() {
+    using RouterSerializer = router::RouterSerializer;
+
+    stats::ScopedTimer timer("read_router_info");
+
+    serialize::GraphInfo serialized_graph;
+    ParseSection(serialize::GRAPH_INFO, serialized_graph);
+
+    return RouterSerializer::BuildDeserialized(serialized_graph);
+}
+
+DatabaseReader::RoutingSettings DatabaseReader::ReadRoutingSettings() {
+    using RouterSerializer = router::RouterSerializer;
+
+    if (sections_.count(serialize::ROUTING_SETTINGS) == 0) {
+        return ReadRouterInfo().GetRoutingSettings();
+    }
+
+    stats::ScopedTimer timer("read_routing_settings");
+
+    serialize::RoutingSettings serialized_settings;
+    ParseSection(serialize::ROUTING_SETTINGS, serialized_settings);
+
+    return RouterSerializer::BuildDeserializedRoutingSettings(serialized_settings);
+}
+
+std::optional<DatabaseReader::ContractionHierarchyData> 
+DatabaseReader::ReadContractionHierarchy() {
+    using RouterSerializer = router::RouterSerializer;
+
+    if (sections_.count(serialize::CONTRACTION_HIERARCHY) == 0) {
+        return std::nullopt;
+    }
+
+    stats::ScopedTimer timer("read_contraction_hierarchy");
+
+    serialize::ContractionHierarchy serialized_hierarchy;
+    ParseSection(serialize::CONTRACTION_HIERARCHY, serialized_hierarchy);
+
+    return RouterSerializer::BuildDeserializedHierarchy(serialized_hierarchy);
+}
+
 namespace tests {
 
 void TestDatabaseSerialization() {
@@ -137,6 +389,10 @@ void TestDatabaseSerialization() {
         tc.AddDistance(stop1.name, stop_name, distance);
     }
 
+    for (const auto& [stop_name, distance] : stop2.distances) {
+        tc.AddDistance(stop2.name, stop_name, distance);
+    }
+
     for (const auto& [stop_name, distance] : stop3.distances) {
         tc.AddDistance(stop3.name, stop_name, distance);
     }
@@ -153,6 +409,8 @@ void TestDatabaseSerialization() {
     rs.underlayer_color = ::svg::Rgba{ 255, 255, 255, 0.85 };
     rs.underlayer_width = 3;
     rs.color_palette = std::vector<::svg::Color>{ "green", ::svg::Rgb{ 255, 160, 0 }, "red" };
+    rs.route_simplification_tolerance = 1.5;
+    rs.coordinate_precision = 2;
 
     transport_router::RoutingSettings routing_settings {
         /* bus_wait_time: */  6,
@@ -230,6 +488,140 @@ void TestDatabaseSerialization() {
     bool test_color_palette = deserialized_rs.color_palette == std::vector<::svg::Color>{ "green", ::svg::Rgb{ 255, 160, 0 }, "red" };
     assert(test_color_palette);
 
+    bool test_tolerance = deserialized_rs.route_simplification_tolerance == 1.5;
+    assert(test_tolerance);
+
+    bool test_precision = deserialized_rs.coordinate_precision == 2;
+    assert(test_precision);
+
+    // A base can't carry a precision the JSON input would reject
+    using SVGSerializer = ::serialization::svg::SVGSerializer;
+    auto serialized_rs = SVGSerializer::BuildSerialized(rs);
+    serialized_rs.set_coordinate_precision(1000);
+    bool is_rejected = false;
+    try {
+        SVGSerializer::BuildDeserialized(serialized_rs);
+    } catch (const std::runtime_error&) {
+        is_rejected = true;
+    }
+    assert(is_rejected);
+}
+
+void TestDatabaseSections() {
+    using namespace std::literals;
+    using TransportCatalogue = ::transport_catalogue::TransportCatalogue;
+
+    TransportCatalogue tc;
+
+    tc.AddStop("Marushkino"sv, { 55.595884, 37.209755 });
+    tc.AddStop("Tolstopaltsevo"sv, { 55.611087, 37.208290 });
+    tc.AddDistance("Marushkino"sv, "Tolstopaltsevo"sv, 200);
+    tc.AddBus("256"sv, { "Marushkino"sv, "Tolstopaltsevo"sv }, false);
+
+    renderer::RenderSettings rs;
+    rs.width = 600;
+    rs.underlayer_color = ::svg::Rgb{ 255, 160, 0 };
+
+    transport_router::TransportRouter router(tc, { 6, 40 });
+
+    std::ostringstream output(std::ios::binary);
+    DatabaseSerializer::Serialize(tc, rs, router, output);
+
+    std::istringstream input(output.str(), std::ios::binary);
+    DatabaseReader reader(input);
+
+    // Sections can be read in any order and independently of each other
+    assert(reader.ReadRoutingSettings().bus_velocity == 40);
+    assert(reader.ReadRoutingSettings().bus_wait_time == 6);
+
+    transport_router::TransportRouterInfo router_info = reader.ReadRouterInfo();
+    assert(router_info.GetRoutingSettings().bus_velocity == 40);
+
+    TransportCatalogue deserialized_tc = reader.ReadCatalogue();
+    assert(deserialized_tc.GetStopNames() == tc.GetStopNames());
+    assert(deserialized_tc.GetDistance("Marushkino"sv, 
+                                       "Tolstopaltsevo"sv) == 200);
+
+    renderer::RenderSettings deserialized_rs = reader.ReadRenderSettings();
+    assert(deserialized_rs.width == 600);
+    assert(deserialized_rs.underlayer_color == ::svg::Rgb(255, 160, 0));
+
+    transport_router::TransportRouter deserialized_router(deserialized_tc, 
+                                                          router_info);
+    assert(deserialized_router.BuildRoute("Marushkino"sv, 
+                                          "Tolstopaltsevo"sv).has_value());
+
+    // Only bases of the routing settings that ask for it hold a hierarchy
+    assert(!reader.ReadContractionHierarchy().has_value());
+
+    transport_router::TransportRouter ch_router(tc, { 6, 40, true });
+    std::ostringstream ch_output(std::ios::binary);
+    DatabaseSerializer::Serialize(tc, rs, ch_router, ch_output);
+
+    std::istringstream ch_input(ch_output.str(), std::ios::binary);
+    DatabaseReader ch_reader(ch_input);
+
+    transport_router::TransportRouter restored_router(
+                                        tc, ch_reader.ReadRouterInfo());
+    assert(restored_router.GetRoutingSettings().contraction_hierarchy);
+
+    const auto hierarchy_data = ch_reader.ReadContractionHierarchy();
+    assert(hierarchy_data.has_value());
+    assert(hierarchy_data->ranks.size() 
+           == restored_router.GetRouteGraph().GetVertexCount());
+    restored_router.LoadContractionHierarchy(*hierarchy_data);
+
+    const auto ch_route = restored_router.BuildRoute("Marushkino"sv, 
+                                                     "Tolstopaltsevo"sv);
+    const auto expected = router.BuildRoute("Marushkino"sv, 
+                                            "Tolstopaltsevo"sv);
+    assert(ch_route.has_value() && expected.has_value());
+    assert(ch_route->total_time == expected->total_time);
+    assert(ch_route->items.size() == expected->items.size());
+
+    // A broken or foreign base has to be rejected rather than silently misread
+    auto is_rejected = [](const std::string& data) {
+        std::istringstream input(data, std::ios::binary);
+        try {
+            DatabaseReader broken_reader(input);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+
+    const std::string base = output.str();
+    assert(is_rejected(base.substr(0, 4)));
+    assert(is_rejected(base.substr(0, base.size() - 1)));
+    assert(is_rejected("{ \"base_requests\": [] }"s));
+
+    // A huge size of the table of contents mustn't be allocated
+    std::string huge_toc = base;
+    huge_toc[15] = '\x7F';
+    assert(is_rejected(huge_toc));
+
+    std::string future_version = base;
+    future_version[4] = 2;
+    assert(is_rejected(future_version));
+
+    // Sections filled with garbage are rejected when they are read
+    uint64_t toc_size = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+        toc_size |= uint64_t{ static_cast<unsigned char>(base[8 + i]) } << (8 * i);
+    }
+
+    std::string garbage = base;
+    std::fill(garbage.begin() + 16 + toc_size, garbage.end(), '\xFF');
+    std::istringstream garbage_input(garbage, std::ios::binary);
+    DatabaseReader garbage_reader(garbage_input);
+
+    bool is_corrupted = false;
+    try {
+        garbage_reader.ReadCatalogue();
+    } catch (const std::runtime_error&) {
+        is_corrupted = true;
+    }
+    assert(is_corrupted);
 }
 
 }
@@ -289,6 +681,50 @@ RouterSerializer::TransportRouterInfo RouterSerializer::BuildDeserialized(
     return router_info;
 }
 
+serialize::ContractionHierarchy RouterSerializer::BuildSerializedHierarchy(
+                                        const ContractionHierarchy& hierarchy,
+                                        size_t vertex_count) {
+    serialize::ContractionHierarchy serialized_hierarchy;
+
+    for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        serialized_hierarchy.add_ranks(hierarchy.GetRank(vertex));
+    }
+
+    for (size_t i = 0; i < hierarchy.GetShortcutCount(); ++i) {
+        const ContractionHierarchy::Shortcut& shortcut = hierarchy.GetShortcut(i);
+        serialize::ContractionShortcut& serialized_shortcut = 
+                                        *serialized_hierarchy.add_shortcuts();
+
+        serialized_shortcut.set_from_id(shortcut.from);
+        serialized_shortcut.set_to_id(shortcut.to);
+        serialized_shortcut.set_weight(shortcut.weight);
+        serialized_shortcut.set_first_edge(shortcut.first);
+        serialized_shortcut.set_second_edge(shortcut.second);
+    }
+
+    return serialized_hierarchy;
+}
+
+RouterSerializer::ContractionHierarchy::Data 
+RouterSerializer::BuildDeserializedHierarchy(
+                const serialize::ContractionHierarchy& serialized_hierarchy) {
+    ContractionHierarchy::Data data;
+
+    data.ranks.assign(serialized_hierarchy.ranks().begin(), 
+                      serialized_hierarchy.ranks().end());
+
+    data.shortcuts.reserve(serialized_hierarchy.shortcuts_size());
+    for (const auto& serialized_shortcut : serialized_hierarchy.shortcuts()) {
+        data.shortcuts.push_back({ serialized_shortcut.from_id(),
+                                   serialized_shortcut.to_id(),
+                                   serialized_shortcut.weight(),
+                                   serialized_shortcut.first_edge(),
+                                   serialized_shortcut.second_edge() });
+    }
+
+    return data;
+}
+
 serialize::EdgeInfo RouterSerializer::BuildSerializedEdgeInfo(
                             const TransportRouterInfo::EdgeInfo& edge_info) {
     serialize::EdgeInfo serialized_edge;
@@ -343,6 +779,8 @@ serialize::RoutingSettings RouterSerializer::BuildSerializedRoutingSettings(
 
     serialized_settings.set_bus_velocity(settings.bus_velocity);
     serialized_settings.set_bus_wait_time(settings.bus_wait_time);
+    serialized_settings.set_contraction_hierarchy(settings.contraction_hierarchy);
+    serialized_settings.set_a_star(settings.a_star);
 
     return serialized_settings;
 }
@@ -352,7 +790,9 @@ RouterSerializer::BuildDeserializedRoutingSettings(
                         const serialize::RoutingSettings& serialized_settings) {
     return RoutingSettings {
         serialized_settings.bus_wait_time(),
-        serialized_settings.bus_velocity()
+        serialized_settings.bus_velocity(),
+        serialized_settings.contraction_hierarchy(),
+        serialized_settings.a_star()
     };
 }
 
@@ -387,6 +827,13 @@ serialize::RenderSettings SVGSerializer::BuildSerialized(
                              BuildSerializedColor(color);
     }
 
+    serialized_settings.set_route_simplification_tolerance(
+                        render_settings.route_simplification_tolerance);
+    if (render_settings.coordinate_precision) {
+        serialized_settings.set_coordinate_precision(
+                        *render_settings.coordinate_precision);
+    }
+
     return serialized_settings;
 }
 
@@ -469,6 +916,17 @@ SVGSerializer::RenderSettings SVGSerializer::BuildDeserialized(
                                 std::move(DeserializeColor(serialized_color)));
     }   
 
+    settings.route_simplification_tolerance = 
+                    serialized_settings.route_simplification_tolerance();
+    if (serialized_settings.has_coordinate_precision()) {
+        settings.coordinate_precision = 
+                    serialized_settings.coordinate_precision();
+        if (*settings.coordinate_precision < 0 
+         || *settings.coordinate_precision > RenderSettings::MAX_COORDINATE_PRECISION) {
+            throw std::runtime_error("Base file coordinate precision is out of range");
+        }
+    }
+
     return settings;
 }
 
@@ -509,6 +967,183 @@ SVGSerializer::RenderSettings SVGSerializer::Deserialize(std::istream &in) {
     return BuildDeserialized(serialized_settings);
 }
 
+int32_t MapGeometrySerializer::Quantize(double value) {
+    return static_cast<int32_t>(std::lround(value * SCALE));
+}
+
+void MapGeometrySerializer::AddCoords(
+                        google::protobuf::RepeatedField<int32_t>* coords,
+                        std::vector<::svg::Point>::const_iterator first,
+                        std::vector<::svg::Point>::const_iterator last) {
+    // Deltas are taken between quantized values, so errors don't add up
+    int32_t prev_x = 0;
+    int32_t prev_y = 0;
+
+    coords->Reserve(coords->size() + 2 * static_cast<int>(last - first));
+    for (; first != last; ++first) {
+        const int32_t x = Quantize(first->x);
+        const int32_t y = Quantize(first->y);
+        coords->Add(x - prev_x);
+        coords->Add(y - prev_y);
+        prev_x = x;
+        prev_y = y;
+    }
+}
+
+serialize::MapGeometry MapGeometrySerializer::BuildSerialized(
+                        const MapRenderer& renderer, const MapLayout& layout,
+                        const MapSelection& selection, 
+                        std::optional<ViewBox> view_box) {
+    serialize::MapGeometry geometry;
+
+    geometry.set_scale(SCALE);
+    *geometry.mutable_render_settings() = 
+                        SVGSerializer::BuildSerialized(renderer.render_settings);
+
+    const ::svg::Color* palette = renderer.render_settings.color_palette.data();
+
+    std::vector<::svg::Point> buffer;
+    for (const MapSelection::RouteRun& run : selection.route_runs) {
+        const auto [first, last] = 
+                        MapRenderer::GetRouteRunPoints(layout, run, buffer);
+
+        serialize::RouteLine& line = *geometry.add_route_lines();
+        line.set_color_index(layout.bus_colors[run.bus_index] - palette);
+        AddCoords(line.mutable_coords(), first, last);
+    }
+
+    for (const auto& [bus_index, point_index] : selection.route_labels) {
+        const ::svg::Point& point = layout.bus_points[bus_index][point_index];
+
+        serialize::RouteLabel& label = *geometry.add_route_labels();
+        label.set_bus_name(std::string(layout.buses[bus_index]->name));
+        label.set_color_index(layout.bus_colors[bus_index] - palette);
+        label.set_x(Quantize(point.x));
+        label.set_y(Quantize(point.y));
+    }
+
+    // Stops go in one sequence, so they are delta-encoded as a whole
+    std::vector<::svg::Point> stop_points;
+    stop_points.reserve(selection.stops.size());
+    for (const size_t stop : selection.stops) {
+        geometry.add_stop_names(std::string(layout.stops[stop]->name));
+        stop_points.push_back(layout.stop_points[stop]);
+    }
+    AddCoords(geometry.mutable_stop_coords(), stop_points.begin(), 
+                                              stop_points.end());
+
+    if (view_box) {
+        geometry.mutable_view_box_origin()->set_x(view_box->x);
+        geometry.mutable_view_box_origin()->set_y(view_box->y);
+        geometry.mutable_view_box_size()->set_x(view_box->width);
+        geometry.mutable_view_box_size()->set_y(view_box->height);
+    }
+
+    return geometry;
+}
+
+void MapGeometrySerializer::Serialize(const MapRenderer& renderer, 
+                                      const MapLayout& layout,
+                                      const MapSelection& selection, 
+                                      std::optional<ViewBox> view_box, 
+                                      std::ostream& out) {
+    BuildSerialized(renderer, layout, selection, view_box)
+                                                    .SerializeToOstream(&out);
+}
+
+namespace tests {
+
+void TestMapGeometry() {
+    using namespace std::literals;
+    using MapRenderer = renderer::MapRenderer;
+
+    ::transport_catalogue::TransportCatalogue tc;
+
+    tc.AddStop("Marushkino"sv, { 55.595884, 37.209755 });
+    tc.AddStop("Tolstopaltsevo"sv, { 55.611087, 37.208290 });
+    tc.AddStop("Biryusinka"sv, { 55.581065, 37.648390 });
+    tc.AddStop("Rasskazovka"sv, { 55.632761, 37.333324 });
+
+    tc.AddBus("11"sv, { "Marushkino"sv, "Tolstopaltsevo"sv, "Marushkino"sv });
+    tc.AddBus("256"sv, { "Biryusinka"sv, "Rasskazovka"sv, "Biryusinka"sv });
+    tc.AddBus("47"sv, { "Rasskazovka"sv, "Marushkino"sv, "Rasskazovka"sv }, true);
+
+    renderer::RenderSettings rs;
+    rs.width = 600;
+    rs.height = 400;
+    rs.padding = 50;
+    rs.stop_radius = 5;
+    rs.line_width = 14;
+    rs.bus_label_font_size = 20;
+    rs.bus_label_offset = ::svg::Point{ 7, 15 };
+    rs.stop_label_font_size = 20;
+    rs.stop_label_offset = ::svg::Point{ 7, -3 };
+    rs.underlayer_color = ::svg::Rgba{ 255, 255, 255, 0.85 };
+    rs.underlayer_width = 3;
+    rs.color_palette = std::vector<::svg::Color>{ "green", ::svg::Rgb{ 255, 160, 0 } };
+
+    const MapRenderer renderer(rs);
+    const MapRenderer::MapLayout layout = renderer.MakeMapLayout(tc);
+    const MapRenderer::MapSelection selection = MapRenderer::SelectWholeMap(layout);
+
+    std::ostringstream out;
+    MapGeometrySerializer::Serialize(renderer, layout, selection, 
+                                     std::nullopt, out);
+
+    serialize::MapGeometry geometry;
+    const bool is_parsed = geometry.ParseFromString(out.str());
+    assert(is_parsed);
+    assert(geometry.scale() == MapGeometrySerializer::SCALE);
+    assert(geometry.render_settings().color_palette_size() == 2);
+    assert(!geometry.has_view_box_origin());
+
+    // Decoded points are the layout points up to the quantization step
+    const auto is_near = [](double value, int32_t quantized) {
+        return std::abs(value - quantized / double(MapGeometrySerializer::SCALE)) 
+               <= 0.5 / MapGeometrySerializer::SCALE;
+    };
+
+    assert(geometry.route_lines_size() == 3);
+    for (int i = 0; i < geometry.route_lines_size(); ++i) {
+        const serialize::RouteLine& line = geometry.route_lines(i);
+        const std::vector<::svg::Point>& points = layout.bus_points[i];
+
+        assert(line.color_index() == static_cast<uint32_t>(i % 2));
+        assert(line.coords_size() == 2 * static_cast<int>(points.size()));
+
+        int32_t x = 0;
+        int32_t y = 0;
+        for (size_t j = 0; j < points.size(); ++j) {
+            x += line.coords(2 * j);
+            y += line.coords(2 * j + 1);
+            assert(is_near(points[j].x, x) && is_near(points[j].y, y));
+        }
+    }
+
+    assert(geometry.route_labels_size() == 5);
+    assert(geometry.route_labels(0).bus_name() == "11"s);
+    assert(geometry.route_labels(4).bus_name() == "47"s);
+    assert(geometry.route_labels(4).color_index() == 0);
+
+    assert(geometry.stop_names_size() == 4);
+    assert(geometry.stop_names(0) == "Biryusinka"s);
+    assert(geometry.stop_coords_size() == 8);
+
+    // A viewport is kept along with its part of the map
+    serialize::MapGeometry part = MapGeometrySerializer::BuildSerialized(
+                                renderer, layout, MapRenderer::MapSelection{}, 
+                                ::svg::ViewBox{ 10, 20, 30, 40 });
+    assert(part.route_lines_size() == 0 && part.stop_names_size() == 0);
+    assert(part.view_box_origin().y() == 20 && part.view_box_size().x() == 30);
+
+    // The message is a fraction of the svg-document
+    std::ostringstream svg_out;
+    renderer.RenderMap(layout, selection, svg_out);
+    assert(out.str().size() * 4 < svg_out.str().size());
+}
+
+} // namespace serialization::svg::tests
+
 }
 
 namespace transport_catalogue {
@@ -544,11 +1179,11 @@ std::vector<domain::StopPtr> TransportCatalogueSerializer::GetStopPtrs(
 
 size_t TransportCatalogueSerializer::GetStopIndex(
                     const std::vector<domain::StopPtr>& stop_ptrs,
-                    const std::string& stop_name) {
+                    std::string_view stop_name) {
     auto stop_iter = std::lower_bound(stop_ptrs.begin(),
                                       stop_ptrs.end(), 
                                       stop_name,
-    [](const domain::StopPtr val, const std::string& stop_name) {
+    [](const domain::StopPtr val, std::string_view stop_name) {
         return val->name < stop_name;
     });
 
@@ -560,7 +1195,7 @@ serialize::Bus TransportCatalogueSerializer::BuildSerializedBus(
                                 const std::vector<domain::StopPtr> stop_ptrs) {
     serialize::Bus serialized_bus;
 
-    serialized_bus.set_name(bus.name);
+    serialized_bus.set_name(std::string(bus.name));
     serialized_bus.set_is_roundtrip(bus.is_roundtrip);
     
     for (const domain::StopPtr stop_ptr : bus.route) {
@@ -578,7 +1213,7 @@ serialize::Stop TransportCatalogueSerializer::BuildSerializedStop(
     serialized_coords.set_lat(stop.coordinates.lat);
     serialized_coords.set_lng(stop.coordinates.lng);
 
-    serialized_stop.set_name(stop.name);
+    serialized_stop.set_name(std::string(stop.name));
     *serialized_stop.mutable_coordinates() = serialized_coords;
 
     return serialized_stop;
@@ -2,12 +2,17 @@
 #include "transport_catalogue.pb.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
+#include "map_geometry.pb.h"
 #include "map_renderer.pb.h"
 #include "map_renderer.h"
 #include "graph.pb.h"
 
+#include <cstdint>
 #include <filesystem>
 #include <istream>
+#include <map>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace serialization {
@@ -25,6 +30,11 @@ struct Database {
     transport_router::TransportRouterInfo router_info;
 };
 
+/* The base file is split into sections: a fixed-size header holding the size
+ * of the table of contents, the table of contents itself and then catalogue,
+ * render settings and graph sections, followed by the contraction hierarchy
+ * if the routing settings ask for one. Section offsets are counted from the
+ * end of the table of contents, so each section can be read on its own */
 class DatabaseSerializer {
 public:
     using RenderSettings     = renderer::RenderSettings;
@@ -37,6 +47,7 @@ public:
                           const TransportRouter& router,
                           std::ostream& out);
 
+    // Reads every section of the base at once
     static Database Deserialize(std::istream& in);
 
     static SerializedDatabase BuildSerialized(
@@ -45,10 +56,55 @@ public:
                           const TransportRouter& router);
 };
 
+/* Reads the table of contents of a sectioned base up front and parses 
+ * each section only when it is asked for */
+class DatabaseReader {
+public:
+    using RenderSettings      = renderer::RenderSettings;
+    using TransportCatalogue  = transport_catalogue::TransportCatalogue;
+    using TransportRouterInfo = transport_router::TransportRouterInfo;
+    using RoutingSettings     = transport_router::RoutingSettings;
+    using ContractionHierarchyData = 
+                transport_router::TransportRouter::ContractionHierarchy::Data;
+
+    // The stream must outlive the reader
+    explicit DatabaseReader(std::istream& in);
+
+    TransportCatalogue ReadCatalogue();
+
+    RenderSettings ReadRenderSettings();
+
+    TransportRouterInfo ReadRouterInfo();
+
+    /* Reads only the routing settings, without the graph. Bases made before
+     * the settings got a section of their own take them from the graph */
+    RoutingSettings ReadRoutingSettings();
+
+    // Bases made without a contraction hierarchy have none
+    std::optional<ContractionHierarchyData> ReadContractionHierarchy();
+
+private:
+    // Reads raw bytes of a given section
+    std::string ReadSection(serialize::SectionType type);
+
+    // Parses a given section into the message, throws if it is corrupted
+    void ParseSection(serialize::SectionType type,
+                      google::protobuf::MessageLite& message);
+
+    std::istream& in_;
+
+    // Position of the first section in the stream
+    std::streamoff sections_begin_ = 0;
+
+    std::map<serialize::SectionType, serialize::Section> sections_;
+};
+
 namespace tests {
 
 void TestDatabaseSerialization();
 
+void TestDatabaseSections();
+
 }
 
 }
@@ -63,6 +119,7 @@ public:
     using TransportRouter = transport_router::TransportRouter;
     using RoutingSettings = transport_router::RoutingSettings;
     using TransportRouterInfo = transport_router::TransportRouterInfo;
+    using ContractionHierarchy = TransportRouter::ContractionHierarchy;
 
     static void Serialize(const TransportRouter& router, std::ostream& out);
 
@@ -71,6 +128,19 @@ public:
     static serialize::GraphInfo BuildSerialized(const TransportRouter& router);
 
     static TransportRouterInfo BuildDeserialized(const serialize::GraphInfo& serialized_graph);
+
+    static serialize::ContractionHierarchy BuildSerializedHierarchy(
+                                        const ContractionHierarchy& hierarchy,
+                                        size_t vertex_count);
+
+    static ContractionHierarchy::Data BuildDeserializedHierarchy(
+                    const serialize::ContractionHierarchy& serialized_hierarchy);
+
+    static serialize::RoutingSettings BuildSerializedRoutingSettings(
+                          const RoutingSettings& settings);
+    static RoutingSettings BuildDeserializedRoutingSettings(
+                          const serialize::RoutingSettings& serialized_settings);
+
 private:
     static serialize::EdgeInfo BuildSerializedEdgeInfo(
                                 const TransportRouterInfo::EdgeInfo& edge_info);
@@ -80,10 +150,6 @@ private:
                                     const serialize::EdgeInfo& serialized_edge);
     static TransportRouterInfo::VertexInfo BuildDeserializedVertexInfo(
                                     const serialize::VertexInfo& serialized_vtx);
-    static serialize::RoutingSettings BuildSerializedRoutingSettings(
-                          const RoutingSettings& settings);
-    static RoutingSettings BuildDeserializedRoutingSettings(
-                          const serialize::RoutingSettings& serialized_settings);
 
 };
 
@@ -119,6 +185,44 @@ private:
 
 };
 
+/* Writes a selected part of a map layout as a MapGeometry message, which 
+ * is a compact alternative to the svg-document of the same part */
+class MapGeometrySerializer {
+public:
+    using MapRenderer  = renderer::MapRenderer;
+    using MapLayout    = renderer::MapRenderer::MapLayout;
+    using MapSelection = renderer::MapRenderer::MapSelection;
+    using ViewBox      = ::svg::ViewBox;
+
+    // Coordinates are kept with the precision of 1 / SCALE
+    static constexpr uint32_t SCALE = 10;
+
+    // The layout has to be made by the given renderer
+    static void Serialize(const MapRenderer& renderer, const MapLayout& layout,
+                          const MapSelection& selection, 
+                          std::optional<ViewBox> view_box, std::ostream& out);
+
+    static serialize::MapGeometry BuildSerialized(
+                          const MapRenderer& renderer, const MapLayout& layout,
+                          const MapSelection& selection, 
+                          std::optional<ViewBox> view_box);
+
+private:
+    static int32_t Quantize(double value);
+
+    // Adds points [first, last) delta-encoded
+    static void AddCoords(google::protobuf::RepeatedField<int32_t>* coords,
+                          std::vector<::svg::Point>::const_iterator first,
+                          std::vector<::svg::Point>::const_iterator last);
+
+};
+
+namespace tests {
+
+void TestMapGeometry();
+
+} // namespace serialization::svg::tests
+
 }
 
 namespace transport_catalogue {
@@ -170,7 +274,7 @@ private:
                     const std::vector<domain::StopPtr>& stop_ptrs);
 
     static size_t GetStopIndex(const std::vector<domain::StopPtr>& stop_ptrs, 
-                               const std::string& stop_name);
+                               std::string_view stop_name);
 };
 
 } // namespace serialization::transport_catalogue
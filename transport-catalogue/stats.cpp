@@ -0,0 +1,486 @@
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json_builder.h"
+#include "stats.h"
+#include "json.h"
+
+namespace stats {
+
+using namespace std::literals;
+
+namespace {
+
+double ToMilliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Counters outgrow int on big bases, such numbers are printed as doubles
+json::Node MakeCountNode(uint64_t value) {
+    if (value <= static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+        return static_cast<int>(value);
+    }
+    return static_cast<double>(value);
+}
+
+struct Phase {
+    Clock::duration total{};
+    uint64_t calls = 0;
+};
+
+/* Latencies of one query type in nanoseconds, HDR style. Values below
+ * SUB_BUCKET_COUNT are counted exactly, every further power of two is split
+ * into HALF_COUNT equal buckets, so a bucket is within 1/HALF_COUNT of the
+ * values in it at any scale */
+class Histogram {
+public:
+    void Add(Clock::duration duration) {
+        const uint64_t value = static_cast<uint64_t>(std::max<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), 0));
+
+        const size_t bucket = GetBucket(value);
+        if (bucket >= buckets_.size()) {
+            buckets_.resize(bucket + 1, 0);
+        }
+        ++buckets_[bucket];
+
+        min_ = count_ == 0 ? value : std::min(min_, value);
+        max_ = std::max(max_, value);
+        total_ += value;
+        ++count_;
+    }
+
+    uint64_t GetCount() const {
+        return count_;
+    }
+
+    // Sum of the values in nanoseconds
+    uint64_t GetTotal() const {
+        return total_;
+    }
+
+    uint64_t GetMax() const {
+        return max_;
+    }
+
+    /* Highest value of the bucket the nearest-rank percentile falls into.
+     * Is never more than the recorded maximum */
+    uint64_t GetPercentile(double share) const {
+        const uint64_t rank = std::max<uint64_t>(
+            1, static_cast<uint64_t>(std::ceil(share * count_)));
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets_.size(); ++i) {
+            seen += buckets_[i];
+            if (seen >= rank) {
+                return std::min(GetBucketEnd(i) - 1, max_);
+            }
+        }
+        return max_;
+    }
+
+    // Number of values below the bound, which has to be a power of two
+    uint64_t CountBelow(uint64_t bound) const {
+        uint64_t count = 0;
+        for (size_t i = 0; i < buckets_.size() && GetBucketEnd(i) <= bound; ++i) {
+            count += buckets_[i];
+        }
+        return count;
+    }
+
+    json::Node Build() const {
+        const auto to_microseconds = [](uint64_t nanoseconds) {
+            return nanoseconds / 1000.0;
+        };
+
+        return json::Builder{}.StartDict()
+            .Key("count"s).Value(MakeCountNode(count_))
+            .Key("total_ms"s).Value(total_ / 1e6)
+            .Key("mean_us"s).Value(count_ == 0 ? 0.0
+                                               : to_microseconds(total_) / count_)
+            .Key("min_us"s).Value(to_microseconds(min_))
+            .Key("p50_us"s).Value(to_microseconds(GetPercentile(0.5)))
+            .Key("p90_us"s).Value(to_microseconds(GetPercentile(0.9)))
+            .Key("p99_us"s).Value(to_microseconds(GetPercentile(0.99)))
+            .Key("p999_us"s).Value(to_microseconds(GetPercentile(0.999)))
+            .Key("max_us"s).Value(to_microseconds(max_))
+        .EndDict().Build();
+    }
+
+private:
+    static constexpr size_t SUB_BUCKET_BITS = 5;
+    static constexpr uint64_t SUB_BUCKET_COUNT = uint64_t{1} << SUB_BUCKET_BITS;
+    static constexpr uint64_t HALF_COUNT = SUB_BUCKET_COUNT / 2;
+
+    static size_t GetBucket(uint64_t value) {
+        if (value < SUB_BUCKET_COUNT) {
+            return static_cast<size_t>(value);
+        }
+
+        size_t shift = 0;
+        while ((value >> shift) >= SUB_BUCKET_COUNT) {
+            ++shift;
+        }
+        return static_cast<size_t>(SUB_BUCKET_COUNT + (shift - 1) * HALF_COUNT
+                                   + ((value >> shift) - HALF_COUNT));
+    }
+
+    // The value right after the bucket
+    static uint64_t GetBucketEnd(size_t bucket) {
+        if (bucket < SUB_BUCKET_COUNT) {
+            return bucket + 1;
+        }
+
+        const size_t shift = (bucket - SUB_BUCKET_COUNT) / HALF_COUNT + 1;
+        const uint64_t top = (bucket - SUB_BUCKET_COUNT) % HALF_COUNT + HALF_COUNT;
+        return (top + 1) << shift;
+    }
+
+    std::vector<uint64_t> buckets_;
+
+    uint64_t count_ = 0;
+
+    uint64_t total_ = 0;
+
+    uint64_t min_ = 0;
+
+    uint64_t max_ = 0;
+};
+
+// Everything collected. Phases may be timed on several threads at once
+struct Registry {
+    std::mutex mutex;
+
+    std::map<std::string, Phase, std::less<>> phases;
+
+    std::map<std::string, uint64_t, std::less<>> counters;
+
+    std::map<std::string, Histogram, std::less<>> latencies;
+
+    std::map<std::string, uint64_t, std::less<>> slow_query_counts;
+
+    // Is null unless slow queries are logged
+    std::ostream* slow_query_log = nullptr;
+
+    Clock::duration slow_query_threshold{};
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+// Returns the value under the key, adding a default one if there is none
+template <typename Map>
+typename Map::mapped_type& GetOrAdd(Map& map, std::string_view key) {
+    auto iter = map.find(key);
+    if (iter == map.end()) {
+        iter = map.emplace(std::string(key), typename Map::mapped_type{}).first;
+    }
+    return iter->second;
+}
+
+} // namespace
+
+namespace detail {
+
+void AddPhase(std::string_view phase, Clock::duration duration) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    Phase& stats = GetOrAdd(registry.phases, phase);
+    stats.total += duration;
+    ++stats.calls;
+}
+
+void AddCounter(std::string_view counter, uint64_t value) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    GetOrAdd(registry.counters, counter) += value;
+}
+
+void AddLatency(std::string_view type, Clock::duration duration) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    GetOrAdd(registry.latencies, type).Add(duration);
+}
+
+bool IsSlowQuery(Clock::duration duration) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    return registry.slow_query_log != nullptr
+        && duration > registry.slow_query_threshold;
+}
+
+void AddSlowQuery(std::string_view type, Clock::duration duration,
+                  json::Dict details) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    ++GetOrAdd(registry.slow_query_counts, type);
+
+    if (registry.slow_query_log != nullptr) {
+        details["type"s] = std::string(type);
+        details["ms"s] = ToMilliseconds(duration);
+
+        json::Print(json::Document{ std::move(details) }, *registry.slow_query_log);
+        *registry.slow_query_log << '\n';
+    }
+}
+
+} // namespace stats::detail
+
+void Enable() {
+    detail::is_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Reset() {
+    detail::is_enabled.store(false, std::memory_order_relaxed);
+
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    registry.phases.clear();
+    registry.counters.clear();
+    registry.latencies.clear();
+    registry.slow_query_counts.clear();
+    registry.slow_query_log = nullptr;
+    registry.slow_query_threshold = {};
+}
+
+void EnableSlowQueryLog(Clock::duration threshold, std::ostream& log) {
+    Enable();
+
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    registry.slow_query_log = &log;
+    registry.slow_query_threshold = threshold;
+}
+
+void Print(std::ostream& out) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    json::Dict phases;
+    for (const auto& [name, phase] : registry.phases) {
+        phases[name] = json::Builder{}.StartDict()
+            .Key("calls"s).Value(MakeCountNode(phase.calls))
+            .Key("ms"s).Value(ToMilliseconds(phase.total))
+        .EndDict().Build();
+    }
+
+    json::Dict counters;
+    for (const auto& [name, value] : registry.counters) {
+        counters[name] = MakeCountNode(value);
+    }
+
+    json::Dict queries;
+    for (const auto& [type, histogram] : registry.latencies) {
+        queries[type] = histogram.Build();
+    }
+
+    json::Dict slow_queries;
+    for (const auto& [type, count] : registry.slow_query_counts) {
+        slow_queries[type] = MakeCountNode(count);
+    }
+
+    json::Print(json::Document{ json::Builder{}.StartDict()
+        .Key("phases"s).Value(std::move(phases))
+        .Key("counters"s).Value(std::move(counters))
+        .Key("queries"s).Value(std::move(queries))
+        .Key("slow_queries"s).Value(std::move(slow_queries))
+    .EndDict().Build() }, out);
+    out << '\n';
+}
+
+void PrintPrometheus(std::ostream& out) {
+    constexpr std::string_view PREFIX = "transport_catalogue_"sv;
+
+    // Bucket bounds of the query histograms start at about a microsecond
+    constexpr uint64_t MIN_BOUND = uint64_t{1} << 10;
+
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    const auto print_seconds = [&out](double seconds) {
+        std::ostringstream number;
+        number.precision(9);
+        number << seconds;
+        out << number.str();
+    };
+
+    out << "# HELP "sv << PREFIX << "phase_duration_seconds "sv
+        << "Total duration of a phase of the run\n"sv
+        << "# TYPE "sv << PREFIX << "phase_duration_seconds gauge\n"sv;
+    for (const auto& [name, phase] : registry.phases) {
+        out << PREFIX << "phase_duration_seconds{phase=\""sv << name << "\"} "sv;
+        print_seconds(std::chrono::duration<double>(phase.total).count());
+        out << '\n';
+    }
+
+    out << "# HELP "sv << PREFIX << "phase_calls Times a phase was run\n"sv
+        << "# TYPE "sv << PREFIX << "phase_calls gauge\n"sv;
+    for (const auto& [name, phase] : registry.phases) {
+        out << PREFIX << "phase_calls{phase=\""sv << name << "\"} "sv
+            << phase.calls << '\n';
+    }
+
+    for (const auto& [name, value] : registry.counters) {
+        out << "# TYPE "sv << PREFIX << name << " gauge\n"sv
+            << PREFIX << name << ' ' << value << '\n';
+    }
+
+    out << "# HELP "sv << PREFIX << "query_duration_seconds "sv
+        << "Duration of stat requests by type\n"sv
+        << "# TYPE "sv << PREFIX << "query_duration_seconds histogram\n"sv;
+    for (const auto& [type, histogram] : registry.latencies) {
+        for (uint64_t bound = MIN_BOUND; ; bound *= 2) {
+            out << PREFIX << "query_duration_seconds_bucket{type=\""sv << type
+                << "\",le=\""sv;
+            print_seconds(bound / 1e9);
+            out << "\"} "sv << histogram.CountBelow(bound) << '\n';
+
+            if (bound > histogram.GetMax()) {
+                break;
+            }
+        }
+        out << PREFIX << "query_duration_seconds_bucket{type=\""sv << type
+            << "\",le=\"+Inf\"} "sv << histogram.GetCount() << '\n'
+            << PREFIX << "query_duration_seconds_sum{type=\""sv << type << "\"} "sv;
+        print_seconds(histogram.GetTotal() / 1e9);
+        out << '\n' << PREFIX << "query_duration_seconds_count{type=\""sv << type
+            << "\"} "sv << histogram.GetCount() << '\n';
+    }
+
+    out << "# HELP "sv << PREFIX << "slow_queries_total "sv
+        << "Stat requests slower than the threshold by type\n"sv
+        << "# TYPE "sv << PREFIX << "slow_queries_total counter\n"sv;
+    for (const auto& [type, count] : registry.slow_query_counts) {
+        out << PREFIX << "slow_queries_total{type=\""sv << type << "\"} "sv
+            << count << '\n';
+    }
+}
+
+namespace tests {
+
+void TestStats() {
+    Reset();
+
+    // Nothing is collected while disabled
+    {
+        ScopedTimer timer("disabled"sv);
+        AddCounter("disabled"sv, 1);
+    }
+
+    Enable();
+    AddPhase("load"sv, std::chrono::milliseconds(2));
+    AddPhase("load"sv, std::chrono::milliseconds(3));
+    AddCounter("bytes"sv, 10);
+    AddCounter("bytes"sv, 5);
+    AddCounter("huge"sv, uint64_t{1} << 40);
+    AddLatency("Route"sv, std::chrono::nanoseconds(500));
+    AddLatency("Route"sv, std::chrono::microseconds(3));
+    AddLatency("Route"sv, std::chrono::microseconds(3));
+    {
+        ScopedTimer timer("Stop"sv, ScopedTimer::Target::LATENCY);
+    }
+
+    // Phases are added from several threads at once
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([]() {
+            for (int j = 0; j < 100; ++j) {
+                ScopedTimer timer("parallel"sv);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::stringstream out;
+    Print(out);
+    const json::Dict root = json::Load(out).GetRoot().AsMap();
+
+    const json::Dict& phases = root.at("phases"s).AsMap();
+    assert(phases.count("disabled"s) == 0);
+    assert(phases.at("load"s).AsMap().at("calls"s).AsInt() == 2);
+    assert(std::abs(phases.at("load"s).AsMap().at("ms"s).AsDouble() - 5) < 1e-9);
+    assert(phases.at("parallel"s).AsMap().at("calls"s).AsInt() == 400);
+
+    const json::Dict& counters = root.at("counters"s).AsMap();
+    assert(counters.count("disabled"s) == 0);
+    assert(counters.at("bytes"s).AsInt() == 15);
+    const double huge = static_cast<double>(uint64_t{1} << 40);
+    assert(std::abs(counters.at("huge"s).AsDouble() - huge) / huge < 1e-5);
+
+    const json::Dict& route = root.at("queries"s).AsMap().at("Route"s).AsMap();
+    assert(route.at("count"s).AsInt() == 3);
+    assert(std::abs(route.at("min_us"s).AsDouble() - 0.5) < 1e-9);
+    assert(std::abs(route.at("p50_us"s).AsDouble() - 3) < 1e-9);
+    assert(std::abs(route.at("max_us"s).AsDouble() - 3) < 1e-9);
+
+    assert(root.at("queries"s).AsMap().at("Stop"s).AsMap().at("count"s).AsInt() == 1);
+
+    // Percentiles are within the bucket precision at any scale
+    for (int i = 1; i <= 1000; ++i) {
+        AddLatency("Map"sv, std::chrono::microseconds(i));
+        AddLatency("Map"sv, std::chrono::seconds(i));
+    }
+    out = std::stringstream{};
+    Print(out);
+    const json::Dict map = json::Load(out).GetRoot().AsMap()
+                               .at("queries"s).AsMap().at("Map"s).AsMap();
+    assert(std::abs(map.at("p50_us"s).AsDouble() - 1000) / 1000 < 1.0 / 16);
+    assert(std::abs(map.at("p90_us"s).AsDouble() - 8e8) / 8e8 < 1.0 / 16);
+
+    // Only queries above the threshold are logged and detailed
+    std::stringstream log;
+    EnableSlowQueryLog(std::chrono::milliseconds(1), log);
+    AddQuery("Route"sv, std::chrono::milliseconds(2), []() {
+        return json::Dict{ { "id"s, 7 }, { "from"s, "A"s } };
+    });
+    AddQuery("Route"sv, std::chrono::microseconds(500), []() {
+        assert(false);
+        return json::Dict{};
+    });
+
+    const json::Dict logged = json::Load(log).GetRoot().AsMap();
+    assert(logged.at("id"s).AsInt() == 7);
+    assert(logged.at("from"s).AsString() == "A"s);
+    assert(logged.at("type"s).AsString() == "Route"s);
+    assert(std::abs(logged.at("ms"s).AsDouble() - 2) < 1e-9);
+
+    std::ostringstream prometheus;
+    PrintPrometheus(prometheus);
+    const std::string text = prometheus.str();
+    assert(text.find("transport_catalogue_query_duration_seconds_count"
+                     "{type=\"Route\"} 5\n"s) != std::string::npos);
+    assert(text.find("transport_catalogue_query_duration_seconds_bucket"
+                     "{type=\"Route\",le=\"+Inf\"} 5\n"s) != std::string::npos);
+    assert(text.find("transport_catalogue_slow_queries_total"
+                     "{type=\"Route\"} 1\n"s) != std::string::npos);
+    assert(text.find("transport_catalogue_bytes 15\n"s) != std::string::npos);
+    assert(text.find("transport_catalogue_phase_calls{phase=\"load\"} 2\n"s)
+           != std::string::npos);
+
+    Reset();
+    assert(!IsEnabled());
+}
+
+} // namespace stats::tests
+
+} // namespace stats
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+#include "json.h"
+
+/* Durations of phases, counters and latencies of queries collected during
+ * a run. Nothing is collected until Enable is called, so disabled timers
+ * and counters cost a single flag check */
+namespace stats {
+
+using Clock = std::chrono::steady_clock;
+
+namespace detail {
+
+inline std::atomic<bool> is_enabled = false;
+
+void AddPhase(std::string_view phase, Clock::duration duration);
+
+void AddCounter(std::string_view counter, uint64_t value);
+
+void AddLatency(std::string_view type, Clock::duration duration);
+
+bool IsSlowQuery(Clock::duration duration);
+
+void AddSlowQuery(std::string_view type, Clock::duration duration,
+                  json::Dict details);
+
+} // namespace stats::detail
+
+inline bool IsEnabled() {
+    return detail::is_enabled.load(std::memory_order_relaxed);
+}
+
+void Enable();
+
+// Disables collecting and drops everything collected so far
+void Reset();
+
+/* Enables collecting and makes queries taking longer than the threshold be
+ * logged, one JSON dict per line. The log has to outlive the collecting */
+void EnableSlowQueryLog(Clock::duration threshold, std::ostream& log);
+
+// Durations of phases with the same name add up
+inline void AddPhase(std::string_view phase, Clock::duration duration) {
+    if (IsEnabled()) {
+        detail::AddPhase(phase, duration);
+    }
+}
+
+inline void AddCounter(std::string_view counter, uint64_t value) {
+    if (IsEnabled()) {
+        detail::AddCounter(counter, value);
+    }
+}
+
+// Records how long a single query of the type took
+inline void AddLatency(std::string_view type, Clock::duration duration) {
+    if (IsEnabled()) {
+        detail::AddLatency(type, duration);
+    }
+}
+
+/* Records how long a single query took. The details are taken only for
+ * a slow query, they identify it in the log along with its type */
+template <typename DetailsFunc>
+void AddQuery(std::string_view type, Clock::duration duration,
+              DetailsFunc details_func) {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    detail::AddLatency(type, duration);
+    if (detail::IsSlowQuery(duration)) {
+        detail::AddSlowQuery(type, duration, details_func());
+    }
+}
+
+/* Prints everything collected as a JSON dict. Latencies of every type are
+ * summed up by percentiles */
+void Print(std::ostream& out);
+
+// Prints everything collected in the Prometheus text format
+void PrintPrometheus(std::ostream& out);
+
+/* Adds the time from its construction to its destruction to a phase, or to
+ * the latencies of a query type. The name has to outlive the timer */
+class ScopedTimer {
+public:
+    enum class Target {
+        PHASE,
+        LATENCY
+    };
+
+    explicit ScopedTimer(std::string_view name, Target target = Target::PHASE)
+        : name_(name)
+        , target_(target)
+        , is_enabled_(IsEnabled()) {
+        if (is_enabled_) {
+            start_ = Clock::now();
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        if (!is_enabled_) {
+            return;
+        }
+        if (target_ == Target::PHASE) {
+            detail::AddPhase(name_, Clock::now() - start_);
+        } else {
+            detail::AddLatency(name_, Clock::now() - start_);
+        }
+    }
+
+private:
+    std::string_view name_;
+
+    Target target_;
+
+    bool is_enabled_;
+
+    Clock::time_point start_;
+};
+
+namespace tests {
+
+void TestStats();
+
+} // namespace stats::tests
+
+} // namespace stats
@@ -1,6 +1,13 @@
+#include <algorithm>
 #include <cassert>
+#include <charconv>
+#include <iterator>
+#include <mutex>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_set>
 #include <variant>
 
 #include "svg.h"
@@ -11,6 +18,87 @@ using namespace std::literals;
 
 namespace utils {
 
+const std::string* InternString(std::string str) {
+    static std::mutex pool_mutex;
+    // Elements of a node-based set never move, so pointers stay valid
+    static std::unordered_set<std::string> pool;
+
+    std::lock_guard<std::mutex> guard(pool_mutex);
+    return &*pool.insert(std::move(str)).first;
+}
+
+void AppendNumber(std::string& buffer, double value, 
+                  std::optional<int> precision) {
+    // A default stream prints doubles as printf's %g with precision 6 does
+    constexpr int STREAM_PRECISION = 6;
+
+    char chars[384];
+
+    const std::to_chars_result result = precision
+        ? std::to_chars(std::begin(chars), std::end(chars), value,
+                        std::chars_format::fixed, *precision)
+        : std::to_chars(std::begin(chars), std::end(chars), value,
+                        std::chars_format::general, STREAM_PRECISION);
+
+    // On failure nothing meaningful is written into the chars
+    if (result.ec != std::errc{}) {
+        throw std::out_of_range("Number is too long to be printed");
+    }
+
+    char* end = result.ptr;
+
+    if (!precision) {
+        buffer.append(chars, end);
+        return;
+    }
+
+    // Trailing zeros of the fraction add nothing but length
+    if (std::find(chars, end, '.') != end) {
+        while (*(end - 1) == '0') --end;
+        if (*(end - 1) == '.') --end;
+    }
+
+    // Small negative numbers get rounded to -0
+    if (end - chars == 2 && chars[0] == '-' && chars[1] == '0') {
+        buffer += '0';
+        return;
+    }
+
+    buffer.append(chars, end);
+}
+
+void AppendColor(std::string& buffer, const Color& color) {
+    const auto append_int = [&buffer](int value) {
+        char chars[16];
+        buffer.append(chars, std::to_chars(std::begin(chars), std::end(chars), 
+                                           value).ptr);
+    };
+
+    if (const auto* rgb = std::get_if<Rgb>(&color)) {
+        buffer += "rgb("sv;
+        append_int(rgb->red);
+        buffer += ',';
+        append_int(rgb->green);
+        buffer += ',';
+        append_int(rgb->blue);
+        buffer += ')';
+    } else if (const auto* rgba = std::get_if<Rgba>(&color)) {
+        buffer += "rgba("sv;
+        append_int(rgba->red);
+        buffer += ',';
+        append_int(rgba->green);
+        buffer += ',';
+        append_int(rgba->blue);
+        buffer += ',';
+        AppendNumber(buffer, rgba->opacity);
+        buffer += ')';
+    } else if (const auto* str = std::get_if<std::string>(&color)) {
+        buffer += *str;
+    } else {
+        buffer += "none"sv;
+    }
+}
+
 std::string ReplaceSpecialChars(const std::string& str) {
     std::string result;
     for (auto iter = str.begin(); iter != str.end(); iter++) {
@@ -58,14 +146,6 @@ bool operator==(const Color& lhs, const Color& rhs) {
     return false;
 }
 
-void Object::Render(const RenderContext& context) const {
-    context.RenderIndent();
-
-    // Делегируем вывод тега своим подклассам
-    RenderObject(context);
-
-    context.out << std::endl;
-}
 
 // ---------- Circle ------------------
 
@@ -80,13 +160,19 @@ Circle& Circle::SetRadius(double radius)  {
 }
 
 void Circle::RenderObject(const RenderContext& context) const {
-    auto& out = context.out;
-    out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-    out << "r=\""sv << radius_ << "\""sv;
+    std::string& buffer = context.buffer;
+
+    buffer += "<circle cx=\""sv;
+    utils::AppendNumber(buffer, center_.x, context.precision);
+    buffer += "\" cy=\""sv;
+    utils::AppendNumber(buffer, center_.y, context.precision);
+    buffer += "\" r=\""sv;
+    utils::AppendNumber(buffer, radius_, context.precision);
+    buffer += '"';
         
-    RenderAttrs(out);
+    RenderAttrs(context);
 
-    out << "/>"sv;
+    buffer += "/>"sv;
 }
 
 // ---------- PolyLine -------------
@@ -94,31 +180,30 @@ void Circle::RenderObject(const RenderContext& context) const {
 Polyline& Polyline::AddPoint(Point point) {
     path_.push_back(point);
 
-    ConvertPathToPoints();
-
     return *this;
 }
 
-void Polyline::ConvertPathToPoints() {
-    std::ostringstream result;
-    bool is_first = true; 
+void Polyline::RenderObject(const RenderContext& context) const {
+    // A formatted coordinate pair rarely takes more than that
+    constexpr size_t POINT_LENGTH_ESTIMATE = 24;
+
+    std::string& buffer = context.buffer;
+    buffer.reserve(buffer.size() + path_.size() * POINT_LENGTH_ESTIMATE);
 
+    buffer += "<polyline points=\""sv;
     for (const Point& p : path_) {
-        if (!is_first) {
-            result << " ";
+        if (&p != &path_.front()) {
+            buffer += ' ';
         }
-        is_first = false;
-        result << p.x << "," << p.y;
+        utils::AppendNumber(buffer, p.x, context.precision);
+        buffer += ',';
+        utils::AppendNumber(buffer, p.y, context.precision);
     }
+    buffer += '"';
 
-    points_ = std::move(result.str());
-}
+    RenderAttrs(context);
 
-void Polyline::RenderObject(const RenderContext& context) const {
-    auto& out = context.out;
-    out << "<polyline points=\""sv << points_ << "\""sv;
-    RenderAttrs(out);
-    out << "/>"sv;
+    buffer += "/>"sv;
 }
 
 // -------------- Text -----------
@@ -138,11 +223,21 @@ Text& Text::SetFontSize(uint32_t size) {
 }
 
 Text& Text::SetFontFamily(std::string font_family) {
-    font_family_ = font_family;
+    font_family_ = utils::InternString(std::move(font_family));
     return *this;
 }
 
 Text& Text::SetFontWeight(std::string font_weight) {
+    font_weight_ = utils::InternString(std::move(font_weight));
+    return *this;
+}
+
+Text& Text::SetFontFamily(const std::string* font_family) {
+    font_family_ = font_family;
+    return *this;
+}
+
+Text& Text::SetFontWeight(const std::string* font_weight) {
     font_weight_ = font_weight;
     return *this;
 }
@@ -153,75 +248,136 @@ Text& Text::SetData(std::string data) {
 }
 
 void Text::RenderObject(const RenderContext& context) const {
-    auto& out = context.out;
-    out << "<text"sv;
-
-    RenderAttrs(out);
-
-    out << " x=\""sv << pos_.x << "\" y=\""sv << pos_.y << "\" dx=\""sv
-        << offset_.x << "\" dy=\""sv << offset_.y << "\" font-size=\""sv 
-        << font_size_ << "\""sv;    
+    std::string& buffer = context.buffer;
+
+    buffer += "<text"sv;
+
+    RenderAttrs(context);
+
+    buffer += " x=\""sv;
+    utils::AppendNumber(buffer, pos_.x, context.precision);
+    buffer += "\" y=\""sv;
+    utils::AppendNumber(buffer, pos_.y, context.precision);
+    buffer += "\" dx=\""sv;
+    utils::AppendNumber(buffer, offset_.x, context.precision);
+    buffer += "\" dy=\""sv;
+    utils::AppendNumber(buffer, offset_.y, context.precision);
+    buffer += "\" font-size=\""sv;
+    buffer += std::to_string(font_size_);
+    buffer += '"';
     
-    if (font_family_) out << " font-family=\""sv << *font_family_ << "\""sv;
-    if (font_weight_) out << " font-weight=\""sv << *font_weight_ << "\""sv;
+    if (font_family_) {
+        buffer += " font-family=\""sv;
+        buffer += *font_family_;
+        buffer += '"';
+    }
+    if (font_weight_) {
+        buffer += " font-weight=\""sv;
+        buffer += *font_weight_;
+        buffer += '"';
+    }
 
-    out << ">" << data_ << "</text>";
+    buffer += '>';
+    buffer += data_;
+    buffer += "</text>"sv;
 }
 
 // ----------- Document -------------
 
 
-void Document::AddPtr(std::unique_ptr<Object>&& obj) {
-    object_ptrs_.push_back(std::move(obj));
+void Document::AddShape(Shape shape) {
+    shapes_.push_back(std::move(shape));
 }
 
-void Document::Render(std::ostream& out) const {
+namespace {
+
+void RenderProlog(std::ostream& out, 
+                  const std::optional<ViewBox>& view_box = std::nullopt) {
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\""sv;
+    if (view_box) {
+        out << " viewBox=\""sv << view_box->x << ' ' << view_box->y << ' '
+            << view_box->width << ' ' << view_box->height << "\""sv;
+    }
+    out << ">\n"sv;
+}
+
+void RenderShape(const RenderContext& context, const Shape& shape) {
+    std::visit([&context](const auto& object) {
+        object.Render(context);
+    }, shape);
+}
+
+} // namespace
+
+void Document::Render(std::ostream& out, std::optional<int> precision) const {
     RenderContext context(out);
+    context.precision = precision;
     
-    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
-    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
+    RenderProlog(out);
 
-    for (std::shared_ptr<Object> obj_ptr : object_ptrs_) {
-        obj_ptr->Render(context);
+    for (const Shape& shape : shapes_) {
+        RenderShape(context, shape);
     }
 
     out << "</svg>"sv;
 }
 
-std::ostream& operator<<(std::ostream& out, const StrokeLineCap& linecap) {
+// ----------- StreamingDocument -------------
+
+void ShapeWriter::AddShape(Shape shape) {
+    RenderShape(context_, shape);
+}
+
+StreamingDocument::StreamingDocument(std::ostream& out, 
+                                     std::optional<ViewBox> view_box,
+                                     std::optional<int> precision)
+    : ShapeWriter(out, precision) {
+    RenderProlog(out, view_box);
+}
+
+void StreamingDocument::AddRendered(std::string_view shapes) {
+    context_.out.write(shapes.data(), shapes.size());
+}
+
+void StreamingDocument::Finish() {
+    context_.out << "</svg>"sv;
+}
+
+std::string_view ToString(StrokeLineCap linecap) {
     switch (linecap) {
     case StrokeLineCap::BUTT:
-        out << "butt";
-        break;
+        return "butt"sv;
     case StrokeLineCap::ROUND:
-        out << "round";
-        break;
+        return "round"sv;
     case StrokeLineCap::SQUARE:
-        out << "square";
-        break;
+        return "square"sv;
     }
-    return out;
+    return {};
 }
 
-std::ostream& operator<<(std::ostream& out, const StrokeLineJoin& join) {
+std::string_view ToString(StrokeLineJoin join) {
     switch (join) {
     case StrokeLineJoin::ARCS:
-        out << "arcs";
-        break;
+        return "arcs"sv;
     case StrokeLineJoin::BEVEL:
-        out << "bevel";
-        break;
+        return "bevel"sv;
     case StrokeLineJoin::MITER:
-        out << "miter";
-        break;
+        return "miter"sv;
     case StrokeLineJoin::MITER_CLIP:
-        out << "miter-clip";
-        break;
+        return "miter-clip"sv;
     case StrokeLineJoin::ROUND:
-        out << "round";
-        break;
+        return "round"sv;
     }
-    return out;
+    return {};
+}
+
+std::ostream& operator<<(std::ostream& out, const StrokeLineCap& linecap) {
+    return out << ToString(linecap);
+}
+
+std::ostream& operator<<(std::ostream& out, const StrokeLineJoin& join) {
+    return out << ToString(join);
 }
 
 std::ostream& operator<<(std::ostream& out, const Color color) {
@@ -278,6 +434,30 @@ void TestPolyLineRender() {
         bool test_empty = out.str() == "<polyline points=\"\"/>\n"s;
         assert(test_empty);
     }
+
+    {
+        // Points are formatted exactly as a default stream would do it
+        const std::vector<Point> points{ 
+            { 1234567.0, -0.000012345 }, { 99.9999999, 1e20 }, { -3.5, 0.0 }
+        };
+
+        std::ostringstream expected;
+        expected << "<polyline points=\""s;
+        for (const Point& p : points) {
+            expected << (&p == &points.front() ? ""s : " "s) << p.x << "," << p.y;
+        }
+        expected << "\"/>\n"s;
+
+        std::ostringstream out;
+        RenderContext context(out);
+
+        Polyline pline;
+        pline.AddPoints(points.begin(), points.end());
+        pline.Render(context);
+
+        bool test_bulk = out.str() == expected.str();
+        assert(test_bulk);
+    }
 }
 
 void TestTextRender() {
@@ -345,6 +525,105 @@ void TestTextRender() {
 
         assert(test_no_weight_and_family);
     }
+    {
+        std::ostringstream out;
+        RenderContext context(out);
+
+        // Interned strings render the same as the ones set by value
+        Text text;
+        text.SetData("Hello"s)
+            .SetFontFamily(utils::InternString("Georgia"s))
+            .SetFontWeight(utils::InternString("normal"s));
+
+        text.Render(context);
+        bool test_interned = out.str() == "<text x=\"0\" y=\"0\" dx=\"0\" dy=\"0\" font-size=\"1\" font-family=\"Georgia\" font-weight=\"normal\">Hello</text>\n";
+        assert(test_interned);
+        assert(utils::InternString("Georgia"s) == utils::InternString("Georgia"s));
+    }
+}
+
+void TestStreamingDocument() {
+    Circle circle;
+    circle.SetCenter({ 1.5, 2 }).SetRadius(3).SetFillColor("white"s);
+
+    Polyline pline;
+    pline.AddPoint({ 0.1, 11.2 }).AddPoint({ 1.0, 2.3 });
+
+    Text text;
+    text.SetData("<\"quoted\">"s).SetFontFamily("Verdana"s);
+
+    Document document;
+    document.Add(circle);
+    document.Add(pline);
+    document.Add(text);
+
+    std::ostringstream stored;
+    document.Render(stored);
+
+    std::ostringstream streamed;
+    StreamingDocument streaming(streamed);
+    streaming.Add(circle);
+    streaming.Add(pline);
+    streaming.Add(text);
+    streaming.Finish();
+
+    bool test_same = stored.str() == streamed.str();
+    assert(test_same);
+}
+
+void TestNumberFormatting() {
+    const auto format = [](double value, std::optional<int> precision) {
+        std::string buffer;
+        utils::AppendNumber(buffer, value, precision);
+        return buffer;
+    };
+
+    // By default numbers match what a stream prints
+    for (const double value : { 0.0, -0.0, 1.0, 0.1, 2.213, 123456.0, 1234567.0,
+                                -3.5e-7, 99.99995, 1e20, 600.0 / 7 }) {
+        std::ostringstream out;
+        out << value;
+        assert(format(value, std::nullopt) == out.str());
+    }
+
+    // With a precision trailing zeros and negative zeros are dropped
+    assert(format(12.3456, 2) == "12.35"s);
+    assert(format(3.0, 2) == "3"s);
+    assert(format(2.50, 3) == "2.5"s);
+    assert(format(100.0, 0) == "100"s);
+    assert(format(-0.001, 2) == "0"s);
+    assert(format(-1.25, 1) == "-1.2"s);
+    assert(format(1234567.891, 1) == "1234567.9"s);
+
+    // A number that doesn't fit is an error, not a buffer of garbage
+    bool is_too_long = false;
+    try {
+        format(1e300, 1000);
+    } catch (const std::out_of_range&) {
+        is_too_long = true;
+    }
+    assert(is_too_long);
+
+    // Colors match what a stream prints
+    for (const Color& color : { Color{ Rgb{ 1, 2, 3 } }, 
+                                Color{ Rgba{ 255, 255, 255, 0.85 } },
+                                Color{ "red"s }, Color{} }) {
+        std::ostringstream out;
+        out << color;
+        std::string buffer;
+        utils::AppendColor(buffer, color);
+        assert(buffer == out.str());
+    }
+
+    // The precision applies to every number of a shape
+    std::ostringstream out;
+    ShapeWriter writer(out, 1);
+    writer.Add(Circle({ 10.04, 2.25 }, 5.0));
+    writer.Add(Polyline().AddPoint({ 1.0 / 3, 2.0 / 3 }).SetStrokeWidth(14.06));
+
+    bool test_precision = out.str() == "<circle cx=\"10\" cy=\"2.2\" r=\"5\"/>\n"
+                                       "<polyline points=\"0.3,0.7\" stroke-width=\"14.1\"/>\n"s;
+    assert(test_precision);
 }
 
 } // namespace svg::my_tests
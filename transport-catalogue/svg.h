@@ -6,6 +6,7 @@
 #include <optional>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -79,8 +80,26 @@ namespace utils {
 // Replaces special characters with given escape sequences
 std::string ReplaceSpecialChars(const std::string& str);
 
+/* Returns a pointer to the pooled copy of a string. Equal strings share
+ * one copy that lives until the program ends. Is thread-safe */
+const std::string* InternString(std::string str);
+
+/* Appends a number to the buffer without going through a stream. By 
+ * default is formatted the same way a default std::ostream prints doubles.
+ * With a precision has at most that many digits after the point. Throws
+ * std::out_of_range if the number is too long to be printed */
+void AppendNumber(std::string& buffer, double value, 
+                  std::optional<int> precision = std::nullopt);
+
+// Appends a color the same way operator<< prints it
+void AppendColor(std::string& buffer, const Color& color);
+
 } // namespace svg::utils
 
+std::string_view ToString(StrokeLineCap linecap);
+
+std::string_view ToString(StrokeLineJoin join);
+
 std::ostream& operator<<(std::ostream& out, const StrokeLineCap& linecap);
 
 std::ostream& operator<<(std::ostream& out, const StrokeLineJoin& join);
@@ -91,6 +110,49 @@ std::ostream& operator<<(std::ostream& out, const Rgb rgb);
 
 std::ostream& operator<<(std::ostream& out, const Rgba rbg);
 
+/* Auxilary struct used for outputting svg with fancy indents */
+struct RenderContext {
+    RenderContext(std::ostream& out)
+        : out(out) {
+        buffer.reserve(INITIAL_BUFFER_SIZE);
+    }
+
+    RenderContext(std::ostream& out, int indent_step, int indent = 0)
+        : out(out)
+        , indent_step(indent_step)
+        , indent(indent) {
+        buffer.reserve(INITIAL_BUFFER_SIZE);
+    }
+
+    RenderContext Indented() const {
+        RenderContext indented(out, indent_step, indent + indent_step);
+        indented.precision = precision;
+        return indented;
+    }
+
+    void RenderIndent() const {
+        buffer.append(indent, ' ');
+    }
+
+    std::ostream& out;
+
+    int indent_step = 0;
+    
+    int indent = 0;
+
+    /* Digits after the point kept in numbers. Without it numbers look 
+     * the way a default stream prints them */
+    std::optional<int> precision;
+
+    /* A shape is formatted here and then written to the stream at once.
+     * Is shared by all shapes rendered with the context */
+    mutable std::string buffer;
+
+private:
+    // Fits a shape with a few attributes
+    static constexpr size_t INITIAL_BUFFER_SIZE = 256;
+};
+
 // Path properties common for many shapes
 template <typename Owner>
 class PathProps {
@@ -127,23 +189,34 @@ public:
     }
 
 protected:
-    void RenderAttrs(std::ostream& out) const {
+    void RenderAttrs(const RenderContext& context) const {
         using namespace std::literals;
+        std::string& buffer = context.buffer;
 
         if (fill_color_) {
-            out << " fill=\""sv << *fill_color_ << "\""sv;
+            buffer += " fill=\""sv;
+            utils::AppendColor(buffer, *fill_color_);
+            buffer += '"';
         }
         if (stroke_color_) {
-            out << " stroke=\""sv << *stroke_color_ << "\""sv;
+            buffer += " stroke=\""sv;
+            utils::AppendColor(buffer, *stroke_color_);
+            buffer += '"';
         }
         if (stroke_width_) {
-            out << " stroke-width=\""sv << *stroke_width_ << "\""sv;
+            buffer += " stroke-width=\""sv;
+            utils::AppendNumber(buffer, *stroke_width_, context.precision);
+            buffer += '"';
         } 
         if (stroke_linecap_) {
-            out << " stroke-linecap=\""sv << *stroke_linecap_ << "\""sv;
+            buffer += " stroke-linecap=\""sv;
+            buffer += ToString(*stroke_linecap_);
+            buffer += '"';
         }
         if (stroke_linejoin_) {
-            out << " stroke-linejoin=\""sv << *stroke_linejoin_ << "\""sv;
+            buffer += " stroke-linejoin=\""sv;
+            buffer += ToString(*stroke_linejoin_);
+            buffer += '"';
         }
     }
 
@@ -166,46 +239,32 @@ private:
 
 };
 
-/* Auxilary struct used for outputting svg with fancy indents */
-struct RenderContext {
-    RenderContext(std::ostream& out)
-        : out(out) {
-    }
+/* Base class of every SVG shape. Shapes are stored by value in a variant,
+ * so Object only supplies the common rendering routine for its Owner */
+template <typename Owner>
+class Object {
+public:
+    void Render(const RenderContext& context) const {
+        context.buffer.clear();
+        context.RenderIndent();
 
-    RenderContext(std::ostream& out, int indent_step, int indent = 0)
-        : out(out)
-        , indent_step(indent_step)
-        , indent(indent) {
-    }
+        // Делегируем вывод тега своим подклассам
+        static_cast<const Owner&>(*this).RenderObject(context);
 
-    RenderContext Indented() const {
-        return {out, indent_step, indent + indent_step};
+        context.buffer += '\n';
+        context.out.write(context.buffer.data(), context.buffer.size());
     }
 
-    void RenderIndent() const {
-        for (int i = 0; i < indent; ++i) {
-            out.put(' ');
-        }
-    }
-
-    std::ostream& out;
-
-    int indent_step = 0;
-    
-    int indent = 0;
+protected:
+    ~Object() = default;
 };
 
-/* Abstract class Object is used for storing different types of 
- * SVG shapes in one container */
-class Object {
-public:
-    void Render(const RenderContext& context) const;
-
-    virtual ~Object() = default;
+class Circle;
+class Polyline;
+class Text;
 
-private:
-    virtual void RenderObject(const RenderContext& context) const = 0;
-};
+// Any SVG shape a document can hold
+using Shape = std::variant<Circle, Polyline, Text>;
 
 /* An abstract class for any container that houses SVG-objects */
 class ObjectContainer {
@@ -213,14 +272,11 @@ public:
     ObjectContainer() = default;
 
     template <typename ObjectDerivative>
-    void Add(const ObjectDerivative& obj);
+    void Add(ObjectDerivative obj);
 
-    virtual void AddPtr(std::unique_ptr<Object>&& obj) = 0;
+    virtual void AddShape(Shape shape) = 0;
     
     virtual ~ObjectContainer() = default;
-protected: 
-    
-    std::vector<std::shared_ptr<Object>> object_ptrs_;
 };
 
 /* An interface for any drawable svg object */
@@ -230,16 +286,11 @@ public:
     virtual ~Drawable() = default;
 };
 
-template <typename ObjectDerivative>
-void ObjectContainer::Add(const ObjectDerivative& obj) {
-    AddPtr(std::make_unique<ObjectDerivative>(obj));
-}
-
 /*
  * Class Circle is represents <circle> tag in svg graphics
  * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/circle
  */
-class Circle final : public Object
+class Circle final : public Object<Circle>
                    , public PathProps<Circle> {
 public:
     Circle() = default;
@@ -250,7 +301,9 @@ public:
     Circle& SetRadius(double radius);
 
 private:
-    void RenderObject(const RenderContext& context) const override;
+    friend class Object<Circle>;
+
+    void RenderObject(const RenderContext& context) const;
 
     Point center_;
     double radius_ = 1.0;
@@ -260,29 +313,36 @@ private:
  * Class Polyline represents <polyline> tag in svg graphics
  * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/polyline
  */
-class Polyline final : public Object
+class Polyline final : public Object<Polyline>
                      , public PathProps<Polyline> {
 public:
     // Adds a vertex to a polyline
     Polyline& AddPoint(Point point);
 
+    // Adds vertexes [first, last) to a polyline
+    template <typename InputIt>
+    Polyline& AddPoints(InputIt first, InputIt last);
+
 private:
+    friend class Object<Polyline>;
     
-    void RenderObject(const RenderContext& context) const override;
-    
-    // Converts a vector of points to a string
-    void ConvertPathToPoints();
-
-    std::string points_;
+    // Points are formatted only here, once per render
+    void RenderObject(const RenderContext& context) const;
 
     std::vector<Point> path_;
 };
 
+template <typename InputIt>
+Polyline& Polyline::AddPoints(InputIt first, InputIt last) {
+    path_.insert(path_.end(), first, last);
+    return *this;
+}
+
 /*
  * Class Text represents <text> tag in svg graphics
  * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/text
  */
-class Text final : public Object
+class Text final : public Object<Text>
                  , public PathProps<Text> {
 public:
     Text& SetPosition(Point pos);
@@ -295,10 +355,18 @@ public:
 
     Text& SetFontWeight(std::string font_weight);
 
+    /* Take strings already returned by utils::InternString, so texts drawn
+     * in bulk skip the locked pool lookup */
+    Text& SetFontFamily(const std::string* font_family);
+
+    Text& SetFontWeight(const std::string* font_weight);
+
     Text& SetData(std::string data);
 
 private:
-    void RenderObject(const RenderContext& context) const override;
+    friend class Object<Text>;
+
+    void RenderObject(const RenderContext& context) const;
 
     Point pos_;
 
@@ -306,26 +374,80 @@ private:
 
     uint32_t font_size_ = 1;
 
-    std::optional<std::string> font_family_;
+    // Interned strings, nullptr if the attribute is not set
+    const std::string* font_family_ = nullptr;
 
-    std::optional<std::string> font_weight_;
+    const std::string* font_weight_ = nullptr;
 
     std::string data_;
 };
 
+template <typename ObjectDerivative>
+void ObjectContainer::Add(ObjectDerivative obj) {
+    AddShape(std::move(obj));
+}
+
 class Document : public ObjectContainer {
 public:
-    // Adds an Object-derivative class to the document
-    void AddPtr(std::unique_ptr<Object>&& obj);
+    // Adds a shape to the document
+    void AddShape(Shape shape) override;
+
+    /* Renders an svg-document to the output stream, numbers with the given
+     * precision if any */
+    void Render(std::ostream& out, 
+                std::optional<int> precision = std::nullopt) const;
+
+private:
+    // Shapes are kept by value, in the order they are rendered
+    std::vector<Shape> shapes_;
+};
+
+/* A container that renders every shape to the stream as soon as it is
+ * added, without any prolog. Is used to render parts of a document */
+class ShapeWriter : public ObjectContainer {
+public:
+    explicit ShapeWriter(std::ostream& out, 
+                         std::optional<int> precision = std::nullopt)
+        : context_(out) {
+        context_.precision = precision;
+    }
+
+    // Renders the shape right away
+    void AddShape(Shape shape) override;
+
+protected:
+    RenderContext context_;
+};
+
+// The area of the plane an svg-document shows
+struct ViewBox {
+    double x;
+    double y;
+    double width;
+    double height;
+};
+
+/* A whole svg-document that is never stored. The prolog is written on 
+ * construction, the closing tag by Finish() */
+class StreamingDocument : public ShapeWriter {
+public:
+    explicit StreamingDocument(std::ostream& out, 
+                               std::optional<ViewBox> view_box = std::nullopt,
+                               std::optional<int> precision = std::nullopt);
+
+    // Writes shapes that were already rendered by a ShapeWriter
+    void AddRendered(std::string_view shapes);
 
-    // Renders an svg-document to the output stream
-    void Render(std::ostream& out) const;
+    // Closes the svg-document. No shapes can be added afterwards
+    void Finish();
 };
 
 namespace my_tests {
 
 void TestPolyLineRender();
 void TestTextRender();
+void TestStreamingDocument();
+void TestNumberFormatting();
 
 } // namespace svg::my_tests
 
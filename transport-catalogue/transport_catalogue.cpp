@@ -3,9 +3,13 @@
 #include <iterator>
 #include <numeric>
 #include <ostream>
+#include <stdexcept>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "geo.h"
+#include "parallel.h"
 #include "transport_catalogue.h"
 
 namespace transport_catalogue {
@@ -50,12 +54,13 @@ std::vector<std::string_view> SplitBy(std::string_view view, const char delim) {
 } // namespace transport_catalogue::util
 
 void TransportCatalogue::AddStop(const std::string_view name, const geo::Coordinates& coordinates) {
-    stops_.emplace_back(std::string(name), coordinates, std::set<Bus*, BusCompare>());
+    stops_.emplace_back(name, coordinates, domain::BusSet());
+    stops_.back().id = stops_.size() - 1;
     names_to_stops_[stops_.back().name] = &stops_.back();
 }
 
 void TransportCatalogue::AddBus(const std::string_view name, const std::vector<std::string_view>& stop_names, bool is_round) {
-    buses_.emplace_back(std::string(name), std::vector<Stop*>());
+    buses_.emplace_back(name, domain::Route());
     
     Bus& bus = buses_.back();
     buses_.back().is_roundtrip = is_round;
@@ -76,6 +81,202 @@ void TransportCatalogue::AddDistance(const std::string_view stop_from, const std
     stop_distances_[stop_pair] = distance;
 }
 
+void TransportCatalogue::AddStops(const std::deque<StopInputQuery>& queries) {
+    for (const StopInputQuery& query : queries) {
+        AddStop(query.name, query.coordinates);
+    }
+}
+
+void TransportCatalogue::AddDistances(const std::deque<StopInputQuery>& queries) {
+    using ResolvedDistance = std::pair<std::pair<StopPtr, StopPtr>, int>;
+
+    // Every query writes its distances starting at its own offset
+    std::vector<size_t> offsets(queries.size() + 1, 0);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        offsets[i + 1] = offsets[i] + queries[i].distances.size();
+    }
+
+    std::vector<ResolvedDistance> resolved(offsets.back());
+    parallel::ForEachChunk(queries.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const StopPtr stop_from = names_to_stops_.at(queries[i].name);
+            size_t pos = offsets[i];
+            for (const auto& [stop_to, distance] : queries[i].distances) {
+                resolved[pos++] = {{stop_from, names_to_stops_.at(stop_to)}, 
+                                   distance};
+            }
+        }
+    }, 256);
+
+    stop_distances_.reserve(stop_distances_.size() + resolved.size());
+    for (const auto& [stop_pair, distance] : resolved) {
+        stop_distances_[stop_pair] = distance;
+    }
+}
+
+void TransportCatalogue::AddBuses(const std::deque<BusInputQuery>& queries) {
+    using Membership = std::pair<StopPtr, BusPtr>;
+
+    std::vector<BusPtr> added_buses;
+    added_buses.reserve(queries.size());
+    std::vector<size_t> offsets(queries.size() + 1, 0);
+
+    for (size_t i = 0; i < queries.size(); ++i) {
+        buses_.emplace_back(queries[i].name, domain::Route(), 
+                            queries[i].is_roundtrip);
+        added_buses.push_back(&buses_.back());
+        names_to_buses_[buses_.back().name] = &buses_.back();
+        offsets[i + 1] = offsets[i] + queries[i].stop_names.size();
+    }
+
+    std::vector<Membership> memberships(offsets.back());
+    parallel::ForEachChunk(queries.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Bus& bus = *added_buses[i];
+            bus.route.reserve(queries[i].stop_names.size());
+            size_t pos = offsets[i];
+            for (const std::string_view stop_name : queries[i].stop_names) {
+                bus.route.push_back(names_to_stops_.at(stop_name));
+                memberships[pos++] = {bus.route.back(), &bus};
+            }
+        }
+    }, 64);
+
+    std::sort(memberships.begin(), memberships.end());
+
+    // Groups never cross chunk borders, so every stop is touched by one thread
+    std::vector<size_t> group_starts;
+    for (size_t i = 0; i < memberships.size(); ++i) {
+        if (i == 0 || memberships[i].first != memberships[i - 1].first) {
+            group_starts.push_back(i);
+        }
+    }
+    group_starts.push_back(memberships.size());
+
+    parallel::ForEachChunk(group_starts.size() - 1, [&](size_t begin, size_t end) {
+        for (size_t group = begin; group < end; ++group) {
+            const StopPtr stop = memberships[group_starts[group]].first;
+            for (size_t i = group_starts[group]; i < group_starts[group + 1]; ++i) {
+                stop->buses.insert(memberships[i].second);
+            }
+        }
+    }, 256);
+}
+
+void TransportCatalogue::SetStopCoordinates(const std::string_view name, const geo::Coordinates& coordinates) {
+    names_to_stops_.at(name)->coordinates = coordinates;
+}
+
+void TransportCatalogue::SetBusRoute(const std::string_view name, const std::vector<std::string_view>& stop_names, bool is_round) {
+    Bus& bus = *names_to_buses_.at(name);
+
+    for (const StopPtr stop_ptr : bus.route) {
+        stop_ptr->buses.erase(&bus);
+    }
+
+    bus.route.clear();
+    bus.is_roundtrip = is_round;
+
+    for (const std::string_view stop_name : stop_names) {
+        bus.route.push_back(names_to_stops_.at(stop_name));
+        names_to_stops_.at(stop_name)->buses.insert(&bus);
+    }
+}
+
+void TransportCatalogue::RemoveBus(const std::string_view name) {
+    Bus& bus = *names_to_buses_.at(name);
+
+    for (const StopPtr stop_ptr : bus.route) {
+        stop_ptr->buses.erase(&bus);
+    }
+
+    names_to_buses_.erase(bus.name);
+
+    Bus& last_bus = buses_.back();
+
+    if (&bus != &last_bus) {
+        /* Stop sets are ordered by bus name, so the last bus has to leave 
+         * them before its name is moved out */
+        for (const StopPtr stop_ptr : last_bus.route) {
+            stop_ptr->buses.erase(&last_bus);
+        }
+
+        names_to_buses_.erase(last_bus.name);
+
+        bus = std::move(last_bus);
+
+        for (const StopPtr stop_ptr : bus.route) {
+            stop_ptr->buses.insert(&bus);
+        }
+
+        names_to_buses_[bus.name] = &bus;
+    }
+
+    buses_.pop_back();
+}
+
+void TransportCatalogue::RemoveStop(const std::string_view name) {
+    Stop& stop = *names_to_stops_.at(name);
+
+    if (!stop.buses.empty()) {
+        throw std::logic_error("Stop " + std::string(stop.name) + " can't be removed while bus " 
+                               + std::string((*stop.buses.begin())->name) + " stops there");
+    }
+
+    Stop& last_stop = stops_.back();
+
+    // Distances of the last stop are keyed by its address, which is about to change
+    std::vector<std::pair<std::pair<StopPtr, StopPtr>, int>> moved_distances;
+
+    for (auto iter = stop_distances_.begin(); iter != stop_distances_.end();) {
+        auto [from_ptr, to_ptr] = iter->first;
+
+        if (from_ptr == &stop || to_ptr == &stop) {
+            iter = stop_distances_.erase(iter);
+        } else if (from_ptr == &last_stop || to_ptr == &last_stop) {
+            if (from_ptr == &last_stop) from_ptr = &stop;
+            if (to_ptr == &last_stop) to_ptr = &stop;
+
+            moved_distances.push_back({ { from_ptr, to_ptr }, iter->second });
+            iter = stop_distances_.erase(iter);
+        } else {
+            iter++;
+        }
+    }
+
+    names_to_stops_.erase(stop.name);
+
+    if (&stop != &last_stop) {
+        names_to_stops_.erase(last_stop.name);
+
+        // The last stop takes the place and the id of the removed one
+        const size_t id = stop.id;
+        stop = std::move(last_stop);
+        stop.id = id;
+
+        for (const BusPtr bus_ptr : stop.buses) {
+            std::replace(bus_ptr->route.begin(), bus_ptr->route.end(), 
+                         &last_stop, &stop);
+        }
+
+        names_to_stops_[stop.name] = &stop;
+
+        for (auto& [stop_pair, distance] : moved_distances) {
+            stop_distances_[stop_pair] = distance;
+        }
+    }
+
+    stops_.pop_back();
+}
+
+bool TransportCatalogue::HasBus(const std::string_view name) const {
+    return names_to_buses_.count(name) > 0;
+}
+
+bool TransportCatalogue::HasStop(const std::string_view name) const {
+    return names_to_stops_.count(name) > 0;
+}
+
 BusPtr TransportCatalogue::FindBus(const std::string_view name) const {
     return names_to_buses_.at(name);
 }
@@ -91,7 +292,7 @@ BusInfoOpt TransportCatalogue::GetBusInfo(const std::string_view name) const {
     const double route_distance_geo = ComputeRouteDistance(bus);
     const double route_distance_cur = ComputeCurvedRouteDistance(bus);
 
-    return BusInfo{ bus.name, bus.route.size(), 
+    return BusInfo{ std::string(bus.name), bus.route.size(), 
              CountUniqueStops(bus), 
              route_distance_cur,
              ComputeCurvature(route_distance_cur, route_distance_geo) };
@@ -129,7 +330,7 @@ double TransportCatalogue::ComputeCurvature(const double curved_distance, const
 }
 
 double TransportCatalogue::ComputeRouteDistance(const Bus& bus) {
-    const std::vector<Stop*>& route = bus.route;
+    const domain::Route& route = bus.route;
     double result = 0.0;
 
     for (auto lhs = route.begin(), rhs = route.begin() + 1; rhs != route.end(); lhs++, rhs++) {
@@ -230,17 +431,17 @@ void TestAddFindMethods() {
 
     std::vector<std::string> bus1_stop_names;
     std::transform(bus1_ref.route.begin(), bus1_ref.route.end(), std::back_inserter(bus1_stop_names), [](const Stop* stop_ptr) {
-        return stop_ptr->name;
+        return std::string(stop_ptr->name);
     });
 
     std::vector<std::string> bus2_stop_names;
     std::transform(bus2_ref.route.begin(), bus2_ref.route.end(), std::back_inserter(bus2_stop_names), [](const Stop* stop_ptr) {
-        return stop_ptr->name;
+        return std::string(stop_ptr->name);
     });
 
     std::vector<std::string> bus3_stop_names;
     std::transform(bus3_ref.route.begin(), bus3_ref.route.end(), std::back_inserter(bus3_stop_names), [](const Stop* stop_ptr) {
-        return stop_ptr->name;
+        return std::string(stop_ptr->name);
     });
 
     bool test_names_1 = bus1_stop_names == std::vector{ "Marushkino"s, "Tolstopaltsevo"s, "Marushkino"s };
@@ -251,9 +452,9 @@ void TestAddFindMethods() {
     assert(test_names_2);
     assert(test_names_3);
 
-    bool test_stops_1 = stop1_ref.name == "Marushkino"s && stop1_ref.coordinates == geo::Coordinates{ 55.595884, 37.209755 };
-    bool test_stops_2 = stop2_ref.name == "Tolstopaltsevo"s && stop2_ref.coordinates == geo::Coordinates{ 55.611087, 37.208290 };
-    bool test_stops_3 = stop3_ref.name == "Biryusinka Miryusinka"s && stop3_ref.coordinates == geo::Coordinates{ 55.581065, 37.648390 };
+    bool test_stops_1 = stop1_ref.name == "Marushkino"sv && stop1_ref.coordinates == geo::Coordinates{ 55.595884, 37.209755 };
+    bool test_stops_2 = stop2_ref.name == "Tolstopaltsevo"sv && stop2_ref.coordinates == geo::Coordinates{ 55.611087, 37.208290 };
+    bool test_stops_3 = stop3_ref.name == "Biryusinka Miryusinka"sv && stop3_ref.coordinates == geo::Coordinates{ 55.581065, 37.648390 };
 
     assert(test_stops_1);
     assert(test_stops_2);
@@ -383,6 +584,129 @@ void TestDistances() {
     assert(test2);
 }
 
+void TestRemoveAndUpdate() {
+    TransportCatalogue tc;
+
+    tc.AddStop("Marushkino"sv, { 55.595884, 37.209755 });
+    tc.AddStop("Tolstopaltsevo"sv, { 55.611087, 37.208290 });
+    tc.AddStop("Biryusinka"sv, { 55.581065, 37.648390 });
+    tc.AddStop("Rasskazovka"sv, { 55.632761, 37.333324 });
+
+    tc.AddDistance("Marushkino"sv, "Tolstopaltsevo"sv, 200);
+    tc.AddDistance("Tolstopaltsevo"sv, "Biryusinka"sv, 300);
+    tc.AddDistance("Biryusinka"sv, "Rasskazovka"sv, 400);
+    tc.AddDistance("Rasskazovka"sv, "Marushkino"sv, 500);
+
+    tc.AddBus("11"sv, { "Marushkino"sv, "Tolstopaltsevo"sv, "Marushkino"sv });
+    tc.AddBus("256"sv, { "Biryusinka"sv, "Rasskazovka"sv, "Biryusinka"sv });
+    tc.AddBus("47"sv, { "Rasskazovka"sv, "Marushkino"sv }, true);
+
+    tc.SetStopCoordinates("Marushkino"sv, { 1.0, 2.0 });
+    assert((tc.FindStop("Marushkino"sv)->coordinates == geo::Coordinates{ 1.0, 2.0 }));
+
+    tc.SetBusRoute("11"sv, { "Tolstopaltsevo"sv, "Biryusinka"sv }, true);
+    assert(tc.GetBusInfo("11"sv)->route_length == 300);
+    assert(tc.GetStopInfo("Marushkino"sv)->bus_names == std::vector{ "47"sv });
+    assert((tc.GetStopInfo("Biryusinka"sv)->bus_names == std::vector{ "11"sv, "256"sv }));
+
+    // Removing the first bus moves the last one into its place
+    tc.RemoveBus("11"sv);
+    assert(tc.GetBusCount() == 2);
+    assert(!tc.GetBusInfo("11"sv).has_value());
+    assert(tc.GetBusInfo("47"sv)->route_length == 500);
+    assert(tc.GetStopInfo("Tolstopaltsevo"sv)->bus_names.empty());
+    assert((tc.GetStopInfo("Rasskazovka"sv)->bus_names == std::vector{ "256"sv, "47"sv }));
+
+    bool is_rejected = false;
+    try {
+        tc.RemoveStop("Rasskazovka"sv);
+    } catch (const std::logic_error&) {
+        is_rejected = true;
+    }
+    assert(is_rejected);
+
+    // Removing a stop moves the last one into its place along with its distances
+    tc.RemoveStop("Tolstopaltsevo"sv);
+    assert(tc.GetStopCount() == 3);
+    assert(!tc.GetStopInfo("Tolstopaltsevo"sv).has_value());
+    assert(tc.GetDistanceMap().size() == 2);
+    assert(tc.GetDistance("Rasskazovka"sv, "Marushkino"sv) == 500);
+    assert(tc.GetBusInfo("256"sv)->route_length == 800);
+    assert(tc.FindBus("47"sv)->route.front() == tc.FindStop("Rasskazovka"sv));
+
+    // Stop ids stay dense
+    std::vector<bool> is_id_taken(tc.GetStopCount(), false);
+    for (const std::string_view stop_name : tc.GetStopNames()) {
+        const size_t id = tc.FindStop(stop_name)->id;
+        assert(id < is_id_taken.size() && !is_id_taken[id]);
+        is_id_taken[id] = true;
+    }
+}
+
+void TestBulkLoad() {
+    constexpr int STOP_COUNT = 3000;
+    constexpr int BUS_COUNT = 400;
+
+    std::deque<std::string> names;
+    std::deque<StopInputQuery> stop_queries;
+    std::deque<BusInputQuery> bus_queries;
+
+    for (int i = 0; i < STOP_COUNT; ++i) {
+        names.push_back("Stop "s + std::to_string(i));
+    }
+    for (int i = 0; i < STOP_COUNT; ++i) {
+        StopInputQuery query;
+        query.name = names[i];
+        query.coordinates = { 55.0 + i * 1e-4, 37.0 + i * 2e-4 };
+        query.distances[names[(i + 1) % STOP_COUNT]] = 100 + i;
+        query.distances[names[(i + 7) % STOP_COUNT]] = 700 + i;
+        stop_queries.push_back(std::move(query));
+    }
+    for (int i = 0; i < BUS_COUNT; ++i) {
+        names.push_back("Bus "s + std::to_string(i));
+        BusInputQuery query;
+        query.name = names.back();
+        query.is_roundtrip = i % 2 == 0;
+        for (int j = 0; j < 20; ++j) {
+            query.stop_names.push_back(names[(i * 13 + j) % STOP_COUNT]);
+        }
+        bus_queries.push_back(std::move(query));
+    }
+
+    TransportCatalogue bulk;
+    bulk.AddStops(stop_queries);
+    bulk.AddDistances(stop_queries);
+    bulk.AddBuses(bus_queries);
+
+    TransportCatalogue sequential;
+    for (const StopInputQuery& query : stop_queries) {
+        sequential.AddStop(query.name, query.coordinates);
+    }
+    for (const StopInputQuery& query : stop_queries) {
+        for (const auto& [stop_to, distance] : query.distances) {
+            sequential.AddDistance(query.name, stop_to, distance);
+        }
+    }
+    for (const BusInputQuery& query : bus_queries) {
+        sequential.AddBus(query.name, query.stop_names, query.is_roundtrip);
+    }
+
+    assert(bulk.GetStopCount() == sequential.GetStopCount());
+    assert(bulk.GetBusCount() == sequential.GetBusCount());
+    assert(bulk.GetDistanceMap().size() == sequential.GetDistanceMap().size());
+
+    for (const std::string_view name : sequential.GetStopNames()) {
+        assert(bulk.GetStopInfo(name)->bus_names 
+            == sequential.GetStopInfo(name)->bus_names);
+    }
+    for (const std::string_view name : sequential.GetBusNames()) {
+        assert(bulk.GetBusInfo(name)->route_length 
+            == sequential.GetBusInfo(name)->route_length);
+        assert(bulk.FindBus(name)->is_roundtrip 
+            == sequential.FindBus(name)->is_roundtrip);
+    }
+}
+
 } // namespace transport_catalogue::tests
 
 } // namespace transport_catalogue
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 #include "geo.h"
 #include "domain.h"
+#include "memory.h"
 
 namespace transport_catalogue {
 
@@ -15,8 +16,9 @@ class TransportCatalogue {
 public:
     struct StopPtrPairHasher;
 
-    using DistanceMap = std::unordered_map<std::pair<StopPtr, StopPtr>, 
-                                            int, StopPtrPairHasher>;
+    using DistanceMap = memory::UnorderedMap<std::pair<StopPtr, StopPtr>, int, 
+                                             memory::Category::CATALOGUE_DISTANCES,
+                                             StopPtrPairHasher>;
     TransportCatalogue() {};
 
     /* Adds a stop to the transport catalogue. This operation involves population 
@@ -30,6 +32,39 @@ public:
     // Adds a distance between stops. Stop's existence is required
     void AddDistance(const std::string_view stop_from, const std::string_view stop_to, const int distance);
 
+    /* Bulk versions of the methods above, used to build the catalogue from
+     * the whole make_base input at once. Adds stops one by one, as AddStop
+     * does */
+    void AddStops(const std::deque<StopInputQuery>& queries);
+
+    /* Adds distances of every query, resolving stop names in parallel. The
+     * distance table is reserved up front. Stops have to be added beforehand */
+    void AddDistances(const std::deque<StopInputQuery>& queries);
+
+    /* Adds buses, resolving their routes in parallel. Stop-to-bus membership
+     * is then collected as (stop, bus) pairs, sorted and grouped by stop, so
+     * each stop's bus set is filled by a single thread */
+    void AddBuses(const std::deque<BusInputQuery>& queries);
+
+    // Moves an existing stop to new coordinates
+    void SetStopCoordinates(const std::string_view name, const geo::Coordinates& coordinates);
+
+    // Replaces the route of an existing bus
+    void SetBusRoute(const std::string_view name, const std::vector<std::string_view>& stop_names, bool is_round = false);
+
+    /* Removes a bus from the catalogue. The last bus in buses_ takes its
+     * place, so pointers to every other bus stay valid */
+    void RemoveBus(const std::string_view name);
+
+    /* Removes a stop along with all distances to and from it. A stop that is
+     * still on some bus route can't be removed. The last stop in stops_ takes
+     * its place, so pointers to every other stop stay valid */
+    void RemoveStop(const std::string_view name);
+
+    bool HasBus(const std::string_view name) const;
+
+    bool HasStop(const std::string_view name) const;
+
     /* Finds a bus by name and returns a reference to its struct 
      * contained in buses_ deque */
     BusPtr FindBus(const std::string_view name) const;
@@ -83,13 +118,15 @@ private:
     // Computes route's curvature
     static double ComputeCurvature(const double curved_distance, const double geo_distance);
 
-    std::deque<Stop> stops_;
+    memory::Deque<Stop, memory::Category::CATALOGUE_STOPS> stops_;
 
-    std::map<std::string_view, StopPtr> names_to_stops_;
+    memory::Map<std::string_view, StopPtr, 
+                memory::Category::CATALOGUE_NAMES> names_to_stops_;
 
-    std::deque<Bus> buses_;
+    memory::Deque<Bus, memory::Category::CATALOGUE_BUSES> buses_;
     
-    std::map<std::string_view, BusPtr> names_to_buses_; 
+    memory::Map<std::string_view, BusPtr, 
+                memory::Category::CATALOGUE_NAMES> names_to_buses_;
 
     DistanceMap stop_distances_;
     
@@ -101,6 +138,8 @@ void TestAddFindMethods();
 void TestGetBusInfo();
 void TestGetStopInfo();
 void TestDistances();
+void TestRemoveAndUpdate();
+void TestBulkLoad();
 
 
 } // namespace transport_catalogue::tests
@@ -110,9 +110,37 @@ struct DatabaseDefaultTypeInternal {
   };
 };
 PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 DatabaseDefaultTypeInternal _Database_default_instance_;
+PROTOBUF_CONSTEXPR Section::Section(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.offset_)*/uint64_t{0u}
+  , /*decltype(_impl_.size_)*/uint64_t{0u}
+  , /*decltype(_impl_.type_)*/0
+  , /*decltype(_impl_._cached_size_)*/{}} {}
+struct SectionDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR SectionDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~SectionDefaultTypeInternal() {}
+  union {
+    Section _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 SectionDefaultTypeInternal _Section_default_instance_;
+PROTOBUF_CONSTEXPR TableOfContents::TableOfContents(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.sections_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}} {}
+struct TableOfContentsDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR TableOfContentsDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~TableOfContentsDefaultTypeInternal() {}
+  union {
+    TableOfContents _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 TableOfContentsDefaultTypeInternal _TableOfContents_default_instance_;
 }  // namespace serialize_transport_catalogue
-static ::_pb::Metadata file_level_metadata_transport_5fcatalogue_2eproto[6];
-static constexpr ::_pb::EnumDescriptor const** file_level_enum_descriptors_transport_5fcatalogue_2eproto = nullptr;
+static ::_pb::Metadata file_level_metadata_transport_5fcatalogue_2eproto[8];
+static const ::_pb::EnumDescriptor* file_level_enum_descriptors_transport_5fcatalogue_2eproto[1];
 static constexpr ::_pb::ServiceDescriptor const** file_level_service_descriptors_transport_5fcatalogue_2eproto = nullptr;
 
 const uint32_t TableStruct_transport_5fcatalogue_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
@@ -168,6 +196,22 @@ const uint32_t TableStruct_transport_5fcatalogue_2eproto::offsets[] PROTOBUF_SEC
   PROTOBUF_FIELD_OFFSET(::serialize_transport_catalogue::Database, _impl_.catalogue_),
   PROTOBUF_FIELD_OFFSET(::serialize_transport_catalogue::Database, _impl_.render_settings_),
   PROTOBUF_FIELD_OFFSET(::serialize_transport_catalogue::Database, _impl_.graph_info_),
+  ~0u,  // no _has_bits_
+  PROTOBUF_FIELD_OFFSET(::serialize_transport_catalogue::Section, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::serialize_transport_catalogue::Section, _impl_.type_),
+  PROTOBUF_FIELD_OFFSET(::serialize_transport_catalogue::Section, _impl_.offset_),
+  PROTOBUF_FIELD_OFFSET(::serialize_transport_catalogue::Section, _impl_.size_),
+  ~0u,  // no _has_bits_
+  PROTOBUF_FIELD_OFFSET(::serialize_transport_catalogue::TableOfContents, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::serialize_transport_catalogue::TableOfContents, _impl_.sections_),
 };
 static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   { 0, -1, -1, sizeof(::serialize_transport_catalogue::Coordinates)},
@@ -176,6 +220,8 @@ static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protode
   { 25, -1, -1, sizeof(::serialize_transport_catalogue::StopDistance)},
   { 34, -1, -1, sizeof(::serialize_transport_catalogue::TransportCatalogue)},
   { 43, -1, -1, sizeof(::serialize_transport_catalogue::Database)},
+  { 52, -1, -1, sizeof(::serialize_transport_catalogue::Section)},
+  { 61, -1, -1, sizeof(::serialize_transport_catalogue::TableOfContents)},
 };
 
 static const ::_pb::Message* const file_default_instances[] = {
@@ -185,6 +231,8 @@ static const ::_pb::Message* const file_default_instances[] = {
   &::serialize_transport_catalogue::_StopDistance_default_instance_._instance,
   &::serialize_transport_catalogue::_TransportCatalogue_default_instance_._instance,
   &::serialize_transport_catalogue::_Database_default_instance_._instance,
+  &::serialize_transport_catalogue::_Section_default_instance_._instance,
+  &::serialize_transport_catalogue::_TableOfContents_default_instance_._instance,
 };
 
 const char descriptor_table_protodef_transport_5fcatalogue_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
@@ -207,7 +255,14 @@ const char descriptor_table_protodef_transport_5fcatalogue_2eproto[] PROTOBUF_SE
   "ender_settings\030\002 \001(\0132-.serialize_transpo"
   "rt_catalogue.RenderSettings\022<\n\ngraph_inf"
   "o\030\003 \001(\0132(.serialize_transport_catalogue."
-  "GraphInfob\006proto3"
+  "GraphInfo\"a\n\007Section\0228\n\004type\030\001 \001(\0162*.ser"
+  "ialize_transport_catalogue.SectionType\022\016"
+  "\n\006offset\030\002 \001(\004\022\014\n\004size\030\003 \001(\004\"K\n\017TableOfC"
+  "ontents\0228\n\010sections\030\001 \003(\0132&.serialize_tr"
+  "ansport_catalogue.Section*r\n\013SectionType"
+  "\022\r\n\tCATALOGUE\020\000\022\023\n\017RENDER_SETTINGS\020\001\022\016\n\n"
+  "GRAPH_INFO\020\002\022\031\n\025CONTRACTION_HIERARCHY\020\003\022"
+  "\024\n\020ROUTING_SETTINGS\020\004b\006proto3"
   ;
 static const ::_pbi::DescriptorTable* const descriptor_table_transport_5fcatalogue_2eproto_deps[2] = {
   &::descriptor_table_graph_2eproto,
@@ -215,9 +270,9 @@ static const ::_pbi::DescriptorTable* const descriptor_table_transport_5fcatalog
 };
 static ::_pbi::once_flag descriptor_table_transport_5fcatalogue_2eproto_once;
 const ::_pbi::DescriptorTable descriptor_table_transport_5fcatalogue_2eproto = {
-    false, false, 777, descriptor_table_protodef_transport_5fcatalogue_2eproto,
+    false, false, 1069, descriptor_table_protodef_transport_5fcatalogue_2eproto,
     "transport_catalogue.proto",
-    &descriptor_table_transport_5fcatalogue_2eproto_once, descriptor_table_transport_5fcatalogue_2eproto_deps, 2, 6,
+    &descriptor_table_transport_5fcatalogue_2eproto_once, descriptor_table_transport_5fcatalogue_2eproto_deps, 2, 8,
     schemas, file_default_instances, TableStruct_transport_5fcatalogue_2eproto::offsets,
     file_level_metadata_transport_5fcatalogue_2eproto, file_level_enum_descriptors_transport_5fcatalogue_2eproto,
     file_level_service_descriptors_transport_5fcatalogue_2eproto,
@@ -229,6 +284,23 @@ PROTOBUF_ATTRIBUTE_WEAK const ::_pbi::DescriptorTable* descriptor_table_transpor
 // Force running AddDescriptors() at dynamic initialization time.
 PROTOBUF_ATTRIBUTE_INIT_PRIORITY2 static ::_pbi::AddDescriptorsRunner dynamic_init_dummy_transport_5fcatalogue_2eproto(&descriptor_table_transport_5fcatalogue_2eproto);
 namespace serialize_transport_catalogue {
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* SectionType_descriptor() {
+  ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(&descriptor_table_transport_5fcatalogue_2eproto);
+  return file_level_enum_descriptors_transport_5fcatalogue_2eproto[0];
+}
+bool SectionType_IsValid(int value) {
+  switch (value) {
+    case 0:
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+      return true;
+    default:
+      return false;
+  }
+}
+
 
 // ===================================================================
 
@@ -1762,6 +1834,429 @@ void Database::InternalSwap(Database* other) {
       file_level_metadata_transport_5fcatalogue_2eproto[5]);
 }
 
+// ===================================================================
+
+class Section::_Internal {
+ public:
+};
+
+Section::Section(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:serialize_transport_catalogue.Section)
+}
+Section::Section(const Section& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  Section* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_.offset_){}
+    , decltype(_impl_.size_){}
+    , decltype(_impl_.type_){}
+    , /*decltype(_impl_._cached_size_)*/{}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  ::memcpy(&_impl_.offset_, &from._impl_.offset_,
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.type_) -
+    reinterpret_cast<char*>(&_impl_.offset_)) + sizeof(_impl_.type_));
+  // @@protoc_insertion_point(copy_constructor:serialize_transport_catalogue.Section)
+}
+
+inline void Section::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_.offset_){uint64_t{0u}}
+    , decltype(_impl_.size_){uint64_t{0u}}
+    , decltype(_impl_.type_){0}
+    , /*decltype(_impl_._cached_size_)*/{}
+  };
+}
+
+Section::~Section() {
+  // @@protoc_insertion_point(destructor:serialize_transport_catalogue.Section)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void Section::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+}
+
+void Section::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void Section::Clear() {
+// @@protoc_insertion_point(message_clear_start:serialize_transport_catalogue.Section)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  ::memset(&_impl_.offset_, 0, static_cast<size_t>(
+      reinterpret_cast<char*>(&_impl_.type_) -
+      reinterpret_cast<char*>(&_impl_.offset_)) + sizeof(_impl_.type_));
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* Section::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // .serialize_transport_catalogue.SectionType type = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 8)) {
+          uint64_t val = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+          _internal_set_type(static_cast<::serialize_transport_catalogue::SectionType>(val));
+        } else
+          goto handle_unusual;
+        continue;
+      // uint64 offset = 2;
+      case 2:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 16)) {
+          _impl_.offset_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // uint64 size = 3;
+      case 3:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 24)) {
+          _impl_.size_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* Section::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:serialize_transport_catalogue.Section)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // .serialize_transport_catalogue.SectionType type = 1;
+  if (this->_internal_type() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteEnumToArray(
+      1, this->_internal_type(), target);
+  }
+
+  // uint64 offset = 2;
+  if (this->_internal_offset() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt64ToArray(2, this->_internal_offset(), target);
+  }
+
+  // uint64 size = 3;
+  if (this->_internal_size() != 0) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt64ToArray(3, this->_internal_size(), target);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:serialize_transport_catalogue.Section)
+  return target;
+}
+
+size_t Section::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:serialize_transport_catalogue.Section)
+  size_t total_size = 0;
+
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // uint64 offset = 2;
+  if (this->_internal_offset() != 0) {
+    total_size += ::_pbi::WireFormatLite::UInt64SizePlusOne(this->_internal_offset());
+  }
+
+  // uint64 size = 3;
+  if (this->_internal_size() != 0) {
+    total_size += ::_pbi::WireFormatLite::UInt64SizePlusOne(this->_internal_size());
+  }
+
+  // .serialize_transport_catalogue.SectionType type = 1;
+  if (this->_internal_type() != 0) {
+    total_size += 1 +
+      ::_pbi::WireFormatLite::EnumSize(this->_internal_type());
+  }
+
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData Section::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    Section::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*Section::GetClassData() const { return &_class_data_; }
+
+
+void Section::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<Section*>(&to_msg);
+  auto& from = static_cast<const Section&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:serialize_transport_catalogue.Section)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  if (from._internal_offset() != 0) {
+    _this->_internal_set_offset(from._internal_offset());
+  }
+  if (from._internal_size() != 0) {
+    _this->_internal_set_size(from._internal_size());
+  }
+  if (from._internal_type() != 0) {
+    _this->_internal_set_type(from._internal_type());
+  }
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void Section::CopyFrom(const Section& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:serialize_transport_catalogue.Section)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool Section::IsInitialized() const {
+  return true;
+}
+
+void Section::InternalSwap(Section* other) {
+  using std::swap;
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  ::PROTOBUF_NAMESPACE_ID::internal::memswap<
+      PROTOBUF_FIELD_OFFSET(Section, _impl_.type_)
+      + sizeof(Section::_impl_.type_)
+      - PROTOBUF_FIELD_OFFSET(Section, _impl_.offset_)>(
+          reinterpret_cast<char*>(&_impl_.offset_),
+          reinterpret_cast<char*>(&other->_impl_.offset_));
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata Section::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_transport_5fcatalogue_2eproto_getter, &descriptor_table_transport_5fcatalogue_2eproto_once,
+      file_level_metadata_transport_5fcatalogue_2eproto[6]);
+}
+
+// ===================================================================
+
+class TableOfContents::_Internal {
+ public:
+};
+
+TableOfContents::TableOfContents(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:serialize_transport_catalogue.TableOfContents)
+}
+TableOfContents::TableOfContents(const TableOfContents& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  TableOfContents* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_.sections_){from._impl_.sections_}
+    , /*decltype(_impl_._cached_size_)*/{}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  // @@protoc_insertion_point(copy_constructor:serialize_transport_catalogue.TableOfContents)
+}
+
+inline void TableOfContents::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_.sections_){arena}
+    , /*decltype(_impl_._cached_size_)*/{}
+  };
+}
+
+TableOfContents::~TableOfContents() {
+  // @@protoc_insertion_point(destructor:serialize_transport_catalogue.TableOfContents)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void TableOfContents::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.sections_.~RepeatedPtrField();
+}
+
+void TableOfContents::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void TableOfContents::Clear() {
+// @@protoc_insertion_point(message_clear_start:serialize_transport_catalogue.TableOfContents)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  _impl_.sections_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* TableOfContents::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // repeated .serialize_transport_catalogue.Section sections = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 10)) {
+          ptr -= 1;
+          do {
+            ptr += 1;
+            ptr = ctx->ParseMessage(_internal_add_sections(), ptr);
+            CHK_(ptr);
+            if (!ctx->DataAvailable(ptr)) break;
+          } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<10>(ptr));
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* TableOfContents::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:serialize_transport_catalogue.TableOfContents)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // repeated .serialize_transport_catalogue.Section sections = 1;
+  for (unsigned i = 0,
+      n = static_cast<unsigned>(this->_internal_sections_size()); i < n; i++) {
+    const auto& repfield = this->_internal_sections(i);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+        InternalWriteMessage(1, repfield, repfield.GetCachedSize(), target, stream);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:serialize_transport_catalogue.TableOfContents)
+  return target;
+}
+
+size_t TableOfContents::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:serialize_transport_catalogue.TableOfContents)
+  size_t total_size = 0;
+
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // repeated .serialize_transport_catalogue.Section sections = 1;
+  total_size += 1UL * this->_internal_sections_size();
+  for (const auto& msg : this->_impl_.sections_) {
+    total_size +=
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(msg);
+  }
+
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData TableOfContents::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    TableOfContents::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*TableOfContents::GetClassData() const { return &_class_data_; }
+
+
+void TableOfContents::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<TableOfContents*>(&to_msg);
+  auto& from = static_cast<const TableOfContents&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:serialize_transport_catalogue.TableOfContents)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  _this->_impl_.sections_.MergeFrom(from._impl_.sections_);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void TableOfContents::CopyFrom(const TableOfContents& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:serialize_transport_catalogue.TableOfContents)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool TableOfContents::IsInitialized() const {
+  return true;
+}
+
+void TableOfContents::InternalSwap(TableOfContents* other) {
+  using std::swap;
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  _impl_.sections_.InternalSwap(&other->_impl_.sections_);
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata TableOfContents::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_transport_5fcatalogue_2eproto_getter, &descriptor_table_transport_5fcatalogue_2eproto_once,
+      file_level_metadata_transport_5fcatalogue_2eproto[7]);
+}
+
 // @@protoc_insertion_point(namespace_scope)
 }  // namespace serialize_transport_catalogue
 PROTOBUF_NAMESPACE_OPEN
@@ -1789,6 +2284,14 @@ template<> PROTOBUF_NOINLINE ::serialize_transport_catalogue::Database*
 Arena::CreateMaybeMessage< ::serialize_transport_catalogue::Database >(Arena* arena) {
   return Arena::CreateMessageInternal< ::serialize_transport_catalogue::Database >(arena);
 }
+template<> PROTOBUF_NOINLINE ::serialize_transport_catalogue::Section*
+Arena::CreateMaybeMessage< ::serialize_transport_catalogue::Section >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::serialize_transport_catalogue::Section >(arena);
+}
+template<> PROTOBUF_NOINLINE ::serialize_transport_catalogue::TableOfContents*
+Arena::CreateMaybeMessage< ::serialize_transport_catalogue::TableOfContents >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::serialize_transport_catalogue::TableOfContents >(arena);
+}
 PROTOBUF_NAMESPACE_CLOSE
 
 // @@protoc_insertion_point(global_scope)
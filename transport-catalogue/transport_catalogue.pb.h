@@ -29,6 +29,7 @@
 #include <google/protobuf/message.h>
 #include <google/protobuf/repeated_field.h>  // IWYU pragma: export
 #include <google/protobuf/extension_set.h>  // IWYU pragma: export
+#include <google/protobuf/generated_enum_reflection.h>
 #include <google/protobuf/unknown_field_set.h>
 #include "map_renderer.pb.h"
 #include "graph.pb.h"
@@ -56,12 +57,18 @@ extern CoordinatesDefaultTypeInternal _Coordinates_default_instance_;
 class Database;
 struct DatabaseDefaultTypeInternal;
 extern DatabaseDefaultTypeInternal _Database_default_instance_;
+class Section;
+struct SectionDefaultTypeInternal;
+extern SectionDefaultTypeInternal _Section_default_instance_;
 class Stop;
 struct StopDefaultTypeInternal;
 extern StopDefaultTypeInternal _Stop_default_instance_;
 class StopDistance;
 struct StopDistanceDefaultTypeInternal;
 extern StopDistanceDefaultTypeInternal _StopDistance_default_instance_;
+class TableOfContents;
+struct TableOfContentsDefaultTypeInternal;
+extern TableOfContentsDefaultTypeInternal _TableOfContents_default_instance_;
 class TransportCatalogue;
 struct TransportCatalogueDefaultTypeInternal;
 extern TransportCatalogueDefaultTypeInternal _TransportCatalogue_default_instance_;
@@ -70,12 +77,42 @@ PROTOBUF_NAMESPACE_OPEN
 template<> ::serialize_transport_catalogue::Bus* Arena::CreateMaybeMessage<::serialize_transport_catalogue::Bus>(Arena*);
 template<> ::serialize_transport_catalogue::Coordinates* Arena::CreateMaybeMessage<::serialize_transport_catalogue::Coordinates>(Arena*);
 template<> ::serialize_transport_catalogue::Database* Arena::CreateMaybeMessage<::serialize_transport_catalogue::Database>(Arena*);
+template<> ::serialize_transport_catalogue::Section* Arena::CreateMaybeMessage<::serialize_transport_catalogue::Section>(Arena*);
 template<> ::serialize_transport_catalogue::Stop* Arena::CreateMaybeMessage<::serialize_transport_catalogue::Stop>(Arena*);
 template<> ::serialize_transport_catalogue::StopDistance* Arena::CreateMaybeMessage<::serialize_transport_catalogue::StopDistance>(Arena*);
+template<> ::serialize_transport_catalogue::TableOfContents* Arena::CreateMaybeMessage<::serialize_transport_catalogue::TableOfContents>(Arena*);
 template<> ::serialize_transport_catalogue::TransportCatalogue* Arena::CreateMaybeMessage<::serialize_transport_catalogue::TransportCatalogue>(Arena*);
 PROTOBUF_NAMESPACE_CLOSE
 namespace serialize_transport_catalogue {
 
+enum SectionType : int {
+  CATALOGUE = 0,
+  RENDER_SETTINGS = 1,
+  GRAPH_INFO = 2,
+  CONTRACTION_HIERARCHY = 3,
+  ROUTING_SETTINGS = 4,
+  SectionType_INT_MIN_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::min(),
+  SectionType_INT_MAX_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::max()
+};
+bool SectionType_IsValid(int value);
+constexpr SectionType SectionType_MIN = CATALOGUE;
+constexpr SectionType SectionType_MAX = ROUTING_SETTINGS;
+constexpr int SectionType_ARRAYSIZE = SectionType_MAX + 1;
+
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* SectionType_descriptor();
+template<typename T>
+inline const std::string& SectionType_Name(T enum_t_value) {
+  static_assert(::std::is_same<T, SectionType>::value ||
+    ::std::is_integral<T>::value,
+    "Incorrect type passed to function SectionType_Name.");
+  return ::PROTOBUF_NAMESPACE_ID::internal::NameOfEnum(
+    SectionType_descriptor(), enum_t_value);
+}
+inline bool SectionType_Parse(
+    ::PROTOBUF_NAMESPACE_ID::ConstStringParam name, SectionType* value) {
+  return ::PROTOBUF_NAMESPACE_ID::internal::ParseNamedEnum<SectionType>(
+    SectionType_descriptor(), name, value);
+}
 // ===================================================================
 
 class Coordinates final :
@@ -1161,6 +1198,333 @@ class Database final :
   union { Impl_ _impl_; };
   friend struct ::TableStruct_transport_5fcatalogue_2eproto;
 };
+// -------------------------------------------------------------------
+
+class Section final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:serialize_transport_catalogue.Section) */ {
+ public:
+  inline Section() : Section(nullptr) {}
+  ~Section() override;
+  explicit PROTOBUF_CONSTEXPR Section(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  Section(const Section& from);
+  Section(Section&& from) noexcept
+    : Section() {
+    *this = ::std::move(from);
+  }
+
+  inline Section& operator=(const Section& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline Section& operator=(Section&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const Section& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const Section* internal_default_instance() {
+    return reinterpret_cast<const Section*>(
+               &_Section_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    6;
+
+  friend void swap(Section& a, Section& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(Section* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(Section* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  Section* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<Section>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const Section& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const Section& from) {
+    Section::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(Section* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "serialize_transport_catalogue.Section";
+  }
+  protected:
+  explicit Section(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kOffsetFieldNumber = 2,
+    kSizeFieldNumber = 3,
+    kTypeFieldNumber = 1,
+  };
+  // uint64 offset = 2;
+  void clear_offset();
+  uint64_t offset() const;
+  void set_offset(uint64_t value);
+  private:
+  uint64_t _internal_offset() const;
+  void _internal_set_offset(uint64_t value);
+  public:
+
+  // uint64 size = 3;
+  void clear_size();
+  uint64_t size() const;
+  void set_size(uint64_t value);
+  private:
+  uint64_t _internal_size() const;
+  void _internal_set_size(uint64_t value);
+  public:
+
+  // .serialize_transport_catalogue.SectionType type = 1;
+  void clear_type();
+  ::serialize_transport_catalogue::SectionType type() const;
+  void set_type(::serialize_transport_catalogue::SectionType value);
+  private:
+  ::serialize_transport_catalogue::SectionType _internal_type() const;
+  void _internal_set_type(::serialize_transport_catalogue::SectionType value);
+  public:
+
+  // @@protoc_insertion_point(class_scope:serialize_transport_catalogue.Section)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    uint64_t offset_;
+    uint64_t size_;
+    int type_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_transport_5fcatalogue_2eproto;
+};
+// -------------------------------------------------------------------
+
+class TableOfContents final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:serialize_transport_catalogue.TableOfContents) */ {
+ public:
+  inline TableOfContents() : TableOfContents(nullptr) {}
+  ~TableOfContents() override;
+  explicit PROTOBUF_CONSTEXPR TableOfContents(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  TableOfContents(const TableOfContents& from);
+  TableOfContents(TableOfContents&& from) noexcept
+    : TableOfContents() {
+    *this = ::std::move(from);
+  }
+
+  inline TableOfContents& operator=(const TableOfContents& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline TableOfContents& operator=(TableOfContents&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const TableOfContents& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const TableOfContents* internal_default_instance() {
+    return reinterpret_cast<const TableOfContents*>(
+               &_TableOfContents_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    7;
+
+  friend void swap(TableOfContents& a, TableOfContents& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(TableOfContents* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(TableOfContents* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  TableOfContents* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<TableOfContents>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const TableOfContents& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const TableOfContents& from) {
+    TableOfContents::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(TableOfContents* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "serialize_transport_catalogue.TableOfContents";
+  }
+  protected:
+  explicit TableOfContents(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kSectionsFieldNumber = 1,
+  };
+  // repeated .serialize_transport_catalogue.Section sections = 1;
+  int sections_size() const;
+  private:
+  int _internal_sections_size() const;
+  public:
+  void clear_sections();
+  ::serialize_transport_catalogue::Section* mutable_sections(int index);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::serialize_transport_catalogue::Section >*
+      mutable_sections();
+  private:
+  const ::serialize_transport_catalogue::Section& _internal_sections(int index) const;
+  ::serialize_transport_catalogue::Section* _internal_add_sections();
+  public:
+  const ::serialize_transport_catalogue::Section& sections(int index) const;
+  ::serialize_transport_catalogue::Section* add_sections();
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::serialize_transport_catalogue::Section >&
+      sections() const;
+
+  // @@protoc_insertion_point(class_scope:serialize_transport_catalogue.TableOfContents)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::serialize_transport_catalogue::Section > sections_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_transport_5fcatalogue_2eproto;
+};
 // ===================================================================
 
 
@@ -1929,6 +2293,114 @@ inline void Database::set_allocated_graph_info(::serialize_transport_catalogue::
   // @@protoc_insertion_point(field_set_allocated:serialize_transport_catalogue.Database.graph_info)
 }
 
+// -------------------------------------------------------------------
+
+// Section
+
+// .serialize_transport_catalogue.SectionType type = 1;
+inline void Section::clear_type() {
+  _impl_.type_ = 0;
+}
+inline ::serialize_transport_catalogue::SectionType Section::_internal_type() const {
+  return static_cast< ::serialize_transport_catalogue::SectionType >(_impl_.type_);
+}
+inline ::serialize_transport_catalogue::SectionType Section::type() const {
+  // @@protoc_insertion_point(field_get:serialize_transport_catalogue.Section.type)
+  return _internal_type();
+}
+inline void Section::_internal_set_type(::serialize_transport_catalogue::SectionType value) {
+  
+  _impl_.type_ = value;
+}
+inline void Section::set_type(::serialize_transport_catalogue::SectionType value) {
+  _internal_set_type(value);
+  // @@protoc_insertion_point(field_set:serialize_transport_catalogue.Section.type)
+}
+
+// uint64 offset = 2;
+inline void Section::clear_offset() {
+  _impl_.offset_ = uint64_t{0u};
+}
+inline uint64_t Section::_internal_offset() const {
+  return _impl_.offset_;
+}
+inline uint64_t Section::offset() const {
+  // @@protoc_insertion_point(field_get:serialize_transport_catalogue.Section.offset)
+  return _internal_offset();
+}
+inline void Section::_internal_set_offset(uint64_t value) {
+  
+  _impl_.offset_ = value;
+}
+inline void Section::set_offset(uint64_t value) {
+  _internal_set_offset(value);
+  // @@protoc_insertion_point(field_set:serialize_transport_catalogue.Section.offset)
+}
+
+// uint64 size = 3;
+inline void Section::clear_size() {
+  _impl_.size_ = uint64_t{0u};
+}
+inline uint64_t Section::_internal_size() const {
+  return _impl_.size_;
+}
+inline uint64_t Section::size() const {
+  // @@protoc_insertion_point(field_get:serialize_transport_catalogue.Section.size)
+  return _internal_size();
+}
+inline void Section::_internal_set_size(uint64_t value) {
+  
+  _impl_.size_ = value;
+}
+inline void Section::set_size(uint64_t value) {
+  _internal_set_size(value);
+  // @@protoc_insertion_point(field_set:serialize_transport_catalogue.Section.size)
+}
+
+// -------------------------------------------------------------------
+
+// TableOfContents
+
+// repeated .serialize_transport_catalogue.Section sections = 1;
+inline int TableOfContents::_internal_sections_size() const {
+  return _impl_.sections_.size();
+}
+inline int TableOfContents::sections_size() const {
+  return _internal_sections_size();
+}
+inline void TableOfContents::clear_sections() {
+  _impl_.sections_.Clear();
+}
+inline ::serialize_transport_catalogue::Section* TableOfContents::mutable_sections(int index) {
+  // @@protoc_insertion_point(field_mutable:serialize_transport_catalogue.TableOfContents.sections)
+  return _impl_.sections_.Mutable(index);
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::serialize_transport_catalogue::Section >*
+TableOfContents::mutable_sections() {
+  // @@protoc_insertion_point(field_mutable_list:serialize_transport_catalogue.TableOfContents.sections)
+  return &_impl_.sections_;
+}
+inline const ::serialize_transport_catalogue::Section& TableOfContents::_internal_sections(int index) const {
+  return _impl_.sections_.Get(index);
+}
+inline const ::serialize_transport_catalogue::Section& TableOfContents::sections(int index) const {
+  // @@protoc_insertion_point(field_get:serialize_transport_catalogue.TableOfContents.sections)
+  return _internal_sections(index);
+}
+inline ::serialize_transport_catalogue::Section* TableOfContents::_internal_add_sections() {
+  return _impl_.sections_.Add();
+}
+inline ::serialize_transport_catalogue::Section* TableOfContents::add_sections() {
+  ::serialize_transport_catalogue::Section* _add = _internal_add_sections();
+  // @@protoc_insertion_point(field_add:serialize_transport_catalogue.TableOfContents.sections)
+  return _add;
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::serialize_transport_catalogue::Section >&
+TableOfContents::sections() const {
+  // @@protoc_insertion_point(field_list:serialize_transport_catalogue.TableOfContents.sections)
+  return _impl_.sections_;
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
@@ -1942,11 +2414,25 @@ inline void Database::set_allocated_graph_info(::serialize_transport_catalogue::
 
 // -------------------------------------------------------------------
 
+// -------------------------------------------------------------------
+
+// -------------------------------------------------------------------
+
 
 // @@protoc_insertion_point(namespace_scope)
 
 }  // namespace serialize_transport_catalogue
 
+PROTOBUF_NAMESPACE_OPEN
+
+template <> struct is_proto_enum< ::serialize_transport_catalogue::SectionType> : ::std::true_type {};
+template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::serialize_transport_catalogue::SectionType>() {
+  return ::serialize_transport_catalogue::SectionType_descriptor();
+}
+
+PROTOBUF_NAMESPACE_CLOSE
+
 // @@protoc_insertion_point(global_scope)
 
 #include <google/protobuf/port_undef.inc>
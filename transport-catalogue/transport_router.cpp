@@ -1,13 +1,17 @@
 #include <exception>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <ostream>
+#include <queue>
 #include <sstream>
 #include <cassert>
 #include <stdexcept>
 #include <variant>
 
 #include "domain.h"
+#include "generator.h"
 #include "geo.h"
 #include "graph.pb.h"
 #include "router.h"
@@ -15,6 +19,8 @@
 #include "transport_router.h"
 #include "json_reader.h"
 #include "graph.h"
+#include "parallel.h"
+#include "stats.h"
 
 namespace transport_router {
 
@@ -66,73 +72,132 @@ void TransportRouter::EnumerateVertecies(std::string_view stop_name) {
 }
 
 void TransportRouter::BuildGraph() {
-    std::vector<std::string_view> bus_names = catalogue_->GetBusNames();
-    
-    for (std::string_view bus_name : bus_names) {
+    stats::ScopedTimer timer("build_graph");
 
-        const domain::BusPtr bus_ptr = catalogue_->FindBus(bus_name);
-        
-        const std::vector<domain::StopPtr>& route = bus_ptr->route;
+    std::vector<domain::BusPtr> buses;
+    for (std::string_view bus_name : catalogue_->GetBusNames()) {
+        buses.push_back(catalogue_->FindBus(bus_name));
+    }
 
-        /* This is by far the trickiest part of the code. This vector will
-         * contain time and span counts of the first route.size() - 1 edges. 
-         * Such measurements will allow us to quickly compute distances. */
-        std::vector<BusEdgeInfo> edge_measurements(route.size() - 1);
-        
-        EnumerateVertecies(route.front()->name);
+    /* Vertex ids are assigned up front, in the order stops first appear on
+     * the routes, so every bus block below only reads the vertex maps */
+    for (const domain::BusPtr bus_ptr : buses) {
+        for (const domain::StopPtr stop_ptr : bus_ptr->route) {
+            EnumerateVertecies(stop_ptr->name);
+        }
+    }
 
-        for (auto from_iter =  route.begin(); 
-                  from_iter != (route.end() - 1); from_iter++) {
+    // Every bus owns a contiguous block of edges starting at its offset
+    std::vector<size_t> offsets(buses.size() + 1, 0);
+    for (size_t i = 0; i < buses.size(); ++i) {
+        offsets[i + 1] = offsets[i] + CountBusEdges(buses[i]);
+    }
 
-            const domain::StopPtr from_ptr = *from_iter;
+    std::vector<graph::Edge<Weight>> edges(offsets.back());
+    std::vector<BusEdgeInfo> edges_info(offsets.back());
 
-            for (auto to_iter = from_iter + 1; 
-                      to_iter != route.end(); to_iter++) {
+    parallel::ForEachChunk(buses.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            AssembleBusEdges(buses[i], edges.data() + offsets[i], 
+                                       edges_info.data() + offsets[i]);
+        }
+    }, 16);
 
-                const domain::StopPtr to_ptr = *to_iter;
+    route_graph_->ReserveEdges(route_graph_->GetEdgeCount() + edges.size());
+    bus_edge_id_to_edge_info_.reserve(edges.size());
 
-                EnumerateVertecies(to_ptr->name);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const EdgeId route_edge = route_graph_->AddEdge(edges[i]);
+        bus_edge_id_to_edge_info_[route_edge] = std::move(edges_info[i]);
+    }
 
-                BusEdgeInfo edge_info;
+    AddGraphCounters();
+}
 
-                /* For the first route.size() - 1 edges all the measurements 
-                 * will be computed head-on, but for any others it'll be done at 
-                 * constant time. */
-                if (from_iter == route.begin()) {
-                    edge_info = AssembleBusEdgeInfo(from_iter, to_iter, 
-                                                               bus_ptr);
-                    edge_measurements[to_iter - from_iter - 1] = edge_info; 
-                } else {
-                    const auto& l_info {
-                        edge_measurements.at(from_iter - route.begin() - 1)        
-                    };
-
-                    const auto& r_info {
-                        edge_measurements.at(to_iter - route.begin() - 1)
-                    };
-
-                    edge_info = {
-                        bus_ptr->name,
-                        r_info.span_count - l_info.span_count,
-                        static_cast<Weight>(
-                            r_info.total_time - l_info.total_time
-                        )
-                    };
-                }
+size_t TransportRouter::CountBusEdges(domain::BusPtr bus_ptr) {
+    const size_t stop_count = bus_ptr->route.size();
+    return stop_count * (stop_count - 1) / 2;
+}
+
+void TransportRouter::AddBusEdges(domain::BusPtr bus_ptr) {
+    for (const domain::StopPtr stop_ptr : bus_ptr->route) {
+        EnumerateVertecies(stop_ptr->name);
+    }
+
+    std::vector<graph::Edge<Weight>> edges(CountBusEdges(bus_ptr));
+    std::vector<BusEdgeInfo> edges_info(edges.size());
 
-                EdgeId route_edge = route_graph_->AddEdge({
-                /* "from":   */ stop_name_to_bus_vertex_id_.at(from_ptr->name),
-                /* "to":     */ stop_name_to_wait_vertex_id_.at(to_ptr->name),
-                /* "weight": */ edge_info.total_time
-                });
+    AssembleBusEdges(bus_ptr, edges.data(), edges_info.data());
 
-                bus_edge_id_to_edge_info_[route_edge] = std::move(edge_info);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const EdgeId route_edge = route_graph_->AddEdge(edges[i]);
+        bus_edge_id_to_edge_info_[route_edge] = std::move(edges_info[i]);
+    }
+}
+
+void TransportRouter::AssembleBusEdges(domain::BusPtr bus_ptr,
+                                       graph::Edge<Weight>* edges_out,
+                                       BusEdgeInfo* edges_info_out) const {
+    const domain::Route& route = bus_ptr->route;
+
+    if (route.size() < 2) return;
+
+    /* This is by far the trickiest part of the code. This vector will
+     * contain time and span counts of the first route.size() - 1 edges. 
+     * Such measurements will allow us to quickly compute distances. */
+    std::vector<BusEdgeInfo> edge_measurements(route.size() - 1);
+
+    for (auto from_iter =  route.begin(); 
+              from_iter != (route.end() - 1); from_iter++) {
+
+        const domain::StopPtr from_ptr = *from_iter;
+
+        for (auto to_iter = from_iter + 1; 
+                  to_iter != route.end(); to_iter++) {
+
+            const domain::StopPtr to_ptr = *to_iter;
+
+            BusEdgeInfo edge_info;
+
+            /* For the first route.size() - 1 edges all the measurements 
+             * will be computed head-on, but for any others it'll be done at 
+             * constant time. */
+            if (from_iter == route.begin()) {
+                edge_info = AssembleBusEdgeInfo(from_iter, to_iter, 
+                                                           bus_ptr);
+                edge_measurements[to_iter - from_iter - 1] = edge_info; 
+            } else {
+                const auto& l_info {
+                    edge_measurements.at(from_iter - route.begin() - 1)        
+                };
+
+                const auto& r_info {
+                    edge_measurements.at(to_iter - route.begin() - 1)
+                };
+
+                edge_info = {
+                    bus_ptr->name,
+                    r_info.span_count - l_info.span_count,
+                    static_cast<Weight>(
+                        r_info.total_time - l_info.total_time
+                    )
+                };
             }
+
+            *edges_out++ = {
+            /* "from":   */ stop_name_to_bus_vertex_id_.at(from_ptr->name),
+            /* "to":     */ stop_name_to_wait_vertex_id_.at(to_ptr->name),
+            /* "weight": */ edge_info.total_time
+            };
+
+            *edges_info_out++ = std::move(edge_info);
         }
     }
 }
 
 void TransportRouter::BuildGraphFromInfo(const TransportRouterInfo& info) {
+    stats::ScopedTimer timer("build_graph_from_base");
+
     for (const TransportRouterInfo::VertexInfo& v_info : info.GetVertexesInfo()) {
         auto stop_ptr = catalogue_->FindStop(v_info.stop_name);
 
@@ -174,6 +239,75 @@ void TransportRouter::BuildGraphFromInfo(const TransportRouterInfo& info) {
 
         wait_edge_id_to_edge_info_[edge] = std::move(edge_info);
     }
+
+    AddGraphCounters();
+}
+
+void TransportRouter::BuildGraphIncrementally(
+                const TransportRouterInfo& info,
+                const std::unordered_set<std::string_view>& stale_bus_names) {
+    stats::ScopedTimer timer("build_graph_incrementally");
+
+    // Old vertex ids are mapped back to stop names to be renumbered
+    std::unordered_map<VertexId, std::string_view> old_wait_vertex_to_stop;
+    std::unordered_map<VertexId, std::string_view> old_bus_vertex_to_stop;
+    std::vector<VertexId> old_wait_vertexes;
+
+    for (const TransportRouterInfo::VertexInfo& v_info : info.GetVertexesInfo()) {
+        if (v_info.is_bus_vertex) {
+            old_bus_vertex_to_stop[v_info.id] = v_info.stop_name;
+        } else {
+            old_wait_vertex_to_stop[v_info.id] = v_info.stop_name;
+            old_wait_vertexes.push_back(v_info.id);
+        }
+    }
+
+    /* Surviving stops keep their relative order, so unaffected parts 
+     * of the graph stay the way they were */
+    std::sort(old_wait_vertexes.begin(), old_wait_vertexes.end());
+
+    for (const VertexId old_id : old_wait_vertexes) {
+        const std::string_view stop_name = old_wait_vertex_to_stop.at(old_id);
+
+        // Stops that are gone or no longer served by any bus lose their vertexes
+        if (!catalogue_->HasStop(stop_name) 
+            || catalogue_->FindStop(stop_name)->buses.empty()) continue;
+
+        EnumerateVertecies(catalogue_->FindStop(stop_name)->name);
+    }
+
+    for (const TransportRouterInfo::EdgeInfo& e_info : info.GetEdgesInfo()) {
+        if (!e_info.is_bus_edge
+            || stale_bus_names.count(e_info.name) > 0
+            || !catalogue_->HasBus(e_info.name)) continue;
+
+        const domain::BusPtr bus_ptr = catalogue_->FindBus(e_info.name);
+        const std::string_view from_stop = old_bus_vertex_to_stop.at(e_info.from);
+        const std::string_view to_stop = old_wait_vertex_to_stop.at(e_info.to);
+
+        EdgeId edge = route_graph_->AddEdge({
+            stop_name_to_bus_vertex_id_.at(from_stop),
+            stop_name_to_wait_vertex_id_.at(to_stop),
+            e_info.weight
+        });
+
+        bus_edge_id_to_edge_info_[edge] = { bus_ptr->name, 
+                                            e_info.span_count, 
+                                            e_info.weight };
+    }
+
+    for (const std::string_view bus_name : catalogue_->GetBusNames()) {
+        if (stale_bus_names.count(bus_name) == 0) continue;
+
+        AddBusEdges(catalogue_->FindBus(bus_name));
+    }
+
+    AddGraphCounters();
+}
+
+void TransportRouter::AddGraphCounters() const {
+    stats::AddCounter("graph_vertices", route_graph_->GetVertexCount());
+    stats::AddCounter("graph_edges", route_graph_->GetEdgeCount());
 }
 
 std::optional<TransportRouter::VertexId> TransportRouter::GetStopVertexId(
@@ -217,20 +351,83 @@ std::optional<RoutingResult> TransportRouter::BuildRoute(
         return RoutingResult{ /* "total_time": */ 0.0, /* "items": */ {} };
     }
 
+    // A* needs neither the table nor the hierarchy built
+    if (settings_.a_star && !settings_.contraction_hierarchy) {
+        return SearchRoute(from, to, true);
+    }
+
     // Try building a route
-    std::optional<Router::RouteInfo> route_info = router_->BuildRoute(*from_opt, 
-                                                                      *to_opt);
+    const ContractionHierarchy* hierarchy = GetContractionHierarchy();
+    std::optional<Router::RouteInfo> route_info = hierarchy 
+                        ? hierarchy->BuildRoute(*from_opt, *to_opt)
+                        : GetRouter().BuildRoute(*from_opt, *to_opt);
     // If building a route failed, return nothing
     if (!route_info.has_value()) return std::nullopt;
 
-    std::vector<RouteItem> route_items;
+    return AssembleRoutingResult(*route_info);
+}
 
-    RouteItemBus current_bus;
+std::optional<RoutingResult> TransportRouter::SearchRoute(
+                                            std::string_view from,
+                                            std::string_view to,
+                                            bool use_lower_bound,
+                                            size_t* settled_count) const {
+    const std::optional<VertexId> from_opt = GetStopVertexId(from);
+    if (!from_opt.has_value()) return std::nullopt;
+
+    const std::optional<VertexId> to_opt = GetStopVertexId(to);
+    if (!to_opt.has_value()) return std::nullopt;
+
+    if (from == to) {
+        return RoutingResult{ /* "total_time": */ 0.0, /* "items": */ {} };
+    }
+
+    const std::optional<Router::RouteInfo> route_info = 
+                SearchRouteInfo(*from_opt, *to_opt, use_lower_bound, settled_count);
+    if (!route_info.has_value()) return std::nullopt;
+
+    return AssembleRoutingResult(*route_info);
+}
+
+std::optional<TransportRouter::Router::RouteInfo> 
+TransportRouter::SearchRouteInfo(VertexId from, VertexId to, 
+                                 bool use_lower_bound,
+                                 size_t* settled_count) const {
+    if (!use_lower_bound) {
+        return graph::FindRoute(*route_graph_, from, to, 
+                                [](VertexId) { return Weight{}; }, 
+                                settled_count);
+    }
+
+    const GeoBound& geo_bound = GetGeoBound();
+    const domain::StopPtr target = geo_bound.vertex_stops[to];
+
+    /* Going to another stop takes at least a ride over the distance between
+     * them at the top speed, and from a wait vertex one more wait */
+    auto lower_bound = [&geo_bound, target, this](VertexId vertex) {
+        const domain::StopPtr stop = geo_bound.vertex_stops[vertex];
+        if (!stop || stop == target) {
+            return Weight{};
+        }
+
+        const double distance = geo::ComputeDistance(stop->coordinates, 
+                                                     target->coordinates);
+        return distance / geo_bound.max_speed
+             + (geo_bound.is_wait_vertex[vertex] ? settings_.bus_wait_time 
+                                                 : Weight{});
+    };
+
+    return graph::FindRoute(*route_graph_, from, to, lower_bound, settled_count);
+}
+
+RoutingResult TransportRouter::AssembleRoutingResult(
+                                    const Router::RouteInfo& route_info) const {
+    std::vector<RouteItem> route_items;
 
     Weight total_time{};
 
     // For every edge create two items: wait and bus.
-    for (EdgeId edge_id : route_info->edges) {
+    for (EdgeId edge_id : route_info.edges) {
         if (IsBusEdge(edge_id)) {
             auto edge_info = GetBusEdgeInfo(edge_id); 
 
@@ -252,6 +449,190 @@ std::optional<RoutingResult> TransportRouter::BuildRoute(
     return RoutingResult{ total_time, route_items };
 }
 
+RouteMatrix TransportRouter::BuildRouteMatrix(
+                    const std::vector<std::string_view>& origins,
+                    const std::vector<std::string_view>& destinations) const {
+    std::vector<std::optional<VertexId>> origin_ids;
+    origin_ids.reserve(origins.size());
+    for (const std::string_view origin : origins) {
+        origin_ids.push_back(GetStopVertexId(origin));
+    }
+
+    std::vector<std::optional<VertexId>> destination_ids;
+    destination_ids.reserve(destinations.size());
+    for (const std::string_view destination : destinations) {
+        destination_ids.push_back(GetStopVertexId(destination));
+    }
+
+    /* The table, the hierarchy or the lower bound is built here, the 
+     * threads below only read it */
+    const bool use_a_star = settings_.a_star && !settings_.contraction_hierarchy;
+    if (use_a_star) {
+        GetGeoBound();
+    }
+    const ContractionHierarchy* hierarchy = GetContractionHierarchy();
+    const Router* router = hierarchy || use_a_star ? nullptr : &GetRouter();
+
+    RouteMatrix matrix(origins.size(), 
+                       std::vector<std::optional<Weight>>(destinations.size()));
+
+    parallel::ForEachChunk(origins.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (!origin_ids[i].has_value()) continue;
+
+            for (size_t j = 0; j < destinations.size(); ++j) {
+                if (!destination_ids[j].has_value()) continue;
+
+                const VertexId from = *origin_ids[i];
+                const VertexId to = *destination_ids[j];
+                if (router) {
+                    matrix[i][j] = router->GetRouteWeight(from, to);
+                    continue;
+                }
+
+                const auto route = hierarchy ? hierarchy->BuildRoute(from, to)
+                                             : SearchRouteInfo(from, to, true);
+                if (route) {
+                    matrix[i][j] = route->weight;
+                }
+            }
+        }
+    }, 16);
+
+    return matrix;
+}
+
+std::optional<std::vector<ReachableStop>> TransportRouter::BuildIsochrone(
+                                        std::string_view stop_name,
+                                        Weight max_time) const {
+    const std::optional<VertexId> origin = GetStopVertexId(stop_name);
+    if (!origin.has_value()) return std::nullopt;
+
+    std::vector<Weight> times(route_graph_->GetVertexCount(), 
+                              std::numeric_limits<Weight>::infinity());
+    times[*origin] = 0;
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, 
+                        std::greater<QueueItem>> queue;
+    queue.push({ 0, *origin });
+
+    std::vector<ReachableStop> reachable_stops;
+
+    while (!queue.empty()) {
+        const auto [time, vertex] = queue.top();
+        queue.pop();
+        if (times[vertex] < time) {
+            continue;
+        }
+
+        /* Arriving at a stop is reaching its wait vertex, the only edge
+         * going out of it is the wait edge */
+        const auto edges = route_graph_->GetIncidentEdges(vertex);
+        if (edges.begin() != edges.end() && IsWaitEdge(*edges.begin())) {
+            reachable_stops.push_back({ GetWaitEdgeInfo(*edges.begin()).stop_name, 
+                                        time });
+        }
+
+        for (const EdgeId edge_id : edges) {
+            const auto& edge = route_graph_->GetEdge(edge_id);
+            const Weight candidate_time = time + edge.weight;
+
+            if (candidate_time <= max_time && candidate_time < times[edge.to]) {
+                times[edge.to] = candidate_time;
+                queue.push({ candidate_time, edge.to });
+            }
+        }
+    }
+
+    return reachable_stops;
+}
+
+RoutingSettings TransportRouter::GetRoutingSettings() const {
+    return settings_;
+}
+
+const TransportRouter::Router& TransportRouter::GetRouter() const {
+    if (!router_) {
+        stats::ScopedTimer timer("router_table");
+        router_ = std::make_unique<Router>(*route_graph_);
+    }
+
+    return *router_;
+}
+
+const TransportRouter::GeoBound& TransportRouter::GetGeoBound() const {
+    constexpr double METERS_PER_KM = 1000;
+
+    constexpr double MIN_PER_HOUR  = 60;
+
+    if (geo_bound_) {
+        return *geo_bound_;
+    }
+
+    auto geo_bound = std::make_unique<GeoBound>();
+    geo_bound->vertex_stops.assign(route_graph_->GetVertexCount(), nullptr);
+    geo_bound->is_wait_vertex.assign(route_graph_->GetVertexCount(), false);
+
+    for (const auto& [stop_name, vertex_id] : stop_name_to_wait_vertex_id_) {
+        geo_bound->vertex_stops[vertex_id] = catalogue_->FindStop(stop_name);
+        geo_bound->is_wait_vertex[vertex_id] = true;
+    }
+    for (const auto& [stop_name, vertex_id] : stop_name_to_bus_vertex_id_) {
+        geo_bound->vertex_stops[vertex_id] = catalogue_->FindStop(stop_name);
+    }
+
+    double max_ratio = 0;
+    for (const std::string_view bus_name : catalogue_->GetBusNames()) {
+        const domain::Route& route = catalogue_->FindBus(bus_name)->route;
+
+        for (size_t i = 1; i < route.size(); ++i) {
+            const double geo_distance = geo::ComputeDistance(
+                            route[i - 1]->coordinates, route[i]->coordinates);
+            const int road_distance = catalogue_->GetDistance(route[i - 1]->name,
+                                                              route[i]->name);
+            if (geo_distance == 0) {
+                continue;
+            }
+
+            max_ratio = road_distance > 0 
+                      ? std::max(max_ratio, geo_distance / road_distance)
+                      : std::numeric_limits<double>::infinity();
+        }
+    }
+
+    // Without rides the bound is never used for another stop
+    geo_bound->max_speed = max_ratio > 0
+        ? settings_.bus_velocity * (METERS_PER_KM / MIN_PER_HOUR) * max_ratio
+        : std::numeric_limits<double>::infinity();
+
+    geo_bound_ = std::move(geo_bound);
+    return *geo_bound_;
+}
+
+const TransportRouter::ContractionHierarchy* 
+TransportRouter::GetContractionHierarchy() const {
+    if (!settings_.contraction_hierarchy) {
+        return nullptr;
+    }
+
+    if (!contraction_hierarchy_) {
+        stats::ScopedTimer timer("contraction_hierarchy");
+        contraction_hierarchy_ = std::make_unique<ContractionHierarchy>(
+                                                                *route_graph_);
+        stats::AddCounter("contraction_shortcuts", 
+                          contraction_hierarchy_->GetShortcutCount());
+    }
+
+    return contraction_hierarchy_.get();
+}
+
+void TransportRouter::LoadContractionHierarchy(
+                                    const ContractionHierarchy::Data& data) {
+    contraction_hierarchy_ = std::make_unique<ContractionHierarchy>(
+                                                          *route_graph_, data);
+}
+
 const TransportRouter::Graph& TransportRouter::GetRouteGraph() const {
     return *route_graph_;
 }
@@ -1055,6 +1436,475 @@ void TestTrickyRouting() {
     assert(test_total_time3);
 }
 
+void TestIncrementalGraph() {
+    using namespace std::literals;
+    using TransportCatalogue = transport_catalogue::TransportCatalogue;
+
+    TransportCatalogue tc;
+
+    tc.AddStop("Biryulyovo Zapadnoye"sv, { 55.574371, 37.6517 });
+    tc.AddStop("Universam"sv, { 55.587655, 37.645687 });
+    tc.AddStop("Biryusinka"sv, { 55.581065, 37.64839 });
+    tc.AddStop("Prazhskaya"sv, { 55.611717, 37.603938 });
+
+    tc.AddDistance("Biryulyovo Zapadnoye"sv, "Universam"sv, 1000);
+    tc.AddDistance("Universam"sv, "Biryusinka"sv, 2000);
+    tc.AddDistance("Biryusinka"sv, "Prazhskaya"sv, 1500);
+    tc.AddDistance("Biryulyovo Zapadnoye"sv, "Prazhskaya"sv, 5000);
+
+    tc.AddBus("297"sv, { "Biryulyovo Zapadnoye"sv, "Universam"sv, 
+                         "Biryusinka"sv, "Universam"sv, 
+                         "Biryulyovo Zapadnoye"sv });
+    tc.AddBus("635"sv, { "Biryulyovo Zapadnoye"sv, "Prazhskaya"sv, 
+                         "Biryulyovo Zapadnoye"sv });
+
+    RoutingSettings settings {
+        /* bus_wait_time: */  6,
+        /* bus_velocity:  */  40
+    };
+
+    const TransportRouterInfo info = TransportRouter(tc, settings)
+                                                          .ExportRouterInfo();
+
+    // Patch the catalogue: shorter distance, removed bus and a new bus
+    tc.AddDistance("Biryulyovo Zapadnoye"sv, "Universam"sv, 500);
+    tc.RemoveBus("635"sv);
+    tc.AddBus("828"sv, { "Biryusinka"sv, "Prazhskaya"sv, "Biryusinka"sv });
+
+    const std::unordered_set<std::string_view> stale_bus_names {
+        "297"sv, "635"sv, "828"sv
+    };
+
+    TransportRouter patched_router(tc, settings, info, stale_bus_names);
+    TransportRouter rebuilt_router(tc, settings);
+
+    bool test_edge_count = patched_router.GetRouteGraph().GetEdgeCount() 
+                        == rebuilt_router.GetRouteGraph().GetEdgeCount();
+    assert(test_edge_count);
+
+    for (const std::string_view from : tc.GetStopNames()) {
+        for (const std::string_view to : tc.GetStopNames()) {
+            const auto patched_route = patched_router.BuildRoute(from, to);
+            const auto rebuilt_route = rebuilt_router.BuildRoute(from, to);
+
+            assert(patched_route.has_value() == rebuilt_route.has_value());
+
+            if (!patched_route) continue;
+
+            assert(DoubleEq(patched_route->total_time, 
+                            rebuilt_route->total_time));
+        }
+    }
+
+    // Edges of buses that are not stale are copied as they are
+    TransportRouter copied_router(tc, settings, 
+                                  patched_router.ExportRouterInfo(), {});
+    bool test_copied = DoubleEq(
+                copied_router.BuildRoute("Universam"sv, "Prazhskaya"sv)
+                                                                ->total_time,
+                rebuilt_router.BuildRoute("Universam"sv, "Prazhskaya"sv)
+                                                                ->total_time);
+    assert(test_copied);
+}
+
+void TestDynamicRouterUpdates() {
+    using Graph  = graph::DirectedWeightedGraph<Weight>;
+    using Router = graph::Router<Weight>;
+
+    constexpr size_t VERTEX_COUNT = 24;
+    constexpr size_t EDGE_COUNT = 60;
+
+    // A tiny deterministic generator, so the test is reproducible
+    uint32_t seed = 42;
+    auto next = [&seed](uint32_t bound) {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 16) % bound;
+    };
+
+    Graph graph(VERTEX_COUNT);
+    for (size_t i = 0; i < EDGE_COUNT; ++i) {
+        graph.AddEdge({next(VERTEX_COUNT), next(VERTEX_COUNT), 
+                       static_cast<Weight>(1 + next(20))});
+    }
+    Router router(graph);
+
+    auto check_against_rebuilt = [&graph, &router]() {
+        const Router rebuilt(graph);
+        for (graph::VertexId from = 0; from < VERTEX_COUNT; ++from) {
+            for (graph::VertexId to = 0; to < VERTEX_COUNT; ++to) {
+                const auto route = router.BuildRoute(from, to);
+                const auto expected = rebuilt.BuildRoute(from, to);
+                assert(route.has_value() == expected.has_value());
+                if (!route) continue;
+
+                assert(DoubleEq(route->weight, expected->weight));
+
+                Weight edges_weight = 0;
+                graph::VertexId vertex = from;
+                for (const graph::EdgeId edge_id : route->edges) {
+                    const auto& edge = graph.GetEdge(edge_id);
+                    assert(edge.from == vertex);
+                    vertex = edge.to;
+                    edges_weight += edge.weight;
+                }
+                assert(vertex == to);
+                assert(DoubleEq(edges_weight, route->weight));
+            }
+        }
+    };
+
+    for (int step = 0; step < 30; ++step) {
+        switch (next(3)) {
+        case 0: {
+            const graph::EdgeId edge_id = graph.AddEdge(
+                                {next(VERTEX_COUNT), next(VERTEX_COUNT), 
+                                 static_cast<Weight>(1 + next(20))});
+            router.OnEdgeAdded(edge_id);
+            break;
+        }
+        case 1: {
+            const graph::EdgeId edge_id = next(graph.GetEdgeCount());
+            const Weight old_weight = graph.GetEdge(edge_id).weight;
+            graph.SetEdgeWeight(edge_id, old_weight / 2);
+            router.OnEdgeWeightChanged(edge_id, old_weight);
+            break;
+        }
+        default: {
+            const graph::EdgeId edge_id = next(graph.GetEdgeCount());
+            const Weight old_weight = graph.GetEdge(edge_id).weight;
+            graph.SetEdgeWeight(edge_id, old_weight + 1 + next(20));
+            router.OnEdgeWeightChanged(edge_id, old_weight);
+            break;
+        }
+        }
+        check_against_rebuilt();
+    }
+}
+
+void TestRouteMatrix() {
+    using namespace std::literals;
+    using TransportCatalogue = transport_catalogue::TransportCatalogue;
+
+    TransportCatalogue tc;
+
+    tc.AddStop("Biryulyovo Zapadnoye"sv, { 55.574371, 37.6517 });
+    tc.AddStop("Universam"sv, { 55.587655, 37.645687 });
+    tc.AddStop("Biryusinka"sv, { 55.581065, 37.64839 });
+    tc.AddStop("Prazhskaya"sv, { 55.611717, 37.603938 });
+
+    tc.AddDistance("Biryulyovo Zapadnoye"sv, "Universam"sv, 1000);
+    tc.AddDistance("Universam"sv, "Biryusinka"sv, 2000);
+    tc.AddDistance("Biryusinka"sv, "Prazhskaya"sv, 1500);
+
+    // Prazhskaya can only be left, nothing goes there
+    tc.AddBus("297"sv, { "Biryulyovo Zapadnoye"sv, "Universam"sv, 
+                         "Biryusinka"sv, "Universam"sv, 
+                         "Biryulyovo Zapadnoye"sv });
+    tc.AddBus("635"sv, { "Prazhskaya"sv, "Biryusinka"sv });
+
+    RoutingSettings settings {
+        /* bus_wait_time: */  6,
+        /* bus_velocity:  */  40
+    };
+
+    const TransportRouter router(tc, settings);
+
+    const std::vector<std::string_view> origins {
+        "Biryulyovo Zapadnoye"sv, "Prazhskaya"sv, "Nowhere"sv
+    };
+    const std::vector<std::string_view> destinations {
+        "Biryusinka"sv, "Prazhskaya"sv, "Biryulyovo Zapadnoye"sv, "Nowhere"sv
+    };
+
+    const RouteMatrix matrix = router.BuildRouteMatrix(origins, destinations);
+
+    assert(matrix.size() == origins.size());
+    for (size_t i = 0; i < origins.size(); ++i) {
+        assert(matrix[i].size() == destinations.size());
+
+        for (size_t j = 0; j < destinations.size(); ++j) {
+            const auto route = router.BuildRoute(origins[i], destinations[j]);
+
+            assert(matrix[i][j].has_value() == route.has_value());
+            if (route) {
+                assert(DoubleEq(*matrix[i][j], route->total_time));
+            }
+        }
+    }
+
+    assert(!matrix[0][1].has_value());
+    assert(matrix[1][2].has_value());
+    assert(DoubleEq(*matrix[1][1], 0));
+
+    assert(router.BuildRouteMatrix({}, destinations).empty());
+}
+
+void TestIsochrone() {
+    using namespace std::literals;
+
+    generator::CitySettings city_settings;
+    city_settings.stop_count = 60;
+    city_settings.bus_count = 8;
+    city_settings.seed = 11;
+
+    transport_catalogue::TransportCatalogue tc;
+    generator::FillCatalogue(tc, generator::GenerateCity(city_settings));
+
+    const TransportRouter router(tc, generator::MakeRoutingSettings());
+
+    constexpr Weight MAX_TIME = 30;
+
+    for (const std::string_view from : tc.GetStopNames()) {
+        const auto reachable_stops = router.BuildIsochrone(from, MAX_TIME);
+
+        if (!reachable_stops) {
+            assert(!router.BuildRoute(from, from).has_value());
+            continue;
+        }
+
+        assert(reachable_stops->front().stop_name == from);
+        assert(DoubleEq(reachable_stops->front().time, 0));
+
+        std::unordered_map<std::string_view, Weight> times;
+        for (size_t i = 0; i < reachable_stops->size(); ++i) {
+            times[(*reachable_stops)[i].stop_name] = (*reachable_stops)[i].time;
+            assert(i == 0 || (*reachable_stops)[i - 1].time 
+                          <= (*reachable_stops)[i].time);
+        }
+        assert(times.size() == reachable_stops->size());
+
+        // Exactly the stops the router reaches within the limit
+        for (const std::string_view to : tc.GetStopNames()) {
+            const auto route = router.BuildRoute(from, to);
+
+            // Sums of the same edges in another order may fall either side
+            if (route && DoubleEq(route->total_time, MAX_TIME)) continue;
+
+            const bool is_reachable = route && route->total_time <= MAX_TIME;
+            assert(is_reachable == (times.count(to) > 0));
+            if (is_reachable) {
+                assert(DoubleEq(times.at(to), route->total_time));
+            }
+        }
+    }
+
+    assert(!router.BuildIsochrone("Nowhere"sv, MAX_TIME).has_value());
+}
+
+void TestContractionHierarchy() {
+    using Graph                = graph::DirectedWeightedGraph<Weight>;
+    using Router               = graph::Router<Weight>;
+    using ContractionHierarchy = graph::ContractionHierarchy<Weight>;
+
+    constexpr size_t VERTEX_COUNT = 40;
+    constexpr size_t EDGE_COUNT = 120;
+
+    uint32_t seed = 7;
+    auto next = [&seed](uint32_t bound) {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 16) % bound;
+    };
+
+    // Loops, parallel edges and unreachable vertices are all likely here
+    Graph graph(VERTEX_COUNT);
+    for (size_t i = 0; i < EDGE_COUNT; ++i) {
+        graph.AddEdge({next(VERTEX_COUNT), next(VERTEX_COUNT), 
+                       static_cast<Weight>(next(20))});
+    }
+
+    const Router router(graph);
+    const ContractionHierarchy hierarchy(graph);
+
+    // A restored hierarchy has to answer the same
+    ContractionHierarchy::Data data;
+    for (graph::VertexId vertex = 0; vertex < VERTEX_COUNT; ++vertex) {
+        data.ranks.push_back(hierarchy.GetRank(vertex));
+    }
+    for (size_t i = 0; i < hierarchy.GetShortcutCount(); ++i) {
+        data.shortcuts.push_back(hierarchy.GetShortcut(i));
+    }
+    const ContractionHierarchy restored(graph, data);
+
+    for (graph::VertexId from = 0; from < VERTEX_COUNT; ++from) {
+        for (graph::VertexId to = 0; to < VERTEX_COUNT; ++to) {
+            const auto expected = router.BuildRoute(from, to);
+
+            for (const auto& route : { hierarchy.BuildRoute(from, to), 
+                                       restored.BuildRoute(from, to) }) {
+                assert(route.has_value() == expected.has_value());
+                if (!route) continue;
+
+                assert(DoubleEq(route->weight, expected->weight));
+
+                // Shortcuts are unpacked into a chain of graph edges
+                graph::VertexId vertex = from;
+                Weight weight{};
+                for (const graph::EdgeId edge_id : route->edges) {
+                    assert(edge_id < graph.GetEdgeCount());
+                    assert(graph.GetEdge(edge_id).from == vertex);
+                    vertex = graph.GetEdge(edge_id).to;
+                    weight += graph.GetEdge(edge_id).weight;
+                }
+                assert(vertex == to);
+                assert(DoubleEq(weight, route->weight));
+            }
+        }
+    }
+
+    // Data of a corrupted base is rejected before anything is laid out
+    auto is_rejected = [&graph](const ContractionHierarchy::Data& broken_data) {
+        try {
+            ContractionHierarchy broken(graph, broken_data);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    assert(!data.shortcuts.empty());
+    const size_t last = data.shortcuts.size() - 1;
+
+    std::vector<ContractionHierarchy::Data> broken(8, data);
+    broken[0].ranks.pop_back();
+    broken[1].ranks[0] = broken[1].ranks[1];
+    broken[2].ranks[0] = VERTEX_COUNT;
+    broken[3].shortcuts[last].from = VERTEX_COUNT;
+    broken[4].shortcuts[last].to = VERTEX_COUNT * 1000;
+    // A shortcut standing for itself would never be unpacked
+    broken[5].shortcuts[last].second = EDGE_COUNT + last;
+    broken[6].shortcuts[last].first = broken[6].shortcuts[last].second;
+    broken[7].shortcuts[last].weight += 1;
+
+    for (const ContractionHierarchy::Data& broken_data : broken) {
+        assert(is_rejected(broken_data));
+    }
+}
+
+void TestContractionHierarchyRouting() {
+    generator::CitySettings city_settings;
+    city_settings.stop_count = 80;
+    city_settings.bus_count = 10;
+    city_settings.seed = 5;
+
+    transport_catalogue::TransportCatalogue tc;
+    generator::FillCatalogue(tc, generator::GenerateCity(city_settings));
+
+    const TransportRouter router(tc, generator::MakeRoutingSettings());
+
+    RoutingSettings settings = generator::MakeRoutingSettings();
+    settings.contraction_hierarchy = true;
+    const TransportRouter ch_router(tc, settings);
+
+    assert(!router.GetContractionHierarchy());
+    assert(ch_router.GetContractionHierarchy());
+
+    const std::vector<std::string_view> stop_names = tc.GetStopNames();
+    const RouteMatrix matrix = ch_router.BuildRouteMatrix(stop_names, stop_names);
+
+    for (size_t i = 0; i < stop_names.size(); ++i) {
+        for (size_t j = 0; j < stop_names.size(); ++j) {
+            const auto expected = router.BuildRoute(stop_names[i], stop_names[j]);
+            const auto route = ch_router.BuildRoute(stop_names[i], stop_names[j]);
+
+            assert(route.has_value() == expected.has_value());
+            assert(matrix[i][j].has_value() == expected.has_value());
+            if (!route) continue;
+
+            assert(DoubleEq(route->total_time, expected->total_time));
+            assert(DoubleEq(*matrix[i][j], expected->total_time));
+
+            // Items are the same waits and rides, every ride follows a wait
+            Weight total_time{};
+            for (size_t k = 0; k < route->items.size(); ++k) {
+                const RouteItem& item = route->items[k];
+                if (k % 2 == 0) {
+                    assert(std::holds_alternative<RouteItemWait>(item));
+                    total_time += std::get<RouteItemWait>(item).time;
+                } else {
+                    assert(std::holds_alternative<RouteItemBus>(item));
+                    total_time += std::get<RouteItemBus>(item).time;
+                }
+            }
+            assert(DoubleEq(total_time, route->total_time));
+        }
+    }
+}
+
+void TestAStarRouting() {
+    using namespace std::literals;
+
+    generator::CitySettings city_settings;
+    city_settings.stop_count = 80;
+    city_settings.bus_count = 10;
+    city_settings.seed = 9;
+
+    transport_catalogue::TransportCatalogue tc;
+    generator::FillCatalogue(tc, generator::GenerateCity(city_settings));
+
+    RoutingSettings settings = generator::MakeRoutingSettings();
+    const TransportRouter router(tc, settings);
+
+    settings.a_star = true;
+    const TransportRouter a_star_router(tc, settings);
+
+    const std::vector<std::string_view> stop_names = tc.GetStopNames();
+    size_t dijkstra_settled = 0;
+    size_t a_star_settled = 0;
+
+    for (const std::string_view from : stop_names) {
+        for (const std::string_view to : stop_names) {
+            const auto expected = router.BuildRoute(from, to);
+            const auto dijkstra_route = router.SearchRoute(from, to, false, 
+                                                           &dijkstra_settled);
+            const auto a_star_route = router.SearchRoute(from, to, true, 
+                                                         &a_star_settled);
+            const auto route = a_star_router.BuildRoute(from, to);
+
+            for (const auto& found : { dijkstra_route, a_star_route, route }) {
+                assert(found.has_value() == expected.has_value());
+                if (found) {
+                    assert(DoubleEq(found->total_time, expected->total_time));
+                }
+            }
+        }
+    }
+
+    // The bound leads the search to the target
+    assert(a_star_settled < dijkstra_settled);
+
+    const RouteMatrix matrix = a_star_router.BuildRouteMatrix(stop_names, 
+                                                              stop_names);
+    for (size_t i = 0; i < stop_names.size(); ++i) {
+        for (size_t j = 0; j < stop_names.size(); ++j) {
+            const auto expected = router.BuildRoute(stop_names[i], stop_names[j]);
+            assert(matrix[i][j].has_value() == expected.has_value());
+            if (expected) {
+                assert(DoubleEq(*matrix[i][j], expected->total_time));
+            }
+        }
+    }
+
+    /* Road distances shorter than the great-circle ones mustn't make the 
+     * bound overestimate. The fastest route changes buses at X, which is
+     * far from both A and C, but the roads to it are short */
+    transport_catalogue::TransportCatalogue short_roads;
+    short_roads.AddStop("A"sv, { 55.60, 37.20 });
+    short_roads.AddStop("X"sv, { 55.70, 37.20 });
+    short_roads.AddStop("C"sv, { 55.60, 37.21 });
+    short_roads.AddDistance("A"sv, "X"sv, 100);
+    short_roads.AddDistance("X"sv, "C"sv, 100);
+    short_roads.AddDistance("A"sv, "C"sv, 5000);
+    short_roads.AddBus("1"sv, { "A"sv, "X"sv }, true);
+    short_roads.AddBus("2"sv, { "X"sv, "C"sv }, true);
+    short_roads.AddBus("3"sv, { "A"sv, "C"sv }, true);
+
+    const TransportRouter short_roads_router(short_roads, { 6, 40, false, true });
+    const auto short_route = short_roads_router.BuildRoute("A"sv, "C"sv);
+    assert(short_route.has_value());
+    assert(DoubleEq(short_route->total_time, 2 * (6 + 0.1 / 40 * 60)));
+
+    assert(!short_roads_router.SearchRoute("A"sv, "Nowhere"sv, true).has_value());
+}
+
 } // namespace transport_router::tests
 
 } // namespace transport_router
@@ -8,9 +8,12 @@
 #include <vector>
 
 #include "domain.h"
+#include "memory.h"
 #include "transport_catalogue.h"
 #include "router.h"
 #include "graph.h"
+#include "contraction_hierarchy.h"
+#include "a_star.h"
 
 namespace transport_router {
 
@@ -20,6 +23,14 @@ using Weight = double;
 struct RoutingSettings {
     Weight bus_wait_time; // in minutes
     double bus_velocity;
+
+    /* Routes are searched over a contraction hierarchy of the graph instead
+     * of the all-pairs router table */
+    bool contraction_hierarchy = false;
+
+    /* Routes are searched one by one with A* instead of being looked up in 
+     * the table. Yields to the contraction hierarchy if both are asked for */
+    bool a_star = false;
 };
 
 struct BaseRouteItem {
@@ -70,6 +81,16 @@ struct RoutingResult {
     std::vector<RouteItem> items;
 };
 
+/* Total times of the fastest routes, a row per origin and a column per
+ * destination. Pairs without a route or with an unknown stop have no time */
+using RouteMatrix = std::vector<std::vector<std::optional<Weight>>>;
+
+// A stop reached from the origin of an isochrone and the time it took
+struct ReachableStop {
+    std::string_view stop_name;
+    Weight time;
+};
+
 class TransportRouterInfo {
 public:
     using Graph              = graph::DirectedWeightedGraph<Weight>;
@@ -115,12 +136,15 @@ private:
 
 class TransportRouter {
 public:
-    using Graph              = graph::DirectedWeightedGraph<Weight>;
-    using Router             = graph::Router<Weight>;
-    using EdgeId             = graph::EdgeId;
-    using VertexId           = graph::VertexId;
-    using TransportCatalogue = transport_catalogue::TransportCatalogue;
-
+    using Graph                = graph::DirectedWeightedGraph<Weight>;
+    using Router               = graph::Router<Weight>;
+    using ContractionHierarchy = graph::ContractionHierarchy<Weight>;
+    using EdgeId               = graph::EdgeId;
+    using VertexId             = graph::VertexId;
+    using TransportCatalogue   = transport_catalogue::TransportCatalogue;
+
+    /* Graph-only constructors. The all-pairs router table is built on 
+     * the first BuildRoute call, so make_base never pays for it */
     explicit TransportRouter(const TransportCatalogue& catalogue, 
                              RoutingSettings settings)
         : catalogue_  (&catalogue)
@@ -128,7 +152,6 @@ public:
         , settings_   (std::move(settings)) {
     
         BuildGraph();
-        router_ = std::make_unique<Router>(*route_graph_);
     }
     
     TransportRouter(const TransportCatalogue& catalogue,
@@ -138,17 +161,62 @@ public:
         , settings_(info.GetRoutingSettings()) {
         
         BuildGraphFromInfo(info);
-
-        router_ = std::make_unique<Router>(*route_graph_);
     }
 
+    /* Rebuilds a previously exported graph against a patched catalogue. 
+     * Edges of stale buses are computed anew, edges of every other bus are
+     * copied from the info. Buses and stops that are no longer in the
+     * catalogue are dropped */
+    TransportRouter(const TransportCatalogue& catalogue,
+                    RoutingSettings settings,
+                    const TransportRouterInfo& info,
+                    const std::unordered_set<std::string_view>& stale_bus_names)
+        : catalogue_(&catalogue)
+        , route_graph_(std::make_unique<Graph>(catalogue_->GetStopCount() * 2))
+        , settings_(std::move(settings)) {
+
+        BuildGraphIncrementally(info, stale_bus_names);
+    }
 
     // Builds a route for two stop_names
     std::optional<RoutingResult> BuildRoute(std::string_view from, 
                                             std::string_view to) const;
 
+    /* Builds a route with a search over the graph alone, neither the table
+     * nor the hierarchy is needed. With the geographic lower bound the search
+     * is A*, without it Dijkstra's algorithm. Adds the number of settled 
+     * vertices to settled_count if given */
+    std::optional<RoutingResult> SearchRoute(std::string_view from,
+                                             std::string_view to,
+                                             bool use_lower_bound,
+                                             size_t* settled_count = nullptr) const;
+
+    /* Looks the total times up in the router table or searches them over 
+     * the contraction hierarchy or with A*, rows are filled in parallel. No
+     * route items are assembled */
+    RouteMatrix BuildRouteMatrix(
+                        const std::vector<std::string_view>& origins,
+                        const std::vector<std::string_view>& destinations) const;
+
+    /* Returns the stops reachable from the stop within max_time, the origin
+     * included, in the order of their times. Runs Dijkstra's algorithm over
+     * the graph that stops expanding at max_time, the router table isn't 
+     * needed. Returns nothing for an unknown stop */
+    std::optional<std::vector<ReachableStop>> BuildIsochrone(
+                                        std::string_view stop_name,
+                                        Weight max_time) const;
+
     const Graph& GetRouteGraph() const;
 
+    RoutingSettings GetRoutingSettings() const;
+
+    /* Returns the contraction hierarchy if the settings ask for one, the 
+     * graph is contracted on the first call. Returns nullptr otherwise */
+    const ContractionHierarchy* GetContractionHierarchy() const;
+
+    // Restores the hierarchy contracted over the same graph before
+    void LoadContractionHierarchy(const ContractionHierarchy::Data& data);
+
     const TransportRouterInfo ExportRouterInfo() const;
 
 private:    
@@ -157,6 +225,33 @@ private:
     
     struct WaitEdgeInfo;
 
+    /* What the lower bound of A* is computed from. No bus goes over the
+     * ground faster than max_speed: it is bus_velocity scaled by the largest
+     * ratio of the great-circle distance to the road distance over the spans
+     * of the routes, since road distances may be given shorter */
+    struct GeoBound {
+        // Stops of the vertices, nullptr for the vertices of no stop
+        std::vector<domain::StopPtr> vertex_stops;
+
+        std::vector<bool> is_wait_vertex;
+
+        // Meters per minute, infinity if some span has a zero road distance
+        double max_speed;
+    };
+
+    // Returns the lower bound data, collecting it on the first call
+    const GeoBound& GetGeoBound() const;
+
+    std::optional<Router::RouteInfo> SearchRouteInfo(VertexId from, VertexId to,
+                                                     bool use_lower_bound,
+                                                     size_t* settled_count = nullptr) const;
+
+    // Turns the edges of a route into wait and bus items
+    RoutingResult AssembleRoutingResult(const Router::RouteInfo& route_info) const;
+
+    // Counts vertices and edges of the built graph in the run stats
+    void AddGraphCounters() const;
+
     bool IsBusEdge(EdgeId edge) const;
 
     bool IsWaitEdge(EdgeId edge) const;
@@ -190,11 +285,33 @@ private:
     };
 
     /* Builds a graph based on info from transport catalogue
-     * and fills stop_name_to_vertex_id_ map (hence not being const) */
+     * and fills stop_name_to_vertex_id_ map (hence not being const).
+     * Vertexes and wait edges come first, then edge blocks of every bus 
+     * are assembled in parallel and appended in the order of bus names */
     void BuildGraph();
 
     void BuildGraphFromInfo(const TransportRouterInfo& info);
 
+    void BuildGraphIncrementally(
+                    const TransportRouterInfo& info,
+                    const std::unordered_set<std::string_view>& stale_bus_names);
+
+    // Adds edges between every pair of stops of a bus route
+    void AddBusEdges(domain::BusPtr bus_ptr);
+
+    // Returns the number of edges a bus route produces
+    static size_t CountBusEdges(domain::BusPtr bus_ptr);
+
+    /* Writes CountBusEdges(bus_ptr) edges of a bus route into the given 
+     * buffers. Vertexes of the route have to be enumerated beforehand, the
+     * graph itself isn't touched, so buses can be assembled in parallel */
+    void AssembleBusEdges(domain::BusPtr bus_ptr,
+                          graph::Edge<Weight>* edges_out,
+                          BusEdgeInfo* edges_info_out) const;
+
+    // Returns the router, building its table on the first call
+    const Router& GetRouter() const;
+
     /* Maps a given stop name to a vertex id (enumerates it, hence the name) 
      * maps a VertexInfo to a vertex id, adds an edge between them with weight 
      * equal to wait_time in the settings */
@@ -210,25 +327,30 @@ private:
 
     std::unique_ptr<Graph> route_graph_;
 
-    // A router used to build routes
-    std::unique_ptr<Router> router_;
+    // A router used to build routes. Is built lazily, hence mutable
+    mutable std::unique_ptr<Router> router_;
+
+    // Is contracted lazily as well and only if the settings ask for it
+    mutable std::unique_ptr<ContractionHierarchy> contraction_hierarchy_;
+
+    mutable std::unique_ptr<GeoBound> geo_bound_;
 
     // Routing settings necessary to compute weights
     RoutingSettings settings_;
 
     // Maps stop name to vertex_id
-    std::unordered_map<std::string_view, 
-                       VertexId> stop_name_to_wait_vertex_id_;
+    memory::UnorderedMap<std::string_view, VertexId, 
+                         memory::Category::ROUTER_VERTEX_IDS> stop_name_to_wait_vertex_id_;
 
-    std::unordered_map<std::string_view,
-                       VertexId> stop_name_to_bus_vertex_id_;
+    memory::UnorderedMap<std::string_view, VertexId, 
+                         memory::Category::ROUTER_VERTEX_IDS> stop_name_to_bus_vertex_id_;
 
     // Maps span edge ids to the bus name
-    std::unordered_map<EdgeId, 
-                       BusEdgeInfo> bus_edge_id_to_edge_info_;
+    memory::UnorderedMap<EdgeId, BusEdgeInfo, 
+                         memory::Category::ROUTER_EDGE_INFO> bus_edge_id_to_edge_info_;
 
-    std::unordered_map<EdgeId,
-                       WaitEdgeInfo> wait_edge_id_to_edge_info_;
+    memory::UnorderedMap<EdgeId, WaitEdgeInfo, 
+                         memory::Category::ROUTER_EDGE_INFO> wait_edge_id_to_edge_info_;
 
     VertexId current_vertex_id = 0;
 
@@ -246,7 +368,7 @@ TransportRouter::BusEdgeInfo TransportRouter::AssembleBusEdgeInfo(
 
     assert(from_iter < to_iter);
 
-    const std::vector<domain::StopPtr>& route = bus_ptr->route;
+    const domain::Route& route = bus_ptr->route;
 
     assert(from_iter < (route.end() - 1));
 
@@ -288,6 +410,20 @@ void TestComplexRouting();
 
 void TestTrickyRouting();
 
+void TestIncrementalGraph();
+
+void TestDynamicRouterUpdates();
+
+void TestRouteMatrix();
+
+void TestIsochrone();
+
+void TestContractionHierarchy();
+
+void TestContractionHierarchyRouting();
+
+void TestAStarRouting();
+
 } // namespace transport_router::tests
 
 } // namespace transport_router
\ No newline at end of file